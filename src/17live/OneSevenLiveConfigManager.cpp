@@ -135,14 +135,17 @@ bool OneSevenLiveConfigManager::getLoginData(OneSevenLiveLoginData &loginData) {
     const char *displayNameChar = config_get_string(config, service, "DisplayName");
     const char *userIdChar = config_get_string(config, service, "UserID");
     const char *regionChar = config_get_string(config, service, "Region");
+    const char *refreshTokenChar = config_get_string(config, service, "RefreshToken");
 
     std::string jwtToken = jwtTokenChar ? jwtTokenChar : "";
     std::string openId = openIdChar ? openIdChar : "";
     std::string userId = userIdChar ? userIdChar : "";
     std::string displayName = displayNameChar ? displayNameChar : "";
     std::string region = regionChar ? regionChar : "";
+    std::string refreshToken = refreshTokenChar ? refreshTokenChar : "";
 
     loginData.jwtAccessToken = QString::fromStdString(jwtToken);
+    loginData.refreshToken = QString::fromStdString(refreshToken);
     loginData.userInfo.openID = QString::fromStdString(openId);
     loginData.userInfo.displayName = QString::fromStdString(displayName);
     loginData.userInfo.roomID = config_get_uint(config, service, "RoomID");
@@ -170,11 +173,13 @@ bool OneSevenLiveConfigManager::setLoginData(const OneSevenLiveLoginData &loginD
     std::string displayName = loginData.userInfo.displayName.toStdString();
     std::string jwtToken = loginData.jwtAccessToken.toStdString();
     std::string region = loginData.userInfo.region.toStdString();
+    std::string refreshToken = loginData.refreshToken.toStdString();
 
     config_set_string(config, service, "UserID", userID.c_str());
     config_set_string(config, service, "OpenID", openID.c_str());
     config_set_string(config, service, "DisplayName", displayName.c_str());
     config_set_string(config, service, "JwtToken", jwtToken.c_str());
+    config_set_string(config, service, "RefreshToken", refreshToken.c_str());
     config_set_string(config, service, "Region", region.c_str());
     config_set_uint(config, service, "RoomID", loginData.userInfo.roomID);
 
@@ -204,6 +209,7 @@ void OneSevenLiveConfigManager::clearLoginData() {
     config_set_string(config, service, "OpenID", "");
     config_set_string(config, service, "DisplayName", "");
     config_set_string(config, service, "JwtToken", "");
+    config_set_string(config, service, "RefreshToken", "");
     config_set_uint(config, service, "RoomID", 0);
     if (config_save(config) < 0) {
         obs_log(LOG_ERROR, "Failed to save config");
@@ -62,6 +62,9 @@ class OneSevenLiveConfigManager {
     bool saveGifts(const json &gifts);
     bool loadGifts(json &gifts);
 
+    // Directory holding the plugin configuration files
+    const std::string &getConfigPath() const { return configPath; }
+
    private:
     bool initialized = false;
 
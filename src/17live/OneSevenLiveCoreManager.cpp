@@ -28,10 +28,19 @@
 #include "OneSevenLiveStreamingDock.hpp"
 #include "OneSevenLiveUpdateManager.hpp"
 #include "QCefView.hpp"
+#include "api/OneSevenLiveApiAsync.hpp"
 #include "api/OneSevenLiveApiWrappers.hpp"
 #include "plugin-support.h"
 #include "utility/Common.hpp"
+#include "utility/ConnectionPrewarmer.hpp"
+#include "utility/DnsPrefetcher.hpp"
+#include "utility/HttpConnectionPool.hpp"
+#include "utility/HttpEngine.hpp"
+#include "utility/HttpMetrics.hpp"
+#include "utility/HttpValidatorCache.hpp"
 #include "utility/Meta.hpp"
+#include "utility/NetworkChangeMonitor.hpp"
+#include "utility/TransferShaper.hpp"
 
 using Json = nlohmann::json;
 using namespace std;
@@ -52,6 +61,17 @@ OneSevenLiveCoreManager& OneSevenLiveCoreManager::getInstance(QMainWindow* mainW
     return *instance;
 }
 
+// Plugin background traffic is shaped while OBS is streaming
+static void update_transfer_shaping(enum obs_frontend_event event, void* private_data) {
+    UNUSED_PARAMETER(private_data);
+    if (event == OBS_FRONTEND_EVENT_STREAMING_STARTING ||
+        event == OBS_FRONTEND_EVENT_STREAMING_STARTED) {
+        TransferShaper::instance().setStreaming(true);
+    } else if (event == OBS_FRONTEND_EVENT_STREAMING_STOPPED) {
+        TransferShaper::instance().setStreaming(false);
+    }
+}
+
 OneSevenLiveCoreManager::OneSevenLiveCoreManager(QMainWindow* mainWindow_)
     : mainWindow(mainWindow_), initialized(false) {}
 
@@ -71,10 +91,26 @@ bool OneSevenLiveCoreManager::initialize() {
     obs_log(LOG_INFO, "[17Live Core] Initializing OneSevenLiveCoreManager...");
 
     try {
+        // Resolve the API and CDN hosts in the background so requests never wait on DNS
+        DnsPrefetcher::instance().addUrl(ONESEVENLIVE_API_URL);
+        DnsPrefetcher::instance().addHost("cdn.17app.co", 443);
+        DnsPrefetcher::instance().start();
+
+        // Open connections to the same hosts so the first login and room info start warm
+        ConnectionPrewarmer::instance().addOrigin(ONESEVENLIVE_API_URL);
+        ConnectionPrewarmer::instance().addOrigin("https://cdn.17app.co/");
+        ConnectionPrewarmer::instance().warm("startup");
+
+        // Drop stale connections and re-probe the API as soon as the network changes
+        NetworkChangeMonitor::instance().start(ONESEVENLIVE_API_URL);
+
         // Run network diagnostics to check API connectivity
         obs_log(LOG_INFO, "[17Live Core] Running startup network diagnostics...");
         NetworkDiagnostics::runStartupDiagnostics(ONESEVENLIVE_API_URL);
 
+        TransferShaper::instance().setStreaming(obs_frontend_streaming_active());
+        obs_frontend_add_event_callback(update_transfer_shaping, nullptr);
+
         // Initialize and start HTTP server
         // "html" is the path relative to obs_get_module_data_path()
         httpServer_ = std::make_unique<OneSevenLiveHttpServer>("localhost", 0, "html/chat");
@@ -102,6 +138,9 @@ bool OneSevenLiveCoreManager::initialize() {
             obs_log(LOG_ERROR, "[17Live Core] Failed to initialize config manager");
             return false;
         }
+
+        HttpValidatorCache::instance().setDirectory(configManager->getConfigPath() +
+                                                    "/http-cache");
     } catch (const std::bad_alloc& e) {
         obs_log(LOG_ERROR, "[17Live Core] Memory allocation failed during initialization: %s",
                 e.what());
@@ -117,19 +156,22 @@ bool OneSevenLiveCoreManager::initialize() {
     OneSevenLiveLoginData loginData;
     configManager->getLoginData(loginData);
 
-    bool isLogin = false;
-
-    if (!loginData.jwtAccessToken.isEmpty()) {
-        apiWrapper =
-            std::make_unique<OneSevenLiveApiWrappers>(loginData.jwtAccessToken.toStdString());
-
-        isLogin = checkLoginStatus();
-    }
-
-    // if not login, reinitialize apiWrapper
-    if (!isLogin) {
-        apiWrapper = std::make_unique<OneSevenLiveApiWrappers>();
-    }
+    // Starts with the saved token, checked by checkLoginStatus() once initialization is done.
+    // The refresh token lets that check renew a token that expired while OBS was closed.
+    apiWrapper = std::make_unique<OneSevenLiveApiWrappers>(loginData.jwtAccessToken.toStdString());
+    apiWrapper->setRefreshToken(loginData.refreshToken.toStdString());
+
+    // Keep renewed tokens, so the next start doesn't begin with an expired one
+    QObject::connect(apiWrapper.get(), &OneSevenLiveApiWrappers::tokenRefreshed, this,
+                     [this](const QString& accessToken, const QString& refreshToken) {
+                         OneSevenLiveLoginData savedLoginData;
+                         configManager->getLoginData(savedLoginData);
+                         if (savedLoginData.jwtAccessToken.isEmpty())
+                             return;  // Logged out while the refresh was running
+                         savedLoginData.jwtAccessToken = accessToken;
+                         savedLoginData.refreshToken = refreshToken;
+                         configManager->setLoginData(savedLoginData);
+                     });
 
     // Initialize menu manager
     menuManager = std::make_unique<OneSevenLiveMenuManager>(mainWindow);
@@ -159,6 +201,12 @@ bool OneSevenLiveCoreManager::initialize() {
     QObject::connect(menuManager.get(), &OneSevenLiveMenuManager::checkUpdateClicked, this,
                      &OneSevenLiveCoreManager::handleCheckUpdateClicked);
 
+    QObject::connect(menuManager.get(), &OneSevenLiveMenuManager::networkStatsClicked, this,
+                     []() {
+                         HttpMetrics::instance().logSummary();
+                         TransferShaper::instance().logStats();
+                     });
+
     // Initialize update manager
     updateManager = new OneSevenLiveUpdateManager(this);
 
@@ -180,6 +228,7 @@ bool OneSevenLiveCoreManager::initialize() {
                 // QString systemInfo = updateManager->getSystemInfo();
                 // QString downloadUrl;
                 // QString fileName;
+                // QString digest;
 
                 // for (QJsonValue assetValue : assets) {
                 //     QJsonObject asset = assetValue.toObject();
@@ -193,16 +242,19 @@ bool OneSevenLiveCoreManager::initialize() {
                 //         assetName.contains("macAppleSilicon")) {
                 //             downloadUrl = asset["browser_download_url"].toString();
                 //             fileName = assetName;
+                //             digest = asset["digest"].toString();
                 //             break;
                 //         } else if (systemInfo.contains("x86_64") &&
                 //         assetName.contains("macIntel")) {
                 //             downloadUrl = asset["browser_download_url"].toString();
                 //             fileName = assetName;
+                //             digest = asset["digest"].toString();
                 //             break;
                 //         }
                 //     } else if (systemInfo.contains("Windows") && assetName.contains("windows")) {
                 //         downloadUrl = asset["browser_download_url"].toString();
                 //         fileName = assetName;
+                //         digest = asset["digest"].toString();
                 //         break;
                 //     }
                 // }
@@ -213,7 +265,7 @@ bool OneSevenLiveCoreManager::initialize() {
                 //     return;
                 // }
 
-                // updateManager->downloadUpdate(downloadUrl, fileName);
+                // updateManager->downloadUpdate(downloadUrl, fileName, digest);
             }
         });
 
@@ -239,12 +291,8 @@ bool OneSevenLiveCoreManager::initialize() {
     isStartupRestore = true;
 
     // Handle login state during initialization
-    if (isLogin) {
-        configManager->getLoginData(loginData);
-
-        // Use the new centralized login state handler for logged in users
-        handleLoginStateChanged(true, loginData);
-    }
+    if (!loginData.jwtAccessToken.isEmpty())
+        checkLoginStatus();
 
     initialized = true;
 
@@ -291,6 +339,21 @@ void OneSevenLiveCoreManager::shutdown() {
         menuManager->cleanup();
     }
 
+    // The docks are closed, which canceled their calls; let those return before transfers stop
+    OneSevenLiveApiAsync::shutdown();
+
+    if (apiWrapper) {
+        apiWrapper->logRequestStats();
+    }
+
+    obs_frontend_remove_event_callback(update_transfer_shaping, nullptr);
+
+    NetworkChangeMonitor::instance().stop();
+    HttpEngine::instance().shutdown();
+    HttpConnectionPool::instance().logStats();
+    TransferShaper::instance().logStats();
+    DnsPrefetcher::instance().stop();
+
     initialized = false;
 }
 
@@ -351,6 +414,8 @@ void OneSevenLiveCoreManager::performLoginOperations(const OneSevenLiveLoginData
         apiWrapper->getToken() != loginData.jwtAccessToken.toStdString()) {
         apiWrapper->setToken(loginData.jwtAccessToken.toStdString());
     }
+    if (!loginData.refreshToken.isEmpty())
+        apiWrapper->setRefreshToken(loginData.refreshToken.toStdString());
 
     loadGifts();
 
@@ -382,6 +447,10 @@ void OneSevenLiveCoreManager::performLogoutOperations() {
 
     // Clear login data
     configManager->clearLoginData();
+
+    // Nothing left to refresh in the background, and nothing cached for the next account
+    apiWrapper->setRefreshToken("");
+    apiWrapper->setToken("");
 }
 
 void OneSevenLiveCoreManager::restoreDockStatesOnLogin() {
@@ -587,6 +656,7 @@ void OneSevenLiveCoreManager::createStreamingDock() {
         streamingDock->move(x, y);
     }
 
+    ConnectionPrewarmer::instance().warm("streaming dock");
     streamingDock->loadRoomInfo(loginData.userInfo.roomID);
 
     if (streamingDockFirstLoad) {
@@ -863,17 +933,50 @@ void OneSevenLiveCoreManager::handleLiveListClicked() {
     }
 }
 
-bool OneSevenLiveCoreManager::checkLoginStatus() {
-    // call apiWrapper->GetSelfInfo()
-    OneSevenLiveLoginData loginData;
-    if (!apiWrapper->GetSelfInfo(loginData)) {
-        configManager->clearLoginData();
-        return false;
-    }
-
-    // TODO: update loginData: displayName
+void OneSevenLiveCoreManager::checkLoginStatus() {
+    // Logging out or in again while the check runs replaces the token; the result is then about
+    // a login that is gone and must not touch the current one
+    const std::string checkedToken = apiWrapper->getToken();
+    // Token in use when GetSelfInfo returned, a renewal during the check is part of the check
+    auto finishedToken = std::make_shared<std::string>();
+
+    // GetSelfInfo runs on the API pool: a slow network or a token refresh must not hold up the
+    // UI thread while OBS starts
+    OneSevenLiveApiAsync::call<OneSevenLiveLoginData>(
+        *apiWrapper, this,
+        [finishedToken](OneSevenLiveApiWrappers& api, OneSevenLiveLoginData& out) {
+            bool success = api.GetSelfInfo(out);
+            *finishedToken = api.getToken();
+            return success;
+        },
+        [this, checkedToken, finishedToken](
+            const OneSevenLiveApiResult<OneSevenLiveLoginData>& result) {
+            const std::string currentToken = apiWrapper->getToken();
+            if (currentToken != (result.success ? *finishedToken : checkedToken)) {
+                obs_log(LOG_INFO, "Login changed during the login check, result ignored");
+                return;
+            }
 
-    return true;
+            if (!result.success) {
+                // Only a rejected token means logged out; an unreachable server or a timeout
+                // keeps the saved login for the next start
+                if (result.httpStatus != 401) {
+                    obs_log(LOG_WARNING, "Login check failed, keeping the saved login: %s",
+                            result.error.toUtf8().constData());
+                    return;
+                }
+                configManager->clearLoginData();
+                apiWrapper->setRefreshToken("");
+                apiWrapper->setToken("");
+                return;
+            }
+            // TODO: update loginData: displayName
+            // Read back after the check: a token renewed during it was saved by the
+            // tokenRefreshed handler, which was queued to this object first
+            OneSevenLiveLoginData loginData;
+            configManager->getLoginData(loginData);
+            handleLoginStateChanged(true, loginData);
+        });
 }
 
 void OneSevenLiveCoreManager::saveDockState() {
@@ -968,6 +1071,9 @@ void OneSevenLiveCoreManager::loadGifts() {
 
     // Run gift loading in a separate thread to avoid blocking main thread
     std::thread giftLoadThread([this]() {
+        // The catalog refresh can wait while OBS is streaming
+        TransferClassScope transferClass(TransferClass::Background);
+
         try {
             std::string language = GetCurrentLanguage();
 
@@ -146,8 +146,8 @@ class OneSevenLiveCoreManager : public QObject {
     void restoreDockStatesOnLogin();
     void closeAllDocks();
 
-    // Function to check if login status is valid
-    bool checkLoginStatus();
+    // Check the saved login in the background, and switch to the logged in state if it is valid
+    void checkLoginStatus();
 
     // Streaming Dock load status
     bool streamingDockFirstLoad = true;
@@ -24,7 +24,6 @@
 #include <QStyleFactory>
 #include <QTabWidget>
 #include <QTextCharFormat>
-#include <QThread>
 #include <QToolTip>
 #include <QVBoxLayout>
 #include <QFontMetrics>
@@ -38,9 +37,11 @@
 
 // Project includes
 #include "OneSevenLiveConfigManager.hpp"
+#include "api/OneSevenLiveApiAsync.hpp"
 #include "api/OneSevenLiveApiWrappers.hpp"
+#include "utility/CancellationToken.hpp"
 #include "utility/Common.hpp"
-#include "utility/RemoteTextThread.hpp"
+#include "utility/RemoteRequest.hpp"
 #include "utility/CustomCalendarWidget.hpp"
 
 // Static helper: insert zero-width spaces into CJK or other no-space text to enable line breaks with WrapAnywhere
@@ -118,7 +119,10 @@ static QString elideTextToTwoLines(const QString& text, const QFont& font, int w
 OneSevenLiveCustomEventDialog::OneSevenLiveCustomEventDialog(
     QWidget* parent, OneSevenLiveApiWrappers* apiWrapper_,
     OneSevenLiveConfigManager* configManager_)
-    : QDialog(parent), apiWrapper(apiWrapper_), configManager(configManager_) {
+    : QDialog(parent),
+      apiWrapper(apiWrapper_),
+      configManager(configManager_),
+      cancelToken(std::make_shared<CancellationToken>()) {
     setupUi();
     setWindowTitle(obs_module_text("CustomEvent.Dialog.Title"));
     setMinimumSize(450, 600);
@@ -137,7 +141,10 @@ OneSevenLiveCustomEventDialog::OneSevenLiveCustomEventDialog(
     update();
 }
 
-OneSevenLiveCustomEventDialog::~OneSevenLiveCustomEventDialog() = default;
+OneSevenLiveCustomEventDialog::~OneSevenLiveCustomEventDialog() {
+    // Abort in-flight image downloads; API calls are canceled with the dialog itself
+    cancelToken->cancel();
+}
 
 void OneSevenLiveCustomEventDialog::setupUi() {
     // Create main dialog layout
@@ -451,249 +458,210 @@ void OneSevenLiveCustomEventDialog::setupBottomButtons(QVBoxLayout* parentLayout
 }
 
 void OneSevenLiveCustomEventDialog::loadGiftTabsAsync() {
-    QThread* thread = new QThread(this);
-    QObject* worker = new QObject();
-    worker->moveToThread(thread);
-
-    connect(thread, &QThread::started, worker, [this, worker, thread]() {
-        QList<OneSevenLiveGiftTab> localFilteredGiftTabs;
-        QList<OneSevenLiveGift> localSelectedGifts;
-        OneSevenLiveGiftTabsResponse localGiftTabsData;
-
-        if (!apiWrapper || !configManager) {
-            QMetaObject::invokeMethod(
-                this,
-                [this, thread]() {
-                    setupGiftTabsUI();
-                    thread->quit();
-                },
-                Qt::QueuedConnection);
-            return;
-        }
-
-        std::string roomID;
-        std::string region;
-        if (!configManager->getConfigValue("RoomID", roomID) ||
-            !configManager->getConfigValue("Region", region)) {
-            QMetaObject::invokeMethod(
-                this,
-                [this, thread]() {
-                    setupGiftTabsUI();
-                    thread->quit();
-                },
-                Qt::QueuedConnection);
-            return;
-        }
+    std::string roomID;
+    std::string region;
+    if (!apiWrapper || !configManager || !configManager->getConfigValue("RoomID", roomID) ||
+        !configManager->getConfigValue("Region", region)) {
+        setupGiftTabsUI();
+        return;
+    }
 
-        std::string language = GetCurrentLanguage();
-
-        Json giftTabsJson;
-        if (!apiWrapper->GetGiftTabs(roomID, language, giftTabsJson)) {
-            QMetaObject::invokeMethod(
-                this,
-                [this, thread]() {
-                    setupGiftTabsUI();
-                    thread->quit();
-                },
-                Qt::QueuedConnection);
-            return;
-        }
+    std::string language = GetCurrentLanguage();
+    OneSevenLiveConfigManager* config = configManager;
+    QStringList allowedCategories = allowedGiftCategories;
+
+    // Matching the tabs against the gift list runs on the pool thread as well
+    OneSevenLiveApiAsync::call<QList<OneSevenLiveGiftTab>>(
+        *apiWrapper, this,
+        [roomID, region, language, config, allowedCategories](
+            OneSevenLiveApiWrappers& api, QList<OneSevenLiveGiftTab>& filteredTabs) {
+            Json giftTabsJson;
+            if (!api.GetGiftTabs(roomID, language, giftTabsJson)) {
+                return false;
+            }
 
-        Json giftsJson;
-        OneSevenLiveGiftsResponse giftsResponse;
-        configManager->loadGifts(giftsJson);
-        JsonToOneSevenLiveGiftsResponse(giftsJson, giftsResponse);
-        QList<OneSevenLiveGift> gifts = giftsResponse.gifts;
-
-        if (JsonToOneSevenLiveGiftTabsResponse(giftTabsJson, localGiftTabsData)) {
-            for (auto& tab : localGiftTabsData.tabs) {
-                if (allowedGiftCategories.contains(tab.id)) {
-                    QList<OneSevenLiveGift> filteredGifts;
-                    for (const auto& tabGift : tab.gifts) {
-                        OneSevenLiveGift gift;
-                        for (const auto& giftItem : gifts) {
-                            if (giftItem.giftID == tabGift.giftID) {
-                                gift = giftItem;
+            Json giftsJson;
+            OneSevenLiveGiftsResponse giftsResponse;
+            config->loadGifts(giftsJson);
+            JsonToOneSevenLiveGiftsResponse(giftsJson, giftsResponse);
+            QList<OneSevenLiveGift> gifts = giftsResponse.gifts;
+
+            OneSevenLiveGiftTabsResponse giftTabsData;
+            if (JsonToOneSevenLiveGiftTabsResponse(giftTabsJson, giftTabsData)) {
+                for (auto& tab : giftTabsData.tabs) {
+                    if (allowedCategories.contains(tab.id)) {
+                        QList<OneSevenLiveGift> filteredGifts;
+                        for (const auto& tabGift : tab.gifts) {
+                            OneSevenLiveGift gift;
+                            for (const auto& giftItem : gifts) {
+                                if (giftItem.giftID == tabGift.giftID) {
+                                    gift = giftItem;
+                                    break;
+                                }
+                            }
+                            if (gift.isHidden == 1) {
+                                continue;
+                            }
+                            bool shouldShow = false;
+                            switch (gift.regionMode) {
+                            case 1:
+                                shouldShow = true;
+                                break;
+                            case 2:
+                                shouldShow = gift.regions.contains(QString::fromStdString(region));
+                                break;
+                            case 3:
+                                shouldShow = !gift.regions.contains(QString::fromStdString(region));
+                                break;
+                            default:
+                                shouldShow = false;
                                 break;
                             }
-                        }
-                        if (gift.isHidden == 1) {
-                            continue;
-                        }
-                        bool shouldShow = false;
-                        switch (gift.regionMode) {
-                        case 1:
-                            shouldShow = true;
-                            break;
-                        case 2:
-                            shouldShow = gift.regions.contains(QString::fromStdString(region));
-                            break;
-                        case 3:
-                            shouldShow = !gift.regions.contains(QString::fromStdString(region));
-                            break;
-                        default:
-                            shouldShow = false;
-                            break;
-                        }
-                        if (shouldShow) {
-                            filteredGifts.append(gift);
-                            if (customEvent.giftIDs.size() > 0 &&
-                                customEvent.giftIDs.contains(gift.giftID)) {
-                                localSelectedGifts.append(gift);
+                            if (shouldShow) {
+                                filteredGifts.append(gift);
                             }
                         }
-                    }
-                    if (!filteredGifts.isEmpty()) {
-                        tab.gifts = filteredGifts;
-                        localFilteredGiftTabs.append(tab);
+                        if (!filteredGifts.isEmpty()) {
+                            tab.gifts = filteredGifts;
+                            filteredTabs.append(tab);
+                        }
                     }
                 }
             }
-        }
-
-        QMetaObject::invokeMethod(
-            this,
-            [this, thread, localFilteredGiftTabs, localSelectedGifts]() {
-                filteredGiftTabs = localFilteredGiftTabs;
-                selectedGifts = localSelectedGifts;
+            return true;
+        },
+        [this](const OneSevenLiveApiResult<QList<OneSevenLiveGiftTab>>& result) {
+            if (!result.success) {
                 setupGiftTabsUI();
+                return;
+            }
 
-                // update selected gifts' name
-                QList<QString> selectedGiftsName;
-                for (auto selectedGift : selectedGifts) {
-                    selectedGiftsName.append(selectedGift.name);
-                }
-                if (selectedGiftsEdit)
-                    selectedGiftsEdit->setText(selectedGiftsName.join(" / "));
-
-                // Disable gift buttons if event exists
-                if (!customEvent.eventID.isEmpty() && giftTabWidget) {
-                    for (int i = 0; i < giftTabWidget->count(); ++i) {
-                        QWidget* tab = giftTabWidget->widget(i);
-                        if (!tab)
-                            continue;
-                        const auto buttons = tab->findChildren<QPushButton*>();
-                        for (auto* btn : buttons) {
-                            if (btn->property("giftID").isValid())
-                                btn->setEnabled(false);
-                        }
+            filteredGiftTabs = result.value;
+
+            // Preselect the custom event's gifts; the event may have loaded first
+            selectedGifts.clear();
+            for (const auto& tab : filteredGiftTabs) {
+                for (const auto& gift : tab.gifts) {
+                    if (customEvent.giftIDs.contains(gift.giftID)) {
+                        selectedGifts.append(gift);
                     }
                 }
+            }
+            setupGiftTabsUI();
 
-                // Reflect selection
-                updateGiftSelectionUIFromCustomEvent();
-
-                thread->quit();
-            },
-            Qt::QueuedConnection);
-    });
+            // update selected gifts' name
+            QList<QString> selectedGiftsName;
+            for (auto selectedGift : selectedGifts) {
+                selectedGiftsName.append(selectedGift.name);
+            }
+            if (selectedGiftsEdit)
+                selectedGiftsEdit->setText(selectedGiftsName.join(" / "));
+
+            // Disable gift buttons if event exists
+            if (!customEvent.eventID.isEmpty() && giftTabWidget) {
+                for (int i = 0; i < giftTabWidget->count(); ++i) {
+                    QWidget* tab = giftTabWidget->widget(i);
+                    if (!tab)
+                        continue;
+                    const auto buttons = tab->findChildren<QPushButton*>();
+                    for (auto* btn : buttons) {
+                        if (btn->property("giftID").isValid())
+                            btn->setEnabled(false);
+                    }
+                }
+            }
 
-    connect(thread, &QThread::finished, worker, &QObject::deleteLater);
-    connect(thread, &QThread::finished, thread, &QObject::deleteLater);
-    thread->start();
+            // Reflect selection
+            updateGiftSelectionUIFromCustomEvent();
+        });
 }
 
 void OneSevenLiveCustomEventDialog::fetchCustomEventAsync() {
-    // Create a new thread and lightweight worker, following RockZoneDock pattern
-    QThread* thread = new QThread(this);
-    QObject* worker = new QObject();
-    worker->moveToThread(thread);
-
-    connect(thread, &QThread::started, worker, [this, worker, thread]() {
-        std::string userID;
-        if (configManager) {
-            configManager->getConfigValue("UserID", userID);
-        }
+    if (!apiWrapper) {
+        obs_log(LOG_ERROR, "Failed to get custom event");
+        return;
+    }
 
-        bool ok = false;
-        if (apiWrapper) {
-            ok = apiWrapper->GetCustomEvent(userID, customEvent);
-        }
+    std::string userID;
+    if (configManager) {
+        configManager->getConfigValue("UserID", userID);
+    }
 
-        QMetaObject::invokeMethod(
-            this,
-            [this, ok, thread]() {
-                // Update UI on main thread
-                if (!ok) {
-                    obs_log(LOG_ERROR, "Failed to get custom event");
-                } else {
-                    obs_log(LOG_INFO, "id=%s, customEvent.status = %d",
-                            customEvent.eventID.toStdString().c_str(), customEvent.status);
-
-                    // Populate fields
-                    eventTitleEdit->setText(customEvent.eventName);
-                    if (customEvent.endTime > 0) {
-                        QDateTime endDateTime = QDateTime::fromSecsSinceEpoch(customEvent.endTime);
-                        dateEdit->setDate(endDateTime.date());
-                    }
-                    descriptionEdit->setText(customEvent.description);
-                    dailyTargetEdit->setText(QString::number(customEvent.dailyGoalPoints));
-                    totalTargetEdit->setText(QString::number(customEvent.goalPoints));
-
-                    // If event exists, lock down inputs and switch bottom button accordingly
-                    if (!customEvent.eventID.isEmpty()) {
-                        eventTitleEdit->setEnabled(false);
-                        dateEdit->setEnabled(false);
-                        dailyTargetEdit->setEnabled(false);
-                        totalTargetEdit->setEnabled(false);
-                        descriptionEdit->setEnabled(false);
-                        // Disable gift selection buttons
-                        if (giftTabWidget) {
-                            for (int i = 0; i < giftTabWidget->count(); ++i) {
-                                QWidget* tab = giftTabWidget->widget(i);
-                                if (!tab)
-                                    continue;
-                                const auto buttons = tab->findChildren<QPushButton*>();
-                                for (auto* btn : buttons) {
-                                    if (btn->property("giftID").isValid())
-                                        btn->setEnabled(false);
-                                }
+    apiWrapper->GetCustomEventAsync(
+        userID, this, [this](const OneSevenLiveApiResult<OneSevenLiveCustomEvent>& result) {
+            // Update UI on main thread
+            if (!result.success) {
+                obs_log(LOG_ERROR, "Failed to get custom event");
+            } else {
+                customEvent = result.value;
+                obs_log(LOG_INFO, "id=%s, customEvent.status = %d",
+                        customEvent.eventID.toStdString().c_str(), customEvent.status);
+
+                // Populate fields
+                eventTitleEdit->setText(customEvent.eventName);
+                if (customEvent.endTime > 0) {
+                    QDateTime endDateTime = QDateTime::fromSecsSinceEpoch(customEvent.endTime);
+                    dateEdit->setDate(endDateTime.date());
+                }
+                descriptionEdit->setText(customEvent.description);
+                dailyTargetEdit->setText(QString::number(customEvent.dailyGoalPoints));
+                totalTargetEdit->setText(QString::number(customEvent.goalPoints));
+
+                // If event exists, lock down inputs and switch bottom button accordingly
+                if (!customEvent.eventID.isEmpty()) {
+                    eventTitleEdit->setEnabled(false);
+                    dateEdit->setEnabled(false);
+                    dailyTargetEdit->setEnabled(false);
+                    totalTargetEdit->setEnabled(false);
+                    descriptionEdit->setEnabled(false);
+                    // Disable gift selection buttons
+                    if (giftTabWidget) {
+                        for (int i = 0; i < giftTabWidget->count(); ++i) {
+                            QWidget* tab = giftTabWidget->widget(i);
+                            if (!tab)
+                                continue;
+                            const auto buttons = tab->findChildren<QPushButton*>();
+                            for (auto* btn : buttons) {
+                                if (btn->property("giftID").isValid())
+                                    btn->setEnabled(false);
                             }
                         }
+                    }
 
-                        // Update bottom button state
-                        if (createButton) {
-                            // Disconnect previous connections to avoid duplicates
-                            createButton->disconnect();
-                            if (customEvent.status == 1) {
-                                createButton->setText(obs_module_text("CustomEvent.Stop"));
-                                createButton->setStyleSheet(
-                                    "QPushButton {background-color: #007AFF; color: white;}");
-                                createButton->setObjectName("stopButton");
-                                connect(createButton, &QPushButton::clicked, this,
-                                        &OneSevenLiveCustomEventDialog::handleStopEvent);
-                            } else if (customEvent.status == 2) {
-                                createButton->setText(obs_module_text("CustomEvent.Close"));
-                                createButton->setStyleSheet(
-                                    "QPushButton {background-color: #007AFF; color: white;}");
-                                createButton->setObjectName("closeButton");
-                                connect(createButton, &QPushButton::clicked, this,
-                                        &OneSevenLiveCustomEventDialog::handleCloseEvent);
-                            } else {
-                                // Fallback to Create
-                                createButton->setText(obs_module_text("CustomEvent.Create"));
-                                createButton->setStyleSheet(
-                                    "QPushButton { background-color: #FF0001; color: white; }");
-                                createButton->setObjectName("createButton");
-                                connect(createButton, &QPushButton::clicked, this,
-                                        &OneSevenLiveCustomEventDialog::handleCreateEvent);
-                            }
+                    // Update bottom button state
+                    if (createButton) {
+                        // Disconnect previous connections to avoid duplicates
+                        createButton->disconnect();
+                        if (customEvent.status == 1) {
+                            createButton->setText(obs_module_text("CustomEvent.Stop"));
+                            createButton->setStyleSheet(
+                                "QPushButton {background-color: #007AFF; color: white;}");
+                            createButton->setObjectName("stopButton");
+                            connect(createButton, &QPushButton::clicked, this,
+                                    &OneSevenLiveCustomEventDialog::handleStopEvent);
+                        } else if (customEvent.status == 2) {
+                            createButton->setText(obs_module_text("CustomEvent.Close"));
+                            createButton->setStyleSheet(
+                                "QPushButton {background-color: #007AFF; color: white;}");
+                            createButton->setObjectName("closeButton");
+                            connect(createButton, &QPushButton::clicked, this,
+                                    &OneSevenLiveCustomEventDialog::handleCloseEvent);
+                        } else {
+                            // Fallback to Create
+                            createButton->setText(obs_module_text("CustomEvent.Create"));
+                            createButton->setStyleSheet(
+                                "QPushButton { background-color: #FF0001; color: white; }");
+                            createButton->setObjectName("createButton");
+                            connect(createButton, &QPushButton::clicked, this,
+                                    &OneSevenLiveCustomEventDialog::handleCreateEvent);
                         }
                     }
-
-                    // Synchronously update gift selection state (regardless of order)
-                    updateGiftSelectionUIFromCustomEvent();
                 }
 
-                // Stop thread after UI update
-                thread->quit();
-            },
-            Qt::QueuedConnection);
-    });
-
-    connect(thread, &QThread::finished, worker, &QObject::deleteLater);
-    connect(thread, &QThread::finished, thread, &QObject::deleteLater);
-    thread->start();
+                // Synchronously update gift selection state (regardless of order)
+                updateGiftSelectionUIFromCustomEvent();
+            }
+        });
 }
 
 void OneSevenLiveCustomEventDialog::updateGiftSelectionUIFromCustomEvent() {
@@ -1043,11 +1011,12 @@ void OneSevenLiveCustomEventDialog::populateGiftTab(const OneSevenLiveGiftTab& g
             QString iconUrl = "https://cdn.17app.co/" + gift.leaderboardIcon;
             imageLabel->setProperty("iconUrl", iconUrl);
 
-            RemoteTextThread* thread =
-                new RemoteTextThread(iconUrl.toStdString(), "image/png", "", 0, true);
+            RemoteRequest* request =
+                new RemoteRequest(iconUrl.toStdString(), "image/png", "", 0, true);
+            request->setCancellationToken(cancelToken);
 
             QPointer<QLabel> safeImageLabel = imageLabel;
-            connect(thread, &RemoteTextThread::ImageResult, this,
+            connect(request, &RemoteRequest::ImageResult, this,
                     [this, safeImageLabel](const QByteArray& imageData, const QString& error) {
                         if (error.isEmpty() && !imageData.isEmpty()) {
                             QPixmap pix;
@@ -1060,9 +1029,7 @@ void OneSevenLiveCustomEventDialog::populateGiftTab(const OneSevenLiveGiftTab& g
                         }
                     });
 
-            connect(thread, &QThread::finished, thread, &QObject::deleteLater);
-
-            thread->start();
+            request->start();
         }
 
         // Create name edit
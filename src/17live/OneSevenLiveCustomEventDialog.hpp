@@ -17,9 +17,11 @@
 #include <QTabWidget>
 #include <QTextEdit>
 #include <QVBoxLayout>
+#include <memory>
 
 #include "api/OneSevenLiveModels.hpp"
 
+class CancellationToken;
 class OneSevenLiveApiWrappers;
 class OneSevenLiveConfigManager;
 
@@ -125,6 +127,9 @@ class OneSevenLiveCustomEventDialog : public QDialog {
     // Config manager
     OneSevenLiveConfigManager* configManager;
 
+    // Canceled on destruction, aborting requests still in flight
+    std::shared_ptr<CancellationToken> cancelToken;
+
     // Constants
     static const int MAX_TITLE_LENGTH = 20;
     static const int MAX_DESCRIPTION_LENGTH = 200;
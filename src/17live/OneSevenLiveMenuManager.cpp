@@ -50,6 +50,11 @@ OneSevenLiveMenuManager::OneSevenLiveMenuManager(QMainWindow* parent)
     checkUpdateAction = menu->addAction(obs_module_text("Menu.CheckUpdate"));
     connect(checkUpdateAction, &QAction::triggered, this, &OneSevenLiveMenuManager::checkUpdate);
 
+    // Dump per-endpoint network statistics to the OBS log
+    networkStatsAction = menu->addAction(obs_module_text("Menu.NetworkStats"));
+    connect(networkStatsAction, &QAction::triggered, this,
+            [this]() { emit networkStatsClicked(); });
+
     menu->addSeparator();
 
     // Create login menu item
@@ -163,4 +168,5 @@ void OneSevenLiveMenuManager::cleanup() {
     helpAction = nullptr;
     loginAction = nullptr;
     checkUpdateAction = nullptr;
+    networkStatsAction = nullptr;
 }
@@ -43,6 +43,7 @@ class OneSevenLiveMenuManager : public QObject {
     void loginClicked();
     void logoutClicked();
     void checkUpdateClicked();
+    void networkStatsClicked();
 
    private:
     QMainWindow* mainWindow;
@@ -55,6 +56,7 @@ class OneSevenLiveMenuManager : public QObject {
     QAction* rockZoneAction;
     QAction* helpAction;
     QAction* checkUpdateAction;
+    QAction* networkStatsAction;
     QAction* loginAction;
     bool isLoggedIn;
 
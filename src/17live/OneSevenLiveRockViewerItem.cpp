@@ -16,7 +16,7 @@
 #include "api/OneSevenLiveApiWrappers.hpp"
 #include "api/OneSevenLiveUtility.hpp"
 #include "moc_OneSevenLiveRockViewerItem.cpp"
-#include "utility/RemoteTextThread.hpp"
+#include "utility/RemoteRequest.hpp"
 
 OneSevenLiveRockViewerItem::OneSevenLiveRockViewerItem(
     const OneSevenLiveRockZoneViewer &u, OneSevenLiveApiWrappers *apiWrapper_,
@@ -169,9 +169,9 @@ QLabel *OneSevenLiveRockViewerItem::setupAvatar() {
     // Load avatar image
     {
         const QString avatarUrl = buildUrl(user.displayUser.picture);
-        RemoteTextThread *thread =
-            new RemoteTextThread(avatarUrl.toStdString(), "image/png", "", 0, true);
-        connect(thread, &RemoteTextThread::ImageResult, this,
+        RemoteRequest *request =
+            new RemoteRequest(avatarUrl.toStdString(), "image/png", "", 0, true);
+        connect(request, &RemoteRequest::ImageResult, this,
                 [avatarReady, composedPixmap, composeAndSet](const QByteArray &imageData,
                                                              const QString &error) {
                     if (error.isEmpty() && !imageData.isEmpty()) {
@@ -194,8 +194,7 @@ QLabel *OneSevenLiveRockViewerItem::setupAvatar() {
                         composeAndSet();
                     }
                 });
-        connect(thread, &QThread::finished, thread, &QObject::deleteLater);
-        thread->start();
+        request->start();
     }
 
     {
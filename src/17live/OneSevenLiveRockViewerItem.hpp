@@ -15,7 +15,7 @@
 // Forward declarations
 class OneSevenLiveApiWrappers;
 class OneSevenLiveConfigManager;
-class RemoteTextThread;
+class RemoteRequest;
 
 // Rock Zone viewer list item widget
 class OneSevenLiveRockViewerItem : public QWidget {
@@ -18,8 +18,10 @@
 #include "OneSevenLiveConfigManager.hpp"
 #include "OneSevenLiveRockViewerItem.hpp"
 #include "OneSevenLiveUserDialog.hpp"
+#include "api/OneSevenLiveApiAsync.hpp"
 #include "api/OneSevenLiveApiWrappers.hpp"
 #include "plugin-support.h"
+#include "utility/CancellationToken.hpp"
 #include "utility/RemoteTextThread.hpp"
 
 OneSevenLiveRockZoneDock::OneSevenLiveRockZoneDock(QWidget* parent,
@@ -27,7 +29,8 @@ OneSevenLiveRockZoneDock::OneSevenLiveRockZoneDock(QWidget* parent,
                                                    OneSevenLiveConfigManager* configManager_)
     : QDockWidget(obs_module_text("RockZone.Title"), parent),
       apiWrapper(apiWrapper_),
-      configManager(configManager_) {
+      configManager(configManager_),
+      cancelToken(std::make_shared<CancellationToken>()) {
     setupUi();
     createConnections();
 
@@ -52,6 +55,9 @@ OneSevenLiveRockZoneDock::OneSevenLiveRockZoneDock(QWidget* parent,
 }
 
 OneSevenLiveRockZoneDock::~OneSevenLiveRockZoneDock() {
+    // Abort in-flight refreshes; they only hold copies of what they need and never call back
+    cancelToken->cancel();
+
     if (userDialog) {
         userDialog->deleteLater();
         userDialog = nullptr;
@@ -215,126 +221,122 @@ void OneSevenLiveRockZoneDock::refreshUserList() {
     std::string userID;
     configManager->getConfigValue("UserID", userID);
 
-    // Create new thread for API call to avoid UI blocking
-    QThread* thread = new QThread;
-    QObject* worker = new QObject;
-    worker->moveToThread(thread);
-
-    connect(thread, &QThread::started, worker, [this, worker, thread, roomID, userID]() {
-        // Execute API call in new thread
-        Json response;
-        bool success = apiWrapper->GetRockViewers(roomID, response);
-
-        OneSevenLiveArmyNameResponse armyNameResponse;
-
-        // Only call GetArmyName if not cached
-        if (!armyNameCached) {
-            apiWrapper->GetArmyName(userID, armyNameResponse);
-            cachedArmyNameResponse = armyNameResponse;
-            armyNameCached = true;
-        } else {
-            armyNameResponse = cachedArmyNameResponse;
-        }
-
-        // Use Qt::QueuedConnection to ensure UI updates happen on the main thread
-        QMetaObject::invokeMethod(
-            this,
-            [this, success, response, armyNameResponse, userID]() {
-                if (success) {
-                    QList<OneSevenLiveRockZoneViewer> users;
-                    JsonToOneSevenLiveRockViewers(response, users);
-
-                    // Merge viewers by userID and collect their types into badgeTypes
-                    QHash<QString, int> idIndex;  // userID -> index in viewersList
-                    viewersList.clear();
-                    for (const auto& user : users) {
-                        const QString uid = user.displayUser.userID.isEmpty()
-                                                ? user.giftRankOne.userID
-                                                : user.displayUser.userID;
-                        if (uid.isEmpty()) {
-                            continue;
-                        }
-                        if (uid == QString::fromStdString(userID)) {
-                            continue;
+    // A refresh still running when the next one is due is abandoned
+    CancellationScope scope(CancellationToken::child(
+        cancelToken, std::chrono::milliseconds(refreshTimer->interval())));
+
+    // The army name rarely changes, fetch it with the first refresh only
+    struct Refresh {
+        Json viewers;
+        OneSevenLiveArmyNameResponse armyName;
+    };
+    bool fetchArmyName = !armyNameCached;
+
+    OneSevenLiveApiAsync::call<Refresh>(
+        *apiWrapper, this,
+        [roomID, userID, fetchArmyName](OneSevenLiveApiWrappers& api, Refresh& out) {
+            bool success = api.GetRockViewers(roomID, out.viewers);
+            if (fetchArmyName)
+                api.GetArmyName(userID, out.armyName);
+            return success;
+        },
+        [this, fetchArmyName, userID](const OneSevenLiveApiResult<Refresh>& result) {
+            if (result.timedOut)
+                return;
+
+            if (fetchArmyName) {
+                cachedArmyNameResponse = result.value.armyName;
+                armyNameCached = true;
+            }
+            const Json& response = result.value.viewers;
+            const OneSevenLiveArmyNameResponse& armyNameResponse = cachedArmyNameResponse;
+
+            if (result.success) {
+                QList<OneSevenLiveRockZoneViewer> users;
+                JsonToOneSevenLiveRockViewers(response, users);
+
+                // Merge viewers by userID and collect their types into badgeTypes
+                QHash<QString, int> idIndex;  // userID -> index in viewersList
+                viewersList.clear();
+                for (const auto& user : users) {
+                    const QString uid = user.displayUser.userID.isEmpty()
+                                            ? user.giftRankOne.userID
+                                            : user.displayUser.userID;
+                    if (uid.isEmpty()) {
+                        continue;
+                    }
+                    if (uid == QString::fromStdString(userID)) {
+                        continue;
+                    }
+                    if (user.userAttr.sentPoint <= 0) {
+                        continue;
+                    }
+                    if (idIndex.contains(uid)) {
+                        auto& existing = viewersList[idIndex.value(uid)];
+                        if (!existing.badgeTypes.contains(user.type)) {
+                            existing.badgeTypes.append(user.type);
                         }
-                        if (user.userAttr.sentPoint <= 0) {
-                            continue;
+                        if (!existing.giftRankOne.userID.isEmpty()) {
+                            existing.displayUser = user.displayUser;
                         }
-                        if (idIndex.contains(uid)) {
-                            auto& existing = viewersList[idIndex.value(uid)];
-                            if (!existing.badgeTypes.contains(user.type)) {
-                                existing.badgeTypes.append(user.type);
-                            }
-                            if (!existing.giftRankOne.userID.isEmpty()) {
-                                existing.displayUser = user.displayUser;
-                            }
-                        } else {
-                            OneSevenLiveRockZoneViewer base = user;
-                            if (base.displayUser.userID.isEmpty()) {
-                                base.displayUser.userID = base.giftRankOne.userID;
-                                base.displayUser.displayName = base.giftRankOne.displayName;
-                                base.displayUser.picture = base.giftRankOne.picture;
-                            }
-
-                            base.badgeTypes.clear();
-                            base.badgeTypes.append(user.type);
-                            viewersList.push_back(base);
-                            idIndex.insert(uid, viewersList.size() - 1);
+                    } else {
+                        OneSevenLiveRockZoneViewer base = user;
+                        if (base.displayUser.userID.isEmpty()) {
+                            base.displayUser.userID = base.giftRankOne.userID;
+                            base.displayUser.displayName = base.giftRankOne.displayName;
+                            base.displayUser.picture = base.giftRankOne.picture;
                         }
+
+                        base.badgeTypes.clear();
+                        base.badgeTypes.append(user.type);
+                        viewersList.push_back(base);
+                        idIndex.insert(uid, viewersList.size() - 1);
                     }
+                }
 
-                    // Update UI
-                    userList->setVisible(true);
-
-                    // --- Incremental Update Section ---
-                    QSet<QString> newUserIDs;
-                    for (const auto& user : viewersList) {
-                        QString uid = user.displayUser.userID;
-                        newUserIDs.insert(uid);
-
-                        if (userItemMap.contains(uid)) {
-                            // Existing user, update item
-                            QListWidgetItem* item = userItemMap.value(uid);
-                            updateUserItem(item, user, armyNameResponse);
-                        } else {
-                            // New user
-                            QListWidgetItem* item = new QListWidgetItem(userList);
-                            updateUserItem(item, user, armyNameResponse);
-                            userList->addItem(item);
-                            userItemMap.insert(uid, item);
-                        }
+                // Update UI
+                userList->setVisible(true);
+
+                // --- Incremental Update Section ---
+                QSet<QString> newUserIDs;
+                for (const auto& user : viewersList) {
+                    QString uid = user.displayUser.userID;
+                    newUserIDs.insert(uid);
+
+                    if (userItemMap.contains(uid)) {
+                        // Existing user, update item
+                        QListWidgetItem* item = userItemMap.value(uid);
+                        updateUserItem(item, user, armyNameResponse);
+                    } else {
+                        // New user
+                        QListWidgetItem* item = new QListWidgetItem(userList);
+                        updateUserItem(item, user, armyNameResponse);
+                        userList->addItem(item);
+                        userItemMap.insert(uid, item);
                     }
+                }
 
-                    // Remove users that no longer exist
-                    auto it = userItemMap.begin();
-                    while (it != userItemMap.end()) {
-                        if (!newUserIDs.contains(it.key())) {
-                            QListWidgetItem* item = it.value();
-                            int row = userList->row(item);
-                            if (row >= 0) {
-                                QListWidgetItem* removed = userList->takeItem(row);
-                                delete removed;
-                            }
-                            it = userItemMap.erase(it);
-                        } else {
-                            ++it;
+                // Remove users that no longer exist
+                auto it = userItemMap.begin();
+                while (it != userItemMap.end()) {
+                    if (!newUserIDs.contains(it.key())) {
+                        QListWidgetItem* item = it.value();
+                        int row = userList->row(item);
+                        if (row >= 0) {
+                            QListWidgetItem* removed = userList->takeItem(row);
+                            delete removed;
                         }
+                        it = userItemMap.erase(it);
+                    } else {
+                        ++it;
                     }
-                } else {
-                    // Show error message
-                    obs_log(LOG_ERROR, "Failed to refresh rock viewers list: %s",
-                            apiWrapper->getLastErrorMessage().toStdString().c_str());
                 }
-            },
-            Qt::QueuedConnection);
-
-        // Clean up after completion
-        thread->quit();
-        worker->deleteLater();
-    });
-
-    connect(thread, &QThread::finished, thread, &QThread::deleteLater);
-    thread->start();
+            } else {
+                // Show error message
+                obs_log(LOG_ERROR, "Failed to refresh rock viewers list: %s",
+                        result.error.toStdString().c_str());
+            }
+        });
 }
 
 void OneSevenLiveRockZoneDock::clearArmyNameCache() {
@@ -357,23 +359,23 @@ void OneSevenLiveRockZoneDock::onPokeAllClicked() {
 
     // Create poke request
     OneSevenLivePokeAllRequest request;
-    OneSevenLivePokeResponse response;
     request.liveStreamID = QString::fromStdString(roomID);
     request.receiverGroup = 2;
 
-    // Send request
-    bool success = apiWrapper->PokeAll(request, response);
-
-    if (success) {
-        // Start cooldown timer
-        cooldownSeconds = 20;
-        pokeAllButton->setEnabled(false);
-        pokeAllButton->setText(QString("0:%1").arg(cooldownSeconds, 2, 10, QChar('0')));
-        cooldownTimer->start();
-    } else {
-        obs_log(LOG_WARNING, "PokeAll failed %s",
-                apiWrapper->getLastErrorMessage().toStdString().c_str());
-    }
+    // Send request, keeping the button disabled until it returns
+    pokeAllButton->setEnabled(false);
+    apiWrapper->PokeAllAsync(
+        request, this, [this](const OneSevenLiveApiResult<OneSevenLivePokeResponse>& result) {
+            if (result.success) {
+                // Start cooldown timer
+                cooldownSeconds = 20;
+                pokeAllButton->setText(QString("0:%1").arg(cooldownSeconds, 2, 10, QChar('0')));
+                cooldownTimer->start();
+            } else {
+                pokeAllButton->setEnabled(true);
+                obs_log(LOG_WARNING, "PokeAll failed %s", result.error.toStdString().c_str());
+            }
+        });
 }
 
 void OneSevenLiveRockZoneDock::handleTopLevelChanged(bool topLevel) {
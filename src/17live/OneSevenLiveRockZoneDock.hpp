@@ -8,10 +8,12 @@
 #include <QProgressBar>
 #include <QPushButton>
 #include <QTimer>
+#include <memory>
 
 #include "OneSevenLiveUserDialog.hpp"
 #include "api/OneSevenLiveModels.hpp"
 
+class CancellationToken;
 class OneSevenLiveApiWrappers;
 class OneSevenLiveConfigManager;
 
@@ -68,4 +70,7 @@ class OneSevenLiveRockZoneDock : public QDockWidget {
     QTimer* cooldownTimer = nullptr;
     int cooldownSeconds = 0;
     QString originalButtonText;
+
+    // Canceled on destruction, aborting requests still in flight
+    std::shared_ptr<CancellationToken> cancelToken;
 };
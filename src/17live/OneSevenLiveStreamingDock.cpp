@@ -11,17 +11,20 @@
 #include <QPushButton>
 #include <QRegularExpression>
 #include <QScrollArea>
-#include <QThread>
 #include <QTimer>
 #include <QUuid>
 #include <QVBoxLayout>
 
 #include "OneSevenLiveConfigManager.hpp"
 #include "OneSevenLiveCustomEventDialog.hpp"
+#include "api/OneSevenLiveApiAsync.hpp"
+#include "api/OneSevenLiveApiBatch.hpp"
 #include "api/OneSevenLiveApiWrappers.hpp"
 #include "moc_OneSevenLiveStreamingDock.cpp"
 #include "plugin-support.h"
 #include "utility/Common.hpp"
+#include "utility/ConnectionPrewarmer.hpp"
+#include "utility/DnsPrefetcher.hpp"
 #include "utility/Meta.hpp"
 
 OneSevenLiveStreamingDock::OneSevenLiveStreamingDock(QWidget *parent,
@@ -458,78 +461,91 @@ void OneSevenLiveStreamingDock::loadRoomInfo(qint64 roomID) {
         scrollArea->widget()->setEnabled(false);
     }
 
-    // TODO: The following code needs optimization, establish Worker class, put API calls in Worker
-    // class, send signals in Worker class, receive signals in main thread, update UI Create a new
-    // thread to execute API calls, avoiding UI blocking
-    QThread *thread = new QThread;
-    QObject *worker = new QObject;
-    worker->moveToThread(thread);
+    std::string region;
+    configManager->getConfigValue("Region", region);
+    std::string language = GetCurrentLanguage();
 
-    connect(thread, &QThread::started, worker, [this, roomID, worker, thread]() {
-        // Execute API calls in new thread
-        bool roomInfoSuccess = apiWrapper->GetRoomInfo(roomID, roomInfo);
+    std::string userID;
+    configManager->getConfigValue("UserID", userID);
 
-        std::string region;
-        configManager->getConfigValue("Region", region);
-        std::string language = GetCurrentLanguage();
-
-        std::string userID;
-        configManager->getConfigValue("UserID", userID);
-
-        // Get configStreamer information in the same thread
-        bool configStreamerSuccess =
-            apiWrapper->GetConfigStreamer(region, language, configStreamer);
-
-        bool userInfoSuccess = apiWrapper->GetUserInfo(userID, region, language, userInfo);
-
-        bool levelsSuccess = apiWrapper->GetArmySubscriptionLevels(region, language, levels);
-
-        // Use Qt::QueuedConnection to ensure UI updates in main thread
-        QMetaObject::invokeMethod(
-            this,
-            [this, roomInfoSuccess, configStreamerSuccess, userInfoSuccess, levelsSuccess]() {
-                // Hide loading state
-                isLoading = false;
-                loadingOverlay->setVisible(false);
+    // The four calls are independent: run them at once so the overlay only waits for the
+    // slowest one. The batch runs on the API pool and is canceled if the dock goes away.
+    auto batch = std::make_shared<OneSevenLiveApiBatch>(*apiWrapper);
+    const auto *roomInfoCall = &batch->add<OneSevenLiveRoomInfo>(
+        "GetRoomInfo", [roomID](OneSevenLiveApiWrappers &api, OneSevenLiveRoomInfo &out) {
+            return api.GetRoomInfo(roomID, out);
+        });
+    const auto *configStreamerCall = &batch->add<OneSevenLiveConfigStreamer>(
+        "GetConfigStreamer",
+        [region, language](OneSevenLiveApiWrappers &api, OneSevenLiveConfigStreamer &out) {
+            return api.GetConfigStreamer(region, language, out);
+        });
+    const auto *userInfoCall = &batch->add<OneSevenLiveUserInfo>(
+        "GetUserInfo",
+        [userID, region, language](OneSevenLiveApiWrappers &api, OneSevenLiveUserInfo &out) {
+            return api.GetUserInfo(userID, region, language, out);
+        });
+    const auto *levelsCall = &batch->add<OneSevenLiveArmySubscriptionLevels>(
+        "GetArmySubscriptionLevels",
+        [region, language](OneSevenLiveApiWrappers &api, OneSevenLiveArmySubscriptionLevels &out) {
+            return api.GetArmySubscriptionLevels(region, language, out);
+        });
 
-                // Enable all controls
-                QScrollArea *scrollArea = qobject_cast<QScrollArea *>(widget());
-                if (scrollArea && scrollArea->widget()) {
-                    scrollArea->widget()->setEnabled(true);
-                }
+    OneSevenLiveApiAsync::run(
+        this, [batch]() { return batch->run(); }, std::make_shared<OneSevenLiveApiStatus>(),
+        [this, batch, roomInfoCall, configStreamerCall, userInfoCall, levelsCall]() {
+            if (roomInfoCall->success) {
+                roomInfo = roomInfoCall->value;
 
-                if (configStreamerSuccess) {
-                    // Update UI
-                    updateUIWithRoomInfo();
-                } else {
-                    // Show error message
-                    QMessageBox::warning(
-                        this, obs_module_text("Live.Settings.Error"),
-                        QString::fromStdString(obs_module_text("Live.Settings.LoadError"))
-                            .arg(apiWrapper->getLastErrorMessage()));
-                }
+                // Warm the resolver for the ingest servers before the stream starts
+                for (const OneSevenLiveRtmpUrl &rtmpUrl : roomInfo.rtmpUrls)
+                    DnsPrefetcher::instance().addUrl(rtmpUrl.url.toStdString());
 
-                if (!roomInfoSuccess) {
-                    obs_log(LOG_WARNING, "Failed to get roomInfo in loadRoomInfo");
-                }
+                // Going live uses the first provider, check its ingest is reachable
+                if (!roomInfo.rtmpUrls.isEmpty())
+                    ConnectionPrewarmer::instance().probeIngest(
+                        roomInfo.rtmpUrls[0].url.toStdString());
+            }
+            if (configStreamerCall->success)
+                configStreamer = configStreamerCall->value;
+            if (userInfoCall->success)
+                userInfo = userInfoCall->value;
+            if (levelsCall->success)
+                levels = levelsCall->value;
+
+            // Hide loading state
+            isLoading = false;
+            loadingOverlay->setVisible(false);
+
+            // Enable all controls
+            QScrollArea *scrollArea = qobject_cast<QScrollArea *>(widget());
+            if (scrollArea && scrollArea->widget()) {
+                scrollArea->widget()->setEnabled(true);
+            }
 
-                if (!userInfoSuccess) {
-                    obs_log(LOG_WARNING, "Failed to get user info in loadRoomInfo");
-                }
+            if (configStreamerCall->success) {
+                // Update UI
+                updateUIWithRoomInfo();
+            } else {
+                // Show error message
+                QMessageBox::warning(
+                    this, obs_module_text("Live.Settings.Error"),
+                    QString::fromStdString(obs_module_text("Live.Settings.LoadError"))
+                        .arg(configStreamerCall->error));
+            }
 
-                if (!levelsSuccess) {
-                    obs_log(LOG_WARNING, "Failed to get army subscription levels in loadRoomInfo");
-                }
-            },
-            Qt::QueuedConnection);
+            if (!roomInfoCall->success) {
+                obs_log(LOG_WARNING, "Failed to get roomInfo in loadRoomInfo");
+            }
 
-        // Clean up after completion
-        thread->quit();
-        worker->deleteLater();
-    });
+            if (!userInfoCall->success) {
+                obs_log(LOG_WARNING, "Failed to get user info in loadRoomInfo");
+            }
 
-    connect(thread, &QThread::finished, thread, &QThread::deleteLater);
-    thread->start();
+            if (!levelsCall->success) {
+                obs_log(LOG_WARNING, "Failed to get army subscription levels in loadRoomInfo");
+            }
+        });
 }
 
 // Add new method to update UI based on roomInfo
@@ -31,14 +31,15 @@ void OneSevenLiveUpdateManager::checkForUpdates() {
     long responseCode = 0;
     bool success = GetRemoteFile("https://api.github.com/repos/17media/obs-plugin/releases",
                                  response, error, &responseCode, nullptr, "GET", nullptr,
-                                 {"User-Agent: 17Live-OBS-Plugin"}, nullptr, 10, true, 0);
+                                 {"User-Agent: 17Live-OBS-Plugin"}, nullptr, 10, true, 0, true);
 
     if (!success || responseCode != 200) {
         emit updateCheckFailed(QString::fromStdString(error));
         return;
     }
 
-    QJsonDocument jsonDoc = QJsonDocument::fromJson(QByteArray::fromStdString(response));
+    QJsonDocument jsonDoc = QJsonDocument::fromJson(
+        QByteArray::fromRawData(response.data(), (qsizetype) response.size()));
     if (jsonDoc.isNull() || !jsonDoc.isArray()) {
         emit updateCheckFailed("Invalid JSON response for update check");
         return;
@@ -62,8 +63,8 @@ void OneSevenLiveUpdateManager::checkForUpdates() {
     emit updateAvailable(latestVersion, latestRelease["assets"].toArray());
 }
 
-void OneSevenLiveUpdateManager::downloadUpdate(const QString& downloadUrl,
-                                               const QString& fileName) {
+void OneSevenLiveUpdateManager::downloadUpdate(const QString& downloadUrl, const QString& fileName,
+                                               const QString& expectedSha256) {
     QString downloadsPath = QStandardPaths::writableLocation(QStandardPaths::DownloadLocation);
     QString filePath = QDir(downloadsPath).absoluteFilePath(fileName);
 
@@ -96,10 +97,12 @@ void OneSevenLiveUpdateManager::downloadUpdate(const QString& downloadUrl,
     QThread* thread = new QThread;
     obs_log(LOG_INFO, "Downloading update from %s", downloadUrl.toUtf8().constData());
     obs_log(LOG_INFO, "Saving to %s", filePath.toUtf8().constData());
-    DownloadWorker* worker = new DownloadWorker(downloadUrl, filePath);
+    DownloadWorker* worker = new DownloadWorker(downloadUrl, filePath, expectedSha256);
     worker->moveToThread(thread);
 
     connect(thread, &QThread::started, worker, &DownloadWorker::process);
+    connect(worker, &DownloadWorker::progress, this,
+            &OneSevenLiveUpdateManager::onDownloadProgress);
     connect(worker, &DownloadWorker::finished, this,
             [this, thread, worker](bool success, const QString& error) {
                 if (downloadProgressDialog) {
@@ -107,11 +110,11 @@ void OneSevenLiveUpdateManager::downloadUpdate(const QString& downloadUrl,
                     downloadProgressDialog->deleteLater();
                     downloadProgressDialog = nullptr;
                 }
-                if (!success) {
+                if (!success && !worker->isCanceled()) {
                     QMessageBox::warning(
                         nullptr, obs_module_text("Update.DownloadFailed"),
                         QString(obs_module_text("Update.DownloadFailed.NetworkError")).arg(error));
-                } else {
+                } else if (success) {
                     onDownloadFinished();
                 }
                 thread->quit();
@@ -127,17 +130,18 @@ void OneSevenLiveUpdateManager::downloadUpdate(const QString& downloadUrl,
     downloadProgressDialog->show();
 }
 
-// void OneSevenLiveUpdateManager::onDownloadProgress(qint64 bytesReceived, qint64 bytesTotal) {
-//     if (downloadProgressDialog && bytesTotal > 0) {
-//         int progress = static_cast<int>((bytesReceived * 100) / bytesTotal);
-//         downloadProgressDialog->setValue(progress);
-
-//         QString progressText = QString(obs_module_text("Update.DownloadProgress"))
-//                                .arg(bytesReceived / 1024 / 1024)
-//                                .arg(bytesTotal / 1024 / 1024);
-//         downloadProgressDialog->setLabelText(progressText);
-//     }
-// }
+void OneSevenLiveUpdateManager::onDownloadProgress(qint64 bytesReceived, qint64 bytesTotal) {
+    if (downloadProgressDialog && bytesTotal > 0) {
+        int progress = static_cast<int>((bytesReceived * 100) / bytesTotal);
+        downloadProgressDialog->setRange(0, 100);
+        downloadProgressDialog->setValue(progress);
+
+        QString progressText = QString(obs_module_text("Update.DownloadProgress"))
+                                   .arg(bytesReceived / 1024 / 1024)
+                                   .arg(bytesTotal / 1024 / 1024);
+        downloadProgressDialog->setLabelText(progressText);
+    }
+}
 
 void OneSevenLiveUpdateManager::onDownloadFinished() {
     if (downloadProgressDialog) {
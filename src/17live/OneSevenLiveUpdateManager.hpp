@@ -13,7 +13,8 @@ class OneSevenLiveUpdateManager : public QObject {
 
     void checkForUpdates();
     QString getSystemInfo() const;
-    void downloadUpdate(const QString& downloadUrl, const QString& fileName);
+    void downloadUpdate(const QString& downloadUrl, const QString& fileName,
+                        const QString& expectedSha256 = QString());
 
    signals:
     void updateAvailable(const QString& latestVersion, const QJsonArray& assets);
@@ -21,7 +22,7 @@ class OneSevenLiveUpdateManager : public QObject {
     void updateCheckFailed(const QString& error);
 
    private slots:
-    // void onDownloadProgress(qint64 bytesReceived, qint64 bytesTotal);
+    void onDownloadProgress(qint64 bytesReceived, qint64 bytesTotal);
     void onDownloadFinished();
 
    private:
@@ -9,18 +9,21 @@
 #include <QPainter>
 #include <QPixmap>
 #include <QPointer>
-#include <QThread>
 
 #include "OneSevenLiveConfigManager.hpp"
 #include "api/OneSevenLiveApiWrappers.hpp"
 #include "plugin-support.h"
+#include "utility/CancellationToken.hpp"
 #include "utility/Common.hpp"
-#include "utility/RemoteTextThread.hpp"
+#include "utility/RemoteRequest.hpp"
 
 OneSevenLiveUserDialog::OneSevenLiveUserDialog(QWidget* parent,
                                                OneSevenLiveApiWrappers* apiWrapper_,
                                                OneSevenLiveConfigManager* configManager_)
-    : QDialog(parent), apiWrapper(apiWrapper_), configManager(configManager_) {
+    : QDialog(parent),
+      apiWrapper(apiWrapper_),
+      configManager(configManager_),
+      cancelToken(std::make_shared<CancellationToken>()) {
     setWindowTitle(QString());
     setWindowFlags(Qt::FramelessWindowHint | Qt::Tool);
     setAttribute(Qt::WA_TranslucentBackground, true);
@@ -32,7 +35,10 @@ OneSevenLiveUserDialog::OneSevenLiveUserDialog(QWidget* parent,
     createConnections();
 }
 
-OneSevenLiveUserDialog::~OneSevenLiveUserDialog() = default;
+OneSevenLiveUserDialog::~OneSevenLiveUserDialog() {
+    // Abort the avatar download; API calls are canceled with the dialog itself
+    cancelToken->cancel();
+}
 
 void OneSevenLiveUserDialog::setupUi() {
     // Root layout (no margins/spacings to fit 250x300 exactly)
@@ -226,10 +232,11 @@ void OneSevenLiveUserDialog::setUserInfo(const OneSevenLiveRockZoneViewer& user)
 
 void OneSevenLiveUserDialog::updateUserAvatar() {
     QString url = "https://cdn.17app.co/" + viewer.displayUser.picture;
-    RemoteTextThread* thread = new RemoteTextThread(url.toStdString(), "image/png", "", 0, true);
+    RemoteRequest* request = new RemoteRequest(url.toStdString(), "image/png", "", 0, true);
+    request->setCancellationToken(cancelToken);
 
     QPointer<QLabel> safeAvatarLabel = avatarLabel;
-    connect(thread, &RemoteTextThread::ImageResult, this,
+    connect(request, &RemoteRequest::ImageResult, this,
             [this, safeAvatarLabel](const QByteArray& imageData, const QString& error) {
                 if (error.isEmpty() && !imageData.isEmpty()) {
                     QPixmap avatar;
@@ -252,9 +259,7 @@ void OneSevenLiveUserDialog::updateUserAvatar() {
                 }
             });
 
-    connect(thread, &QThread::finished, thread, &QObject::deleteLater);
-
-    thread->start();
+    request->start();
 }
 
 void OneSevenLiveUserDialog::onPokeUserClicked() {
@@ -266,18 +271,18 @@ void OneSevenLiveUserDialog::onPokeUserClicked() {
 
     // Create poke request
     OneSevenLivePokeRequest request;
-    OneSevenLivePokeResponse response;
     request.userID = viewer.displayUser.userID;
     request.srcID = QString::fromStdString(roomID);
     request.isPokeBack = false;
 
-    // Send request
-    bool success = apiWrapper->PokeOne(request, response);
-
-    if (!success) {
-        obs_log(LOG_ERROR, "Failed to poke user %s",
-                apiWrapper->getLastErrorMessage().toStdString().c_str());
-    }
+    // Send request without a context object, so closing the dialog does not abort the poke
+    apiWrapper->PokeOneAsync(request, nullptr,
+                             [](const OneSevenLiveApiResult<OneSevenLivePokeResponse>& result) {
+                                 if (!result.success) {
+                                     obs_log(LOG_ERROR, "Failed to poke user %s",
+                                             result.error.toStdString().c_str());
+                                 }
+                             });
 }
 
 void OneSevenLiveUserDialog::onCloseClicked() {
@@ -311,10 +316,7 @@ void OneSevenLiveUserDialog::fetchUserInfo() {
         return;
     }
 
-    // Create a worker thread to fetch user info
-    QThread* workerThread = new QThread();
-
-    // Get user ID and region from config
+    // Get region from config
     std::string region;
     std::string language = GetCurrentLanguage();
     configManager->getConfigValue("Region", region);
@@ -323,33 +325,12 @@ void OneSevenLiveUserDialog::fetchUserInfo() {
         region = "TW";  // Default region
     }
 
-    QString userID = viewer.displayUser.userID;
-
-    // Use QPointer to safely access this object
-    QPointer<OneSevenLiveUserDialog> safeThis = this;
-
-    // Connect worker thread to perform API call
-    connect(workerThread, &QThread::started, [=]() {
-        OneSevenLiveUserInfo userInfo;
-        bool success = apiWrapper->GetUserInfo(userID.toStdString(), region, language, userInfo);
-
-        // Post result back to main thread
-        QMetaObject::invokeMethod(
-            safeThis,
-            [=]() {
-                if (safeThis && success) {
-                    safeThis->updateUserStats(userInfo);
-                }
-            },
-            Qt::QueuedConnection);
-
-        // Clean up thread
-        workerThread->quit();
-    });
-
-    connect(workerThread, &QThread::finished, workerThread, &QObject::deleteLater);
-
-    workerThread->start();
+    apiWrapper->GetUserInfoAsync(viewer.displayUser.userID.toStdString(), region, language, this,
+                                 [this](const OneSevenLiveApiResult<OneSevenLiveUserInfo>& result) {
+                                     if (result.success) {
+                                         updateUserStats(result.value);
+                                     }
+                                 });
 }
 
 void OneSevenLiveUserDialog::updateUserStats(const OneSevenLiveUserInfo& userInfo) {
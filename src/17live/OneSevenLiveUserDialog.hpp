@@ -8,10 +8,12 @@
 #include <QtWidgets/QLabel>
 #include <QtWidgets/QPushButton>
 #include <QtWidgets/QVBoxLayout>
+#include <memory>
 
 #include "api/OneSevenLiveModels.hpp"
 
 // Forward declarations
+class CancellationToken;
 class OneSevenLiveApiWrappers;
 class OneSevenLiveConfigManager;
 
@@ -62,4 +64,7 @@ class OneSevenLiveUserDialog : public QDialog {
     // Dragging functionality
     bool dragging = false;
     QPoint dragStartPosition;
+
+    // Canceled on destruction, aborting requests still in flight
+    std::shared_ptr<CancellationToken> cancelToken;
 };
@@ -0,0 +1,146 @@
+#include "OneSevenLiveApiAsync.hpp"
+
+#include <obs-module.h>
+
+#include <QThreadPool>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+#include "../utility/CancellationToken.hpp"
+#include "../utility/TransferShaper.hpp"
+#include "OneSevenLiveApiWrappers.hpp"
+#include "plugin-support.h"
+
+namespace {
+    // Where a finished call is delivered. The context is cleared, under the mutex, while the
+    // object is being destroyed, so a result is never posted to an object that is gone.
+    struct Delivery {
+        std::mutex mutex;
+        QObject *context = nullptr;
+        QMetaObject::Connection destroyedConnection;
+    };
+
+    std::atomic<uint64_t> startedCalls{0};
+    std::atomic<uint64_t> canceledCalls{0};
+    std::atomic<uint64_t> timedOutCalls{0};
+
+    // Parent of every call, canceled by shutdown() to abort the transfers that are still running
+    std::shared_ptr<CancellationToken> rootToken() {
+        static std::shared_ptr<CancellationToken> *root =
+            new std::shared_ptr<CancellationToken>(std::make_shared<CancellationToken>());
+        return *root;
+    }
+
+    QThreadPool *pool() {
+        static QThreadPool *threadPool = []() {
+            QThreadPool *created = new QThreadPool();
+            created->setMaxThreadCount(API_ASYNC_MAX_THREADS);
+            return created;
+        }();
+        return threadPool;
+    }
+}  // namespace
+
+std::shared_ptr<CancellationToken> OneSevenLiveApiAsync::call(
+    OneSevenLiveApiWrappers &api, QObject *context,
+    std::function<bool(OneSevenLiveApiWrappers &)> request,
+    OneSevenLiveApiStatusCallback callback) {
+    auto status = std::make_shared<OneSevenLiveApiStatus>();
+    OneSevenLiveApiWrappers *wrappers = &api;
+    return run(
+        context, [wrappers, request]() { return request(*wrappers); }, status,
+        [callback, status]() { callback(*status); });
+}
+
+std::shared_ptr<CancellationToken> OneSevenLiveApiAsync::run(
+    QObject *context, std::function<bool()> work, std::shared_ptr<OneSevenLiveApiStatus> status,
+    std::function<void()> done) {
+    using Clock = std::chrono::steady_clock;
+
+    std::shared_ptr<CancellationToken> token =
+        CancellationToken::linked(CancellationToken::current(), rootToken());
+    TransferClass transferClass = TransferShaper::current();
+    startedCalls.fetch_add(1, std::memory_order_relaxed);
+
+    bool hasContext = context != nullptr;
+    auto delivery = std::make_shared<Delivery>();
+    delivery->context = context;
+    if (context) {
+        // Runs on the destroying thread before the object is freed
+        delivery->destroyedConnection =
+            QObject::connect(context, &QObject::destroyed, [delivery, token]() {
+                std::lock_guard<std::mutex> lock(delivery->mutex);
+                delivery->context = nullptr;
+                token->cancel();
+            });
+    }
+
+    pool()->start([token, transferClass, delivery, work, status, done, hasContext]() {
+        if (!token->isCanceled()) {
+            CancellationScope scope(token);
+            TransferClassScope transferClassScope(transferClass);
+            Clock::time_point started = Clock::now();
+
+            // Nothing may leave the runnable, QThreadPool would terminate the process
+            try {
+                status->success = work();
+                status->httpStatus = OneSevenLiveApiWrappers::threadLastHttpStatus();
+                if (!status->success)
+                    status->error = OneSevenLiveApiWrappers::threadLastErrorMessage();
+            } catch (const std::exception &e) {
+                obs_log(LOG_ERROR, "[API Async] call threw: %s", e.what());
+                status->success = false;
+                status->error = QString::fromUtf8(e.what());
+            }
+            status->elapsedMs =
+                std::chrono::duration<double, std::milli>(Clock::now() - started).count();
+        }
+
+        if (!status->success) {
+            status->timedOut = token->hasDeadline() && token->remaining().count() == 0;
+            if (status->error.isEmpty())
+                status->error = status->timedOut ? QString("Request timed out")
+                                                 : QString("Request failed");
+        }
+
+        // Canceled by the caller or with the context object: nobody waits for the result
+        if (token->isCanceled() && !status->timedOut) {
+            canceledCalls.fetch_add(1, std::memory_order_relaxed);
+            QObject::disconnect(delivery->destroyedConnection);
+            return;
+        }
+        if (status->timedOut)
+            timedOutCalls.fetch_add(1, std::memory_order_relaxed);
+
+        if (!hasContext) {
+            done();
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(delivery->mutex);
+            if (delivery->context)
+                QMetaObject::invokeMethod(delivery->context, done, Qt::QueuedConnection);
+        }
+        // Once posted, the result is dropped by Qt if the object is destroyed before it runs
+        QObject::disconnect(delivery->destroyedConnection);
+    });
+
+    return token;
+}
+
+void OneSevenLiveApiAsync::shutdown() {
+    pool()->clear();
+    rootToken()->cancel();
+    if (!pool()->waitForDone(API_ASYNC_SHUTDOWN_WAIT_MS))
+        obs_log(LOG_WARNING, "[API Async] calls still running after %d ms",
+                API_ASYNC_SHUTDOWN_WAIT_MS);
+}
+
+void OneSevenLiveApiAsync::logStats() {
+    obs_log(LOG_INFO, "[API Async] calls: %llu, canceled: %llu, timed out: %llu",
+            (unsigned long long) startedCalls.load(std::memory_order_relaxed),
+            (unsigned long long) canceledCalls.load(std::memory_order_relaxed),
+            (unsigned long long) timedOutCalls.load(std::memory_order_relaxed));
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <functional>
+#include <memory>
+
+class CancellationToken;
+class OneSevenLiveApiWrappers;
+
+#define API_ASYNC_MAX_THREADS 8          // Pool threads blocking on API calls at once
+#define API_ASYNC_SHUTDOWN_WAIT_MS 3000  // How long shutdown() waits for running calls
+
+/**
+ * @brief Outcome of an API call made through OneSevenLiveApiAsync or OneSevenLiveApiBatch
+ */
+struct OneSevenLiveApiStatus {
+    bool success = false;
+    bool timedOut = false;  // Canceled because the deadline of the caller's token passed
+    QString error;          // Error message the call left on its thread
+    long httpStatus = 0;    // Of the call's last response, 0 if it got none
+    double elapsedMs = 0.0;
+};
+
+/**
+ * @brief Typed result of an API call
+ */
+template<typename T> struct OneSevenLiveApiResult : OneSevenLiveApiStatus {
+    T value{};
+};
+
+template<typename T>
+using OneSevenLiveApiCallback = std::function<void(const OneSevenLiveApiResult<T> &)>;
+using OneSevenLiveApiStatusCallback = std::function<void(const OneSevenLiveApiStatus &)>;
+
+/**
+ * @brief Runs blocking API calls on a shared thread pool
+ *
+ * The calls run on a pool of API_ASYNC_MAX_THREADS threads instead of a thread each, and the
+ * callback runs on the thread of a context object, usually the widget that shows the result.
+ * Each call runs under a child of the calling thread's CancellationToken::current(), so a scope
+ * installed around the call bounds it with a deadline; a call that runs past it is reported with
+ * timedOut set. The call is canceled when the context object is destroyed or the returned token
+ * is canceled, and a canceled call never calls back. shutdown() cancels every call still
+ * running. Without a context object the callback runs on the pool thread.
+ */
+class OneSevenLiveApiAsync {
+   public:
+    /**
+     * @brief Make a call that writes its result to a value
+     * @param api Wrapper to make the call on, must outlive the call
+     * @param context Object whose thread receives the callback, may be null
+     * @param request Makes the API call on the given wrapper, writing its result to the value
+     * @param callback Receives the result
+     * @return Token canceling the call
+     */
+    template<typename T>
+    static std::shared_ptr<CancellationToken> call(
+        OneSevenLiveApiWrappers &api, QObject *context,
+        std::function<bool(OneSevenLiveApiWrappers &, T &)> request,
+        OneSevenLiveApiCallback<T> callback) {
+        auto result = std::make_shared<OneSevenLiveApiResult<T>>();
+        OneSevenLiveApiWrappers *wrappers = &api;
+        return run(
+            context, [wrappers, request, result]() { return request(*wrappers, result->value); },
+            result, [callback, result]() { callback(*result); });
+    }
+
+    /**
+     * @brief Make a call that only reports whether it succeeded
+     */
+    static std::shared_ptr<CancellationToken> call(
+        OneSevenLiveApiWrappers &api, QObject *context,
+        std::function<bool(OneSevenLiveApiWrappers &)> request,
+        OneSevenLiveApiStatusCallback callback);
+
+    /**
+     * @brief Run work on the pool, fill in status and call done on the context's thread
+     * @param work Makes the calls, returns whether they succeeded
+     * @param status Filled in before done is called
+     */
+    static std::shared_ptr<CancellationToken> run(QObject *context, std::function<bool()> work,
+                                                  std::shared_ptr<OneSevenLiveApiStatus> status,
+                                                  std::function<void()> done);
+
+    /**
+     * @brief Drop queued calls, cancel running ones and wait up to API_ASYNC_SHUTDOWN_WAIT_MS for
+     * them to return
+     */
+    static void shutdown();
+
+    /**
+     * @brief Write call counters to the OBS log
+     */
+    static void logStats();
+};
@@ -0,0 +1,82 @@
+#include "OneSevenLiveApiBatch.hpp"
+
+#include <obs-module.h>
+
+#include <thread>
+
+#include "../utility/CancellationToken.hpp"
+#include "../utility/TransferShaper.hpp"
+#include "OneSevenLiveApiWrappers.hpp"
+#include "plugin-support.h"
+
+OneSevenLiveApiBatch::OneSevenLiveApiBatch(OneSevenLiveApiWrappers &api_) : api(api_) {}
+
+bool OneSevenLiveApiBatch::run(std::chrono::milliseconds deadline) {
+    using Clock = std::chrono::steady_clock;
+
+    std::shared_ptr<CancellationToken> token =
+        CancellationToken::child(CancellationToken::current(), deadline);
+    TransferClass transferClass = TransferShaper::current();
+    Clock::time_point started = Clock::now();
+
+    auto invoke = [this, &token](Entry &entry) {
+        Clock::time_point callStarted = Clock::now();
+        OneSevenLiveApiStatus &status = *entry.status;
+
+        // Runs on bare threads, an exception leaving it would terminate the process
+        QString thrown;
+        try {
+            status.success = entry.call(api);
+            status.httpStatus = OneSevenLiveApiWrappers::threadLastHttpStatus();
+        } catch (const std::exception &e) {
+            obs_log(LOG_ERROR, "[API Batch] %s threw: %s", entry.name.c_str(), e.what());
+            status.success = false;
+            thrown = QString::fromUtf8(e.what());
+        }
+        status.elapsedMs =
+            std::chrono::duration<double, std::milli>(Clock::now() - callStarted).count();
+        if (status.success)
+            return;
+
+        status.timedOut = token->hasDeadline() && token->remaining().count() == 0;
+        status.error =
+            thrown.isEmpty() ? OneSevenLiveApiWrappers::threadLastErrorMessage() : thrown;
+        if (status.error.isEmpty())
+            status.error = status.timedOut ? QString("Request timed out")
+                                           : QString::fromStdString(entry.name + " failed");
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < entries.size(); i++) {
+        threads.emplace_back([&, i]() {
+            CancellationScope scope(token);
+            TransferClassScope transferClassScope(transferClass);
+            invoke(entries[i]);
+        });
+    }
+
+    if (!entries.empty()) {
+        CancellationScope scope(token);
+        invoke(entries[0]);
+    }
+
+    for (std::thread &thread : threads)
+        thread.join();
+
+    double totalMs = std::chrono::duration<double, std::milli>(Clock::now() - started).count();
+    double sumMs = 0.0;
+    bool allSucceeded = true;
+    for (const Entry &entry : entries) {
+        sumMs += entry.status->elapsedMs;
+        if (!entry.status->success) {
+            allSucceeded = false;
+            obs_log(LOG_WARNING, "[API Batch] %s failed after %.0f ms%s: %s", entry.name.c_str(),
+                    entry.status->elapsedMs, entry.status->timedOut ? " (deadline)" : "",
+                    entry.status->error.toUtf8().constData());
+        }
+    }
+
+    obs_log(LOG_INFO, "[API Batch] %zu calls finished in %.0f ms (%.0f ms one after another)",
+            entries.size(), totalMs, sumMs);
+    return allSucceeded;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "OneSevenLiveApiAsync.hpp"
+
+#define API_BATCH_DEFAULT_DEADLINE_SEC 20  // Calls still running after this are canceled
+
+/**
+ * @brief Runs independent API calls concurrently
+ *
+ * Calls are added with add() and started together by run(), the first one on the calling thread
+ * and each other one on a thread of its own, so the batch takes as long as its slowest call
+ * instead of the sum of all of them. Every call runs under a child of the caller's
+ * CancellationToken that carries the batch deadline; a call still running when it passes is
+ * canceled. Calls must not depend on each other's results.
+ */
+class OneSevenLiveApiBatch {
+   public:
+    explicit OneSevenLiveApiBatch(OneSevenLiveApiWrappers &api);
+
+    /**
+     * @brief Add a call
+     * @param name Shown in the log
+     * @param call Makes the API call on the given wrapper, writing its result to the given value
+     * @return Result of the call, filled in by run() and valid as long as the batch
+     */
+    template<typename T>
+    const OneSevenLiveApiResult<T> &add(const char *name,
+                                        std::function<bool(OneSevenLiveApiWrappers &, T &)> call) {
+        auto result = std::make_shared<OneSevenLiveApiResult<T>>();
+        OneSevenLiveApiResult<T> *typed = result.get();
+        entries.push_back(Entry{name, result, [typed, call](OneSevenLiveApiWrappers &api) {
+                                    return call(api, typed->value);
+                                }});
+        return *typed;
+    }
+
+    /**
+     * @brief Run all calls and wait until each one returned or was canceled by the deadline
+     * @return true if every call succeeded
+     */
+    bool run(std::chrono::milliseconds deadline =
+                 std::chrono::seconds(API_BATCH_DEFAULT_DEADLINE_SEC));
+
+   private:
+    struct Entry {
+        std::string name;
+        std::shared_ptr<OneSevenLiveApiStatus> status;
+        std::function<bool(OneSevenLiveApiWrappers &)> call;
+    };
+
+    OneSevenLiveApiWrappers &api;
+    std::vector<Entry> entries;
+};
@@ -6,9 +6,23 @@
 #include <QFile>
 #include <QMimeDatabase>
 #include <QUrl>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <memory>
 
+#include "../utility/CancellationToken.hpp"
+#include "../utility/CircuitBreaker.hpp"
 #include "../utility/Common.hpp"
+#include "../utility/HttpEngine.hpp"
+#include "../utility/HttpMetrics.hpp"
+#include "../utility/HttpValidatorCache.hpp"
+#include "../utility/JsonStreamParser.hpp"
 #include "../utility/RemoteTextThread.hpp"
+#include "../utility/RequestCompression.hpp"
+#include "../utility/ResponseCache.hpp"
+#include "../utility/RetryPolicy.hpp"
+#include "../utility/TransferShaper.hpp"
 #include "plugin-support.h"
 
 using namespace std;
@@ -28,6 +42,11 @@ namespace {
 // Login API: ONESEVENLIVE_API_URL + "/api/v1/auth/loginAction"
 const string ONESEVENLIVE_LOGIN_URL = buildApiUrl("/api/v1/auth/loginAction");
 
+// Exchanges the refresh token of a login for a new access token. Set at configure time with
+// -DONESEVENLIVE_REFRESH_TOKEN_PATH; token refresh is off while it is empty.
+const string ONESEVENLIVE_REFRESH_TOKEN_URL =
+    ONESEVENLIVE_REFRESH_TOKEN_PATH[0] ? buildApiUrl(ONESEVENLIVE_REFRESH_TOKEN_PATH) : string();
+
 const string ONESEVENLIVE_APIGATEWAY_URL = buildApiUrl("/apiGateWay");
 
 const string ONESEVENLIVE_GET_ROOM_INFO_URL = buildApiUrl("/api/v1/lives/%1/info");
@@ -77,33 +96,230 @@ const string ONESEVENLIVE_POKE_ALL_URL = buildApiUrl("/api/v1/pokes/pokeAll");
 
 const string ONESEVENLIVE_CHANGE_EVENT_URL = buildApiUrl("/api/v1/liveStreams/event");
 
+// Group network timing of every request by the URL template it was built from
+static void registerEndpointMetrics() {
+    static std::once_flag registered;
+    std::call_once(registered, []() {
+        for (const string *url : {
+                 &ONESEVENLIVE_LOGIN_URL,
+                 &ONESEVENLIVE_APIGATEWAY_URL,
+                 &ONESEVENLIVE_GET_ROOM_INFO_URL,
+                 &ONESEVENLIVE_CREATE_RTMP_URL,
+                 &ONESEVENLIVE_STREAM_URL,
+                 &ONESEVENLIVE_ALIVE_URL,
+                 &ONESEVENLIVE_ARCHIVE_URL,
+                 &ONESEVENLIVE_GET_CONFIG_STREAMER_URL,
+                 &ONESEVENLIVE_GET_RTMP_URL,
+                 &ONESEVENLIVE_GET_ARMYSUBSCRIPIONLEVELS_URL,
+                 &ONESEVENLIVE_GET_CONFIG_URL,
+                 &ONESEVENLIVE_GET_USERINFO_URL,
+                 &ONESEVENLIVE_CREATE_CUSTOMEVENT_URL,
+                 &ONESEVENLIVE_GET_CUSTOMEVENT_URL,
+                 &ONESEVENLIVE_CHANGE_CUSTOMEVENT_STATUS_URL,
+                 &ONESEVENLIVE_GET_ABLY_TOKEN_URL,
+                 &ONESEVENLIVE_GET_GIFTTABS_URL,
+                 &ONESEVENLIVE_GET_GIFTS_URL,
+                 &ONESEVENLIVE_GET_ROCKVIEWERS_URL,
+                 &ONESEVENLIVE_GET_ARMYNAME_URL,
+                 &ONESEVENLIVE_POKE_URL,
+                 &ONESEVENLIVE_POKE_ALL_URL,
+                 &ONESEVENLIVE_CHANGE_EVENT_URL}) {
+            HttpMetrics::instance().registerEndpoint(*url);
+        }
+        if (!ONESEVENLIVE_REFRESH_TOKEN_URL.empty())
+            HttpMetrics::instance().registerEndpoint(ONESEVENLIVE_REFRESH_TOKEN_URL);
+    });
+}
+
+// Only calls that are safe to send twice are retried; mutations such as StartStream or PokeAll
+// fail on the first error so the server never applies them twice
+static void registerRetryPolicies() {
+    static std::once_flag registered;
+    std::call_once(registered, []() {
+        RetryPolicyRegistry &registry = RetryPolicyRegistry::instance();
+
+        // Polled while live, a slow answer delays noticing a dropped stream
+        registry.declare("POST", ONESEVENLIVE_ALIVE_URL, RetryPolicy::idempotent());
+        registry.declare("GET", ONESEVENLIVE_GET_ROOM_INFO_URL, RetryPolicy::hedged());
+        registry.declare("GET", ONESEVENLIVE_GET_ROCKVIEWERS_URL, RetryPolicy::hedged());
+
+        for (const string *url : {
+                 &ONESEVENLIVE_GET_CONFIG_STREAMER_URL,
+                 &ONESEVENLIVE_GET_RTMP_URL,
+                 &ONESEVENLIVE_GET_ARMYSUBSCRIPIONLEVELS_URL,
+                 &ONESEVENLIVE_GET_CONFIG_URL,
+                 &ONESEVENLIVE_GET_USERINFO_URL,
+                 &ONESEVENLIVE_GET_CUSTOMEVENT_URL,
+                 &ONESEVENLIVE_GET_ABLY_TOKEN_URL,
+                 &ONESEVENLIVE_GET_GIFTTABS_URL,
+                 &ONESEVENLIVE_GET_GIFTS_URL,
+                 &ONESEVENLIVE_GET_ARMYNAME_URL}) {
+            registry.declare("GET", *url, RetryPolicy::idempotent());
+        }
+    });
+}
+
+// Calls whose bodies grow with user input: a custom event's rewards, an event change, a stream's
+// settings, a poke to every viewer. Set OBS_17LIVE_REQUEST_COMPRESSION=off to send them plain.
+static void registerCompressionPolicies() {
+    static std::once_flag registered;
+    std::call_once(registered, []() {
+        RequestCompression &compression = RequestCompression::instance();
+        for (const string *url : {
+                 &ONESEVENLIVE_CREATE_CUSTOMEVENT_URL,
+                 &ONESEVENLIVE_CHANGE_EVENT_URL,
+                 &ONESEVENLIVE_CREATE_RTMP_URL,
+                 &ONESEVENLIVE_POKE_ALL_URL}) {
+            compression.declare("POST", *url);
+        }
+    });
+}
+
+// Data that rarely changes is reused for a while instead of being fetched each time a dock or
+// dialog opens. The gift list is left out: it is large, and the config manager keeps it on disk.
+void OneSevenLiveApiWrappers::registerCachePolicies() {
+    using std::chrono::minutes;
+    using std::chrono::seconds;
+
+    responseCache.declare(ONESEVENLIVE_GET_CONFIG_STREAMER_URL, minutes(5));
+    responseCache.declare(ONESEVENLIVE_GET_CONFIG_URL, minutes(5));
+    responseCache.declare(ONESEVENLIVE_GET_ARMYSUBSCRIPIONLEVELS_URL, minutes(10));
+    responseCache.declare(ONESEVENLIVE_GET_ARMYNAME_URL, minutes(10));
+    responseCache.declare(ONESEVENLIVE_GET_GIFTTABS_URL, minutes(10));
+    responseCache.declare(ONESEVENLIVE_GET_USERINFO_URL, seconds(60));
+    responseCache.declare(ONESEVENLIVE_GET_CUSTOMEVENT_URL, seconds(60));
+
+    // The streamer config carries the selected event, the custom event, the archive setting and
+    // the last stream state; the user info says whether the user is live
+    const std::vector<std::string> streamState = {ONESEVENLIVE_GET_CONFIG_STREAMER_URL,
+                                                  ONESEVENLIVE_GET_USERINFO_URL};
+    const std::vector<std::string> customEvent = {ONESEVENLIVE_GET_CUSTOMEVENT_URL,
+                                                  ONESEVENLIVE_GET_CONFIG_STREAMER_URL};
+    responseCache.declareInvalidation("POST", ONESEVENLIVE_CHANGE_EVENT_URL,
+                                      {ONESEVENLIVE_GET_CONFIG_STREAMER_URL});
+    responseCache.declareInvalidation("POST", ONESEVENLIVE_ARCHIVE_URL,
+                                      {ONESEVENLIVE_GET_CONFIG_STREAMER_URL});
+    responseCache.declareInvalidation("POST", ONESEVENLIVE_CREATE_RTMP_URL, streamState);
+    responseCache.declareInvalidation("PATCH", ONESEVENLIVE_STREAM_URL, streamState);
+    responseCache.declareInvalidation("DELETE", ONESEVENLIVE_STREAM_URL, streamState);
+    responseCache.declareInvalidation("POST", ONESEVENLIVE_CREATE_CUSTOMEVENT_URL, customEvent);
+    responseCache.declareInvalidation("PATCH", ONESEVENLIVE_CHANGE_CUSTOMEVENT_STATUS_URL,
+                                      customEvent);
+}
+
 OneSevenLiveApiWrappers::OneSevenLiveApiWrappers() : token("") {
     currentOS = GetCurrentOS();
     currentOSVersion = GetCurrentOSVersion();
     currentPlatformUUID = GetCurrentPlatformUUID();
+    refreshGuard = std::make_shared<RefreshGuard>();
+    refreshGuard->api = this;
+    refreshCancel = std::make_shared<CancellationToken>();
+    publishRequestContext();
+    registerEndpointMetrics();
+    registerRetryPolicies();
+    registerCompressionPolicies();
+    registerCachePolicies();
 }
 
-OneSevenLiveApiWrappers::OneSevenLiveApiWrappers(std::string token_) : token(token_) {
+OneSevenLiveApiWrappers::OneSevenLiveApiWrappers(std::string token_)
+    : token(token_), expire_time(tokenExpiry(token_)) {
     currentOS = GetCurrentOS();
     currentOSVersion = GetCurrentOSVersion();
     currentPlatformUUID = GetCurrentPlatformUUID();
+    refreshGuard = std::make_shared<RefreshGuard>();
+    refreshGuard->api = this;
+    refreshCancel = std::make_shared<CancellationToken>();
+    publishRequestContext();
+    registerEndpointMetrics();
+    registerRetryPolicies();
+    registerCompressionPolicies();
+    registerCachePolicies();
 }
 
+OneSevenLiveApiWrappers::~OneSevenLiveApiWrappers() {
+    // Abort a running refresh and wait for it to let go of the wrapper
+    refreshCancel->cancel();
+    std::lock_guard<std::mutex> lock(refreshGuard->mutex);
+    refreshGuard->api = nullptr;
+}
+
+void OneSevenLiveApiWrappers::publishRequestContext() {
+    auto context = std::make_shared<RequestContext>();
+    context->token = token;
+    context->expireTime = expire_time;
+    context->renewable = !refresh_token.empty() && !ONESEVENLIVE_REFRESH_TOKEN_URL.empty();
+
+    // The device headers only change with the platform, which is read once at construction
+    std::shared_ptr<const RequestContext> previous = std::atomic_load(&requestContext);
+    if (previous) {
+        context->anonymousHeaders = previous->anonymousHeaders;
+    } else {
+        context->anonymousHeaders = std::make_shared<const HttpHeaderBlock>(
+            std::vector<std::string>{"Devicetype: WEB",
+                                     "version: " + std::string(PLUGIN_VERSION),
+                                     "OSVersion: " + currentOSVersion,
+                                     "hardware: " + currentOS,
+                                     "deviceName: OBSPlugin",
+                                     "deviceModel: OBSPlugin",
+                                     "deviceId: " + currentPlatformUUID});
+    }
+
+    if (previous && previous->token == token) {
+        context->headers = previous->headers;
+    } else {
+        std::vector<std::string> lines = context->anonymousHeaders->lines();
+        lines.insert(lines.begin(), "Authorization: Bearer " + token);
+        context->headers = std::make_shared<const HttpHeaderBlock>(std::move(lines));
+    }
+
+    std::atomic_store(&requestContext, std::shared_ptr<const RequestContext>(std::move(context)));
+}
+
+// Error of the last call made on each thread, so concurrent calls can tell their errors apart
+static thread_local QString threadErrorMessage;
+// HTTP status of the last call made on each thread, 401 after a rejected token
+static thread_local long threadHttpStatus = 0;
+
 void OneSevenLiveApiWrappers::setLastErrorMessage(const QString &message) {
+    threadErrorMessage = message;
     std::lock_guard<std::mutex> lock(stateMutex);
     lastErrorMessage = message;
 }
 
 void OneSevenLiveApiWrappers::clearLastErrorMessage() {
+    threadErrorMessage.clear();
+    threadHttpStatus = 0;
     std::lock_guard<std::mutex> lock(stateMutex);
     lastErrorMessage.clear();
 }
 
+QString OneSevenLiveApiWrappers::threadLastErrorMessage() {
+    return threadErrorMessage;
+}
+
+long OneSevenLiveApiWrappers::threadLastHttpStatus() {
+    return threadHttpStatus;
+}
+
+void OneSevenLiveApiWrappers::setLastErrorFromResponse(const Json &response) {
+    // Canceled, rejected and failed requests leave the response null, TryInsertCommand has set
+    // their error already
+    if (!response.is_object() || !response.contains("errorCode")) {
+        if (threadErrorMessage.isEmpty())
+            setLastErrorMessage("17Live API request failed");
+        return;
+    }
+
+    setLastErrorMessage(QString::fromStdString(response.value("errorCode", "")) + " " +
+                        QString::fromStdString(response.value("errorMessage", "")));
+}
+
 bool OneSevenLiveApiWrappers::TryInsertCommand(const char *url, const char *content_type,
                                                std::string request_type, const char *data,
                                                Json &json_out, long *error_code, int data_size,
                                                bool token_required,
-                                               const std::vector<std::string> extraHeaders) {
+                                               const std::vector<std::string> extraHeaders,
+                                               bool cacheable, bool streamParse) {
     long httpStatusCode = 0;
 
 #ifdef _DEBUG
@@ -113,93 +329,422 @@ bool OneSevenLiveApiWrappers::TryInsertCommand(const char *url, const char *cont
         obs_log(LOG_DEBUG, "17Live API command data: %s", data);
 #endif
 
-    std::vector<std::string> headers;
+    // Lock-free snapshot of the token and the prebuilt headers
+    std::shared_ptr<const RequestContext> context = std::atomic_load(&requestContext);
+    if (token_required && context->token.empty())
+        return false;
 
-    // Thread-safe access to token
-    std::string currentToken;
-    {
-        std::lock_guard<std::mutex> lock(stateMutex);
-        if (token_required && token.empty())
-            return false;
-        currentToken = token;
+    // Only a request on an expired token waits for the refresh; one close to expiry starts it in
+    // the background and goes out with the token it has, which is still valid
+    if (token_required && context->renewable && context->expireTime) {
+        const uint64_t now = (uint64_t) (getCurrentTimestampMs() / 1000);
+        if (now >= context->expireTime) {
+            if (UpdateAccessToken(context->token))
+                context = std::atomic_load(&requestContext);
+        } else if (now + TOKEN_REFRESH_MARGIN_SEC >= context->expireTime) {
+            refreshAccessTokenInBackground();
+        }
+    }
+
+    // Fresh answers of cached endpoints are served without a request
+    std::string responseKey;
+    if (request_type == "GET" && !data && responseCache.isCached(url)) {
+        responseKey = ResponseCache::keyFor(url, extraHeaders);
+        if (responseCache.lookup(responseKey, json_out)) {
+            if (error_code)
+                *error_code = 200;
+            return true;
+        }
     }
 
-    if (token_required)
-        headers.push_back("Authorization: Bearer " + currentToken);
+    // Only the request's own headers are copied, the common ones are linked in by the transport
+    const std::shared_ptr<const HttpHeaderBlock> &commonHeaders =
+        token_required ? context->headers : context->anonymousHeaders;
+    const std::vector<std::string> &headers = extraHeaders;
+
+    std::string method = request_type.empty() ? (data ? "POST" : "GET") : request_type;
+
+    // Large bodies go out gzip-compressed where the endpoint is declared to accept that
+    RequestCompression &compression = RequestCompression::instance();
+    size_t bodySize = data ? (data_size > 0 ? (size_t) data_size : strlen(data)) : 0;
+    std::string gzipBody;
+    std::vector<std::string> gzipHeaders;
+    if (compression.shouldCompress(method, url, bodySize) &&
+        RequestCompression::gzip(data, bodySize, gzipBody) && gzipBody.size() < bodySize) {
+        gzipHeaders = headers;
+        gzipHeaders.push_back("Content-Encoding: gzip");
+    } else {
+        gzipBody.clear();
+    }
+
+    auto perform = [&]() {
+        CommandResult result;
+        std::string output;
+        bool notModified = false;
+        // Increase timeout by the time it takes to transfer `data_size` at 1 Mbps
+        int timeout = 60 + data_size / 125000;
+
+        std::shared_ptr<CancellationToken> cancel = CancellationToken::current();
+        if (cancel && cancel->isCanceled()) {
+            result.canceled = true;
+            result.error = "Request canceled";
+            return result;
+        }
+
+        // Fail fast instead of waiting out the timeout while the endpoint is known to be down
+        CircuitBreaker &breaker = CircuitBreakerRegistry::instance().forUrl(url);
+        if (!breaker.allow()) {
+            // Not transient: retries would be rejected as well until the breaker half-opens
+            result.error = "Service temporarily unavailable (circuit open: " + breaker.name() + ")";
+            result.rejected = true;
+            return result;
+        }
+
+        // Parse the body while it downloads instead of collecting it first. The validator cache
+        // writes the chunks to disk as they arrive.
+        std::unique_ptr<JsonStreamParser> parser;
+        std::function<bool(const char *, size_t)> onData;
+        if (streamParse) {
+            parser = std::make_unique<JsonStreamParser>();
+            onData = [&parser](const char *chunk, size_t size) {
+                return parser->feed(chunk, size);
+            };
+        }
 
-    headers.push_back("Devicetype: WEB");
+        auto start = std::chrono::steady_clock::now();
+        if (!gzipBody.empty()) {
+            result.success = GetRemoteFile(url, output, result.error, &result.httpStatusCode,
+                                           content_type, request_type, gzipBody.data(),
+                                           gzipHeaders, nullptr, timeout, false,
+                                           (int) gzipBody.size(), false, nullptr, nullptr,
+                                           commonHeaders);
+            compression.recordSavings(bodySize, gzipBody.size());
+
+            // Later calls go out plain. This one is not resent: the request may not be safe to
+            // send twice, so the caller gets the 415.
+            if (result.success && result.httpStatusCode == 415)
+                compression.recordRejected(method, url);
+        } else {
+            result.success = GetRemoteFile(url, output, result.error, &result.httpStatusCode,
+                                           content_type, request_type, data, headers, nullptr,
+                                           timeout, false, data_size, cacheable, &notModified,
+                                           onData, commonHeaders);
+        }
+        result.empty = output.empty() && !(parser && parser->size());
+
+        // An abandoned call says nothing about the endpoint's health. This includes the losing
+        // copy of a hedged call, which is canceled once the other one answered.
+        if (!result.success && cancel && cancel->isCanceled()) {
+            breaker.abandon();
+            result.canceled = true;
+            return result;
+        }
 
-    // add plugin version
-    headers.push_back("version: " + std::string(PLUGIN_VERSION));
+        // Transport errors, 5xx and 429 count against the endpoint; other 4xx are caller errors
+        long status = result.httpStatusCode;
+        result.transient = !result.success || (status >= 500 && status != 501) ||
+                           status == 429 || status == 408;
+        if (!result.success || status >= 500 || status == 429) {
+            bool timedOut = std::chrono::steady_clock::now() - start >=
+                            std::chrono::milliseconds(timeout * 900);
+            breaker.recordFailure(timedOut);
+        } else {
+            breaker.recordSuccess();
+        }
 
-    // add OS version
-    headers.push_back("OSVersion: " + currentOSVersion);
+        if (!result.success || result.empty)
+            return result;
+
+        std::string cacheKey = cacheable ? HttpValidatorCache::keyFor(url, headers) : "";
+        if (notModified) {
+            std::lock_guard<std::mutex> lock(parsedResponsesMutex);
+            auto it = parsedResponses.find(cacheKey);
+            if (it != parsedResponses.end()) {
+                result.json = it->second;
+                result.parsed = true;
+                return result;
+            }
+        }
 
-    // add HW
-    headers.push_back("hardware: " + currentOS);
+        if (parser && parser->size()) {
+            std::string parseError;
+            result.parsed = parser->finish(result.json, parseError);
+            if (!result.parsed)
+                obs_log(LOG_ERROR, "Failed to parse JSON response: %s", parseError.c_str());
+        } else {
+            try {
+                result.json = Json::parse(output);
+                result.parsed = true;
+            } catch (const Json::parse_error &e) {
+                obs_log(LOG_ERROR, "Failed to parse JSON response: %s", e.what());
+            }
+        }
 
-    headers.push_back("deviceName: OBSPlugin");
-    headers.push_back("deviceModel: OBSPlugin");
+        if (cacheable && result.parsed && result.httpStatusCode == 200) {
+            std::lock_guard<std::mutex> lock(parsedResponsesMutex);
+            parsedResponses[cacheKey] = result.json;
+        }
+        return result;
+    };
 
-    headers.push_back("deviceId: " + currentPlatformUUID);
+    // Transient failures of endpoints declared idempotent are retried with backoff, and a call
+    // slower than usual may be hedged with a second copy
+    RetryPolicy policy = RetryPolicyRegistry::instance().forRequest(method, url);
+
+    auto attempt = [&]() {
+        // No hedging unless the breaker is closed: while half-open the copy would be rejected,
+        // and while open there is nothing to hedge
+        std::chrono::milliseconds delay(0);
+        if (policy.hedge &&
+            CircuitBreakerRegistry::instance().forUrl(url).state() == CircuitState::Closed)
+            delay = RetryPolicyRegistry::instance().hedgeDelay(url);
+        if (delay.count() <= 0)
+            return perform();
+
+        CommandResult copies[2];
+        int winner = RetryPolicyRegistry::instance().hedge(
+            [&](int copy) {
+                copies[copy] = perform();
+                // A copy turned away by the breaker must not cancel the other one
+                return !copies[copy].transient && !copies[copy].rejected;
+            },
+            delay);
+        return copies[winner];
+    };
 
-    // debug output headers
-    // for (const auto &header : headers) {
-    //   obs_log(LOG_INFO, "17Live API command header: %s", header.c_str());
-    // }
+    auto performWithRetry = [&]() {
+        uint64_t cacheGeneration = responseCache.generation();
+        CommandResult result = attempt();
+        for (int retry = 1; retry < policy.maxAttempts && result.transient; retry++) {
+            std::chrono::milliseconds delay = RetryPolicyRegistry::backoff(retry);
+            obs_log(LOG_INFO, "17Live API request failed (%s), retry %d/%d in %lld ms: %s",
+                    result.error.empty() ? std::to_string(result.httpStatusCode).c_str()
+                                         : result.error.c_str(),
+                    retry, policy.maxAttempts - 1, (long long) delay.count(), url);
+            if (!RetryPolicyRegistry::instance().waitBeforeRetry(delay))
+                break;
+            result = attempt();
+        }
+        result.cacheGeneration = cacheGeneration;
+        return result;
+    };
 
-    for (const auto &header : extraHeaders) {
-        headers.push_back(header);
+    CommandResult result;
+    if (request_type == "GET" && !data) {
+        // Identical GETs already in flight share one transfer and its parsed response
+        std::string key = request_type + " " + url;
+        for (const auto &header : headers) {
+            key += "\n";
+            key += header;
+        }
+        if (commonHeaders)
+            key += commonHeaders->key();  // Keeps requests made with different tokens apart
+        result = inflightCommands.run(key, performWithRetry);
+
+        // The call joined was canceled by its own caller, this one still wants the answer
+        std::shared_ptr<CancellationToken> cancel = CancellationToken::current();
+        if (result.canceled && !(cancel && cancel->isCanceled()))
+            result = performWithRetry();
+    } else {
+        result = performWithRetry();
+
+        // Even a failed mutation may have reached the server
+        responseCache.invalidateAfter(method, url);
     }
 
-    std::string output;
-    std::string error;
-    // Increase timeout by the time it takes to transfer `data_size` at 1 Mbps
-    int timeout = 60 + data_size / 125000;
-    bool success = GetRemoteFile(url, output, error, &httpStatusCode, content_type, request_type,
-                                 data, headers, nullptr, timeout, false, data_size);
+    httpStatusCode = result.httpStatusCode;
     if (error_code)
         *error_code = httpStatusCode;
 
-    if (!success || output.empty()) {
-        if (!error.empty())
-            obs_log(LOG_WARNING, "17Live API request failed: %s", error.c_str());
+    if (result.canceled) {
+        obs_log(LOG_DEBUG, "17Live API request canceled: %s", url);
+        setLastErrorMessage("Request canceled");
         return false;
     }
 
-    try {
-        json_out = Json::parse(output);
+    if (!result.success || result.empty) {
+        if (!result.error.empty()) {
+            obs_log(LOG_WARNING, "17Live API request failed: %s", result.error.c_str());
+            setLastErrorMessage(QString::fromStdString(result.error));
+        }
+        return false;
+    }
+
+    if (!result.parsed)
+        return false;
+
+    // Errors come back as 200 with an errorCode as well, those are not kept
+    if (!responseKey.empty() && httpStatusCode == 200 && !result.json.contains("errorCode"))
+        responseCache.store(url, responseKey, result.json, result.cacheGeneration);
+
+    json_out = std::move(result.json);
 #ifdef _DEBUG
-        obs_log(LOG_DEBUG, "17Live API command answer: %s", json_out.dump().c_str());
+    obs_log(LOG_DEBUG, "17Live API command answer: %s", json_out.dump().c_str());
 #endif
-    } catch (const Json::parse_error &e) {
-        obs_log(LOG_ERROR, "Failed to parse JSON response: %s", e.what());
+    return httpStatusCode < 400;
+}
+
+void OneSevenLiveApiWrappers::logRequestStats() const {
+    obs_log(LOG_INFO, "17Live API coalesced requests: %llu joined, %llu sent",
+            (unsigned long long) inflightCommands.hits(),
+            (unsigned long long) inflightCommands.misses());
+    CircuitBreakerRegistry::instance().logStats();
+    RetryPolicyRegistry::instance().logStats();
+    RequestCompression::instance().logStats();
+    responseCache.logStats();
+    OneSevenLiveApiAsync::logStats();
+}
+
+uint64_t OneSevenLiveApiWrappers::tokenExpiry(const std::string &jwt) {
+    // header.payload.signature, the payload being base64url-encoded JSON
+    const size_t first = jwt.find('.');
+    const size_t second = first == std::string::npos ? first : jwt.find('.', first + 1);
+    if (second == std::string::npos)
+        return 0;
+
+    const QByteArray payload = QByteArray::fromBase64(
+        QByteArray::fromStdString(jwt.substr(first + 1, second - first - 1)),
+        QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals);
+
+    const Json claims = Json::parse(payload.constData(), payload.constData() + payload.size(),
+                                    nullptr, false);
+    if (!claims.is_object() || !claims.contains("exp") || !claims["exp"].is_number())
+        return 0;
+
+    const double exp = claims["exp"].get<double>();
+    return exp > 0 ? (uint64_t) exp : 0;
+}
+
+bool OneSevenLiveApiWrappers::UpdateAccessToken(const std::string &staleToken) {
+    if (ONESEVENLIVE_REFRESH_TOKEN_URL.empty())
+        return false;  // No refresh endpoint configured, a rejected token needs a new login
+
+    std::lock_guard<std::mutex> refreshLock(refreshMutex);
+
+    std::string refreshToken;
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        // Renewed by another request while this one waited for the lock
+        if (token != staleToken)
+            return !token.empty();
+        refreshToken = refresh_token;
+    }
+
+    if (refreshToken.empty()) {
+        obs_log(LOG_WARNING, "[Token] No refresh token, the access token cannot be renewed");
         return false;
     }
-    return httpStatusCode < 400;
+
+    // Don't hammer the endpoint while it keeps failing; the request then fails with 401 as before
+    const int64_t now = getCurrentTimestampMs();
+    const int64_t lastAttempt = lastRefreshAttemptMs.load(std::memory_order_relaxed);
+    if (lastAttempt && now - lastAttempt < TOKEN_REFRESH_RETRY_SEC * 1000)
+        return false;
+    lastRefreshAttemptMs.store(now, std::memory_order_relaxed);
+
+    obs_log(LOG_INFO, "[Token] Refreshing access token");
+
+    const std::string postData = Json{{"refreshToken", refreshToken}}.dump();
+    Json json_out;
+    long error_code = 0;
+    if (!TryInsertCommand(ONESEVENLIVE_REFRESH_TOKEN_URL.c_str(), "application/json", "POST",
+                          postData.c_str(), json_out, &error_code, 0, false)) {
+        obs_log(LOG_WARNING, "[Token] Refresh failed, HTTP status %ld", error_code);
+        return false;
+    }
+
+    std::string accessToken;
+    std::string newRefreshToken;
+    try {
+        // Answered like Login: the tokens sit in "data", which may be a JSON string
+        Json tokens = json_out;
+        if (json_out.contains("data")) {
+            tokens = json_out["data"].is_string()
+                         ? Json::parse(json_out["data"].get<std::string>())
+                         : json_out["data"];
+        }
+        accessToken = tokens.value("jwtAccessToken", "");
+        newRefreshToken = tokens.value("refreshToken", "");
+    } catch (const std::exception &e) {
+        obs_log(LOG_WARNING, "[Token] Failed to parse refresh response: %s", e.what());
+        return false;
+    }
+
+    if (accessToken.empty()) {
+        obs_log(LOG_WARNING, "[Token] Refresh response carries no access token");
+        return false;
+    }
+
+    uint64_t expiry = 0;
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        // A login during the refresh wins over the refreshed token of the previous one
+        if (token != staleToken)
+            return !token.empty();
+        // Same account, so the cached answers stay valid
+        token = accessToken;
+        expire_time = tokenExpiry(accessToken);
+        if (!newRefreshToken.empty())
+            refresh_token = newRefreshToken;
+        refreshToken = refresh_token;
+        expiry = expire_time;
+        publishRequestContext();
+    }
+    lastRefreshAttemptMs.store(0, std::memory_order_relaxed);
+
+    obs_log(LOG_INFO, "[Token] Access token refreshed, expires in %lld s",
+            expiry ? (long long) expiry - (long long) (now / 1000) : -1LL);
+    emit tokenRefreshed(QString::fromStdString(accessToken), QString::fromStdString(refreshToken));
+    return true;
 }
 
-bool OneSevenLiveApiWrappers::UpdateAccessToken() {
-    obs_log(LOG_INFO, "Updating access token");
-    // TODO: implement
-    return false;
+void OneSevenLiveApiWrappers::refreshAccessTokenInBackground() {
+    if (refreshPending.exchange(true))
+        return;
+
+    std::string staleToken = getToken();
+    auto status = std::make_shared<OneSevenLiveApiStatus>();
+    std::shared_ptr<RefreshGuard> guard = refreshGuard;
+
+    // Canceled with the wrapper, not with the request that noticed the expiry
+    CancellationScope scope(refreshCancel);
+    OneSevenLiveApiAsync::run(
+        nullptr,
+        [guard, staleToken]() {
+            std::lock_guard<std::mutex> lock(guard->mutex);
+            if (!guard->api)
+                return false;
+
+            TransferClassScope transferClass(TransferClass::Interactive);
+            bool refreshed = guard->api->UpdateAccessToken(staleToken);
+            guard->api->refreshPending = false;
+            return refreshed;
+        },
+        status, []() {});
 }
 
 bool OneSevenLiveApiWrappers::InsertCommand(const char *url, const char *content_type,
                                             std::string request_type, const char *data,
                                             Json &json_out, int data_size, bool token_required,
-                                            const std::vector<std::string> extraHeaders) {
-    long error_code;
+                                            const std::vector<std::string> extraHeaders,
+                                            bool cacheable, bool streamParse) {
+    long error_code = 0;
     std::string error;
+    // A 401 renews the token only if no other request renewed it in the meantime
+    const std::string sentToken = getToken();
     bool success = TryInsertCommand(url, content_type, request_type, data, json_out, &error_code,
-                                    data_size, token_required, extraHeaders);
+                                    data_size, token_required, extraHeaders, cacheable,
+                                    streamParse);
+    threadHttpStatus = error_code;
 
-    if (error_code == 401) {
-        // Attempt to update access token and try again
-        if (!UpdateAccessToken())
+    if (error_code == 401 && token_required) {
+        // Rejected before the token's recorded expiry, e.g. revoked; renew and try once more
+        if (!UpdateAccessToken(sentToken))
             return false;
         success = TryInsertCommand(url, content_type, request_type, data, json_out, &error_code,
-                                   data_size);
+                                   data_size, token_required, extraHeaders, cacheable,
+                                   streamParse);
+        threadHttpStatus = error_code;
     }
 
     try {
@@ -222,9 +767,7 @@ bool OneSevenLiveApiWrappers::InsertCommand(const char *url, const char *content
             obs_log(LOG_ERROR, "17Live API error:\n\tHTTP status: %ld\n\tURL: %s\n\tJSON: %s",
                     error_code, url, json_out.dump().c_str());
 
-            const std::string errorCode = json_out["errorCode"].get<std::string>();
-            const std::string errorMessage = json_out["errorMessage"].get<std::string>();
-            setLastErrorMessage(QString::fromStdString(errorCode + " " + errorMessage));
+            setLastErrorFromResponse(json_out);
             // The existence of an error implies non-success even if the HTTP status code disagrees.
             success = false;
         }
@@ -313,7 +856,16 @@ bool OneSevenLiveApiWrappers::Login(const QString &username, const QString &pass
     }
 
     // save token to next call
-    token = loginData.jwtAccessToken.toStdString();
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        token = loginData.jwtAccessToken.toStdString();
+        refresh_token = loginData.refreshToken.toStdString();
+        expire_time = tokenExpiry(token);
+        publishRequestContext();
+    }
+    // Cached answers may belong to the previous account
+    responseCache.clear();
+    lastRefreshAttemptMs.store(0, std::memory_order_relaxed);
 
     return !loginData.jwtAccessToken.isEmpty();
 }
@@ -329,7 +881,7 @@ bool OneSevenLiveApiWrappers::OneSevenLiveApiWrappers::GetSelfInfo(
     if (!json_out.contains("openID")) {
         obs_log(LOG_ERROR, "GetSelfInfo response missing openID field: %s",
                 json_out.dump().c_str());
-        lastErrorMessage = "GetSelfInfo response missing openID field";
+        setLastErrorMessage("GetSelfInfo response missing openID field");
         return false;
     }
 
@@ -358,7 +910,7 @@ bool OneSevenLiveApiWrappers::ChangeEvent(const OneSevenLiveChangeEventRequest &
     Json requestData;
     if (!OneSevenLiveChangeEventRequestToJson(request, requestData)) {
         obs_log(LOG_ERROR, "Failed to convert request to JSON");
-        lastErrorMessage = "Failed to convert request to JSON";
+        setLastErrorMessage("Failed to convert request to JSON");
         return false;
     }
 
@@ -370,11 +922,7 @@ bool OneSevenLiveApiWrappers::ChangeEvent(const OneSevenLiveChangeEventRequest &
 
     if (!InsertCommand(url.constData(), "application/json", "POST", postData.c_str(), json_out)) {
         obs_log(LOG_ERROR, "ChangeEvent error: %s", json_out.dump().c_str());
-        // Pre-convert error strings to avoid repeated conversions
-        const std::string errorCodeStr = json_out["errorCode"].get<std::string>();
-        const std::string errorMessageStr = json_out["errorMessage"].get<std::string>();
-        lastErrorMessage =
-            QString::fromStdString(errorCodeStr) + " " + QString::fromStdString(errorMessageStr);
+        setLastErrorFromResponse(json_out);
         return false;
     }
 
@@ -385,8 +933,7 @@ bool OneSevenLiveApiWrappers::ChangeEvent(const OneSevenLiveChangeEventRequest &
     if (json_out.contains("errorCode")) {
         obs_log(LOG_ERROR, "ChangeEvent error: %s", json_out.dump().c_str());
         // lastErrorMessage = errorCode + errorMessage
-        lastErrorMessage = QString::fromStdString(json_out["errorCode"].get<std::string>()) + " " +
-                           QString::fromStdString(json_out["errorMessage"].get<std::string>());
+        setLastErrorFromResponse(json_out);
         return false;
     }
 
@@ -423,9 +970,7 @@ bool OneSevenLiveApiWrappers::CommonRequest(const std::string action, Json &json
     if (json_out_resp.contains("errorCode")) {
         obs_log(LOG_ERROR, "apiGateWay error: %s", json_out_resp.dump().c_str());
         // lastErrorMessage = errorCode + errorMessage
-        lastErrorMessage = QString::fromStdString(json_out_resp["errorCode"].get<std::string>()) +
-                           " " +
-                           QString::fromStdString(json_out_resp["errorMessage"].get<std::string>());
+        setLastErrorFromResponse(json_out_resp);
         return false;
     }
 
@@ -450,10 +995,10 @@ bool OneSevenLiveApiWrappers::GetRoomInfo(const qint64 roomID, OneSevenLiveRoomI
     Json json_out;
     if (!InsertCommand(url.constData(), "application/json", "GET", nullptr, json_out, 0, true)) {
         obs_log(LOG_ERROR, "GetRoomInfo failed %s", json_out.dump().c_str());
-        lastErrorMessage = QString::fromStdString("GetRoomInfo failed %s")
-                               .arg(json_out.dump().c_str())
-                               .toUtf8()
-                               .constData();
+        setLastErrorMessage(QString::fromStdString("GetRoomInfo failed %s")
+                                .arg(json_out.dump().c_str())
+                                .toUtf8()
+                                .constData());
 
         return false;
     }
@@ -461,7 +1006,7 @@ bool OneSevenLiveApiWrappers::GetRoomInfo(const qint64 roomID, OneSevenLiveRoomI
     // Use JsonToOneSevenLiveRoomInfo function to parse data to struct
     if (!JsonToOneSevenLiveRoomInfo(json_out, roomInfo)) {
         obs_log(LOG_ERROR, "Failed to parse room info data");
-        lastErrorMessage = "Failed to parse room info data";
+        setLastErrorMessage("Failed to parse room info data");
         return false;
     }
 
@@ -491,7 +1036,7 @@ bool OneSevenLiveApiWrappers::CreateRtmp(const OneSevenLiveRtmpRequest &request,
     Json requestData;
     if (!OneSevenLiveRtmpRequestToJson(request, requestData)) {
         obs_log(LOG_ERROR, "Failed to convert request to JSON");
-        lastErrorMessage = "Failed to convert request to JSON";
+        setLastErrorMessage("Failed to convert request to JSON");
         return false;
     }
 
@@ -513,14 +1058,13 @@ bool OneSevenLiveApiWrappers::CreateRtmp(const OneSevenLiveRtmpRequest &request,
     if (json_out.contains("errorCode")) {
         obs_log(LOG_ERROR, "CreateRtmp error: %s", json_out.dump().c_str());
         // lastErrorMessage = errorCode + errorMessage
-        lastErrorMessage = QString::fromStdString(json_out["errorCode"].get<std::string>()) + " " +
-                           QString::fromStdString(json_out["errorMessage"].get<std::string>());
+        setLastErrorFromResponse(json_out);
         return false;
     }
 
     if (!JsonToOneSevenLiveRtmpResponse(json_out, response)) {
         obs_log(LOG_ERROR, "Failed to convert response to struct");
-        lastErrorMessage = "Failed to convert response to struct";
+        setLastErrorMessage("Failed to convert response to struct");
         return false;
     }
 
@@ -545,9 +1089,7 @@ bool OneSevenLiveApiWrappers::StartStream(const std::string &liveStreamID,
     if (!InsertCommand(url.constData(), "application/json", "PATCH", postData.c_str(),
                        json_out_resp)) {
         obs_log(LOG_ERROR, "StartStream error: %s", json_out_resp.dump().c_str());
-        lastErrorMessage = QString::fromStdString(json_out_resp["errorCode"].get<std::string>()) +
-                           " " +
-                           QString::fromStdString(json_out_resp["errorMessage"].get<std::string>());
+        setLastErrorFromResponse(json_out_resp);
         return false;
     }
 
@@ -568,9 +1110,7 @@ bool OneSevenLiveApiWrappers::EnableStreamArchive(const std::string &liveStreamI
     // null post data, explicitly set request type as POST
     if (!InsertCommand(url.constData(), "application/json", "POST", nullptr, json_out_resp)) {
         obs_log(LOG_ERROR, "EnableStreamArchive error: %s", json_out_resp.dump().c_str());
-        lastErrorMessage = QString::fromStdString(json_out_resp["errorCode"].get<std::string>()) +
-                           " " +
-                           QString::fromStdString(json_out_resp["errorMessage"].get<std::string>());
+        setLastErrorFromResponse(json_out_resp);
         return false;
     }
     obs_log(LOG_INFO, "EnableStreamArchive success");
@@ -587,7 +1127,7 @@ bool OneSevenLiveApiWrappers::StopStream(const std::string &liveStreamID,
     Json requestData;
     if (!OneSevenLiveCloseLiveRequestToJson(request, requestData)) {
         obs_log(LOG_ERROR, "Failed to convert request to JSON");
-        lastErrorMessage = "Failed to convert request to JSON";
+        setLastErrorMessage("Failed to convert request to JSON");
         return false;
     }
     std::string postData = requestData.dump();
@@ -597,9 +1137,7 @@ bool OneSevenLiveApiWrappers::StopStream(const std::string &liveStreamID,
     if (!InsertCommand(url.constData(), "application/json", "DELETE", postData.c_str(),
                        json_out_resp)) {
         obs_log(LOG_ERROR, "StopStream error: %s", json_out_resp.dump().c_str());
-        lastErrorMessage = QString::fromStdString(json_out_resp["errorCode"].get<std::string>()) +
-                           " " +
-                           QString::fromStdString(json_out_resp["errorMessage"].get<std::string>());
+        setLastErrorFromResponse(json_out_resp);
         return false;
     }
 
@@ -640,11 +1178,7 @@ bool OneSevenLiveApiWrappers::CreateCustomEvent(const OneSevenLiveCustomEvent &r
         // Check if errorCode field exists
         if (json_out.contains("errorCode")) {
             obs_log(LOG_ERROR, "CreateCustomEvent error: %s", json_out.dump().c_str());
-            // Pre-convert error strings to avoid repeated conversions
-            const std::string errorCodeStr = json_out["errorCode"].get<std::string>();
-            const std::string errorMessageStr = json_out["errorMessage"].get<std::string>();
-            setLastErrorMessage(QString::fromStdString(errorCodeStr) + " " +
-                                QString::fromStdString(errorMessageStr));
+            setLastErrorFromResponse(json_out);
             return false;
         }
 
@@ -681,7 +1215,7 @@ bool OneSevenLiveApiWrappers::ChangeCustomEventStatus(
     Json requestData;
     if (!OneSevenLiveChangeCustomEventStatusRequestToJson(request, requestData)) {
         obs_log(LOG_ERROR, "Failed to convert request to JSON");
-        lastErrorMessage = "Failed to convert request to JSON";
+        setLastErrorMessage("Failed to convert request to JSON");
         return false;
     }
 
@@ -696,9 +1230,7 @@ bool OneSevenLiveApiWrappers::ChangeCustomEventStatus(
         if (json_out.contains("errorCode")) {
             obs_log(LOG_ERROR, "ChangeCustomEventStatus error: %s", json_out.dump().c_str());
             // lastErrorMessage = errorCode + errorMessage
-            setLastErrorMessage(
-                QString::fromStdString(json_out["errorCode"].get<std::string>()) + " " +
-                QString::fromStdString(json_out["errorMessage"].get<std::string>()));
+            setLastErrorFromResponse(json_out);
         }
         return false;
     }
@@ -719,9 +1251,7 @@ bool OneSevenLiveApiWrappers::CheckStream(const std::string &liveStreamID) {
     Json json_out_resp;
     if (!InsertCommand(url.constData(), "application/json", "POST", nullptr, json_out_resp)) {
         obs_log(LOG_ERROR, "CheckStream error: %s", json_out_resp.dump().c_str());
-        lastErrorMessage = QString::fromStdString(json_out_resp["errorCode"].get<std::string>()) +
-                           " " +
-                           QString::fromStdString(json_out_resp["errorMessage"].get<std::string>());
+        setLastErrorFromResponse(json_out_resp);
         return false;
     }
 
@@ -734,7 +1264,7 @@ bool OneSevenLiveApiWrappers::GetConfigStreamer(const std::string region,
                                                 OneSevenLiveConfigStreamer &response) {
     obs_log(LOG_INFO, "GetConfigStreamer");
 
-    lastErrorMessage.clear();
+    clearLastErrorMessage();
     QString urlStr = QString::fromStdString(ONESEVENLIVE_GET_CONFIG_STREAMER_URL);
     QByteArray url = urlStr.toUtf8();
 
@@ -743,18 +1273,18 @@ bool OneSevenLiveApiWrappers::GetConfigStreamer(const std::string region,
 
     std::string error;
     Json json_out_resp;
+    // Not validator-cached: the answer belongs to the logged in streamer, and the cache on disk
+    // is shared by every account on the machine
     if (!InsertCommand(url.constData(), "application/json", "GET", nullptr, json_out_resp, 0, true,
                        extraHeaders)) {
         obs_log(LOG_ERROR, "GetConfigStreamer error: %s", json_out_resp.dump().c_str());
-        lastErrorMessage = QString::fromStdString(json_out_resp["errorCode"].get<std::string>()) +
-                           " " +
-                           QString::fromStdString(json_out_resp["errorMessage"].get<std::string>());
+        setLastErrorFromResponse(json_out_resp);
         return false;
     }
 
     if (!JsonToOneSevenLiveConfigStreamer(json_out_resp, response)) {
         obs_log(LOG_ERROR, "Failed to convert response to struct");
-        lastErrorMessage = "Failed to convert response to struct";
+        setLastErrorMessage("Failed to convert response to struct");
         return false;
     }
 
@@ -766,7 +1296,7 @@ bool OneSevenLiveApiWrappers::GetRtmpByProvider(const std::string provider,
                                                 OneSevenLiveRtmpResponse &response) {
     obs_log(LOG_INFO, "GetRtmpByProvider");
 
-    lastErrorMessage.clear();
+    clearLastErrorMessage();
     QString urlStr = QString::fromStdString(ONESEVENLIVE_GET_RTMP_URL).arg(provider.c_str());
     QByteArray url = urlStr.toUtf8();
 
@@ -774,15 +1304,13 @@ bool OneSevenLiveApiWrappers::GetRtmpByProvider(const std::string provider,
     Json json_out_resp;
     if (!InsertCommand(url.constData(), "application/json", "GET", nullptr, json_out_resp)) {
         obs_log(LOG_ERROR, "GetRtmpByProvider error: %s", json_out_resp.dump().c_str());
-        lastErrorMessage = QString::fromStdString(json_out_resp["errorCode"].get<std::string>()) +
-                           " " +
-                           QString::fromStdString(json_out_resp["errorMessage"].get<std::string>());
+        setLastErrorFromResponse(json_out_resp);
         return false;
     }
 
     if (!JsonToOneSevenLiveRtmpResponse(json_out_resp, response)) {
         obs_log(LOG_ERROR, "Failed to convert response to struct");
-        lastErrorMessage = "Failed to convert response to struct";
+        setLastErrorMessage("Failed to convert response to struct");
         return false;
     }
 
@@ -794,7 +1322,7 @@ bool OneSevenLiveApiWrappers::GetArmySubscriptionLevels(
     OneSevenLiveArmySubscriptionLevels &response) {
     obs_log(LOG_INFO, "GetArmySubscriptionLevels");
 
-    lastErrorMessage.clear();
+    clearLastErrorMessage();
     QString urlStr = QString::fromStdString(ONESEVENLIVE_GET_ARMYSUBSCRIPIONLEVELS_URL);
     QByteArray url = urlStr.toUtf8();
 
@@ -803,18 +1331,17 @@ bool OneSevenLiveApiWrappers::GetArmySubscriptionLevels(
 
     std::string error;
     Json json_out_resp;
+    // Per account, like GetConfigStreamer, so not validator-cached
     if (!InsertCommand(url.constData(), "application/json", "GET", nullptr, json_out_resp, 0, true,
                        extraHeaders)) {
         obs_log(LOG_ERROR, "GetArmySubscriptionLevels error: %s", json_out_resp.dump().c_str());
-        lastErrorMessage = QString::fromStdString(json_out_resp["errorCode"].get<std::string>()) +
-                           " " +
-                           QString::fromStdString(json_out_resp["errorMessage"].get<std::string>());
+        setLastErrorFromResponse(json_out_resp);
         return false;
     }
 
     if (!JsonToOneSevenLiveArmySubscriptionLevels(json_out_resp, response)) {
         obs_log(LOG_ERROR, "Failed to convert response to struct");
-        lastErrorMessage = "Failed to convert response to struct";
+        setLastErrorMessage("Failed to convert response to struct");
         return false;
     }
 
@@ -826,7 +1353,7 @@ bool OneSevenLiveApiWrappers::GetConfig(const std::string region, const std::str
                                         Json &json_out_resp) {
     obs_log(LOG_INFO, "GetConfig");
 
-    lastErrorMessage.clear();
+    clearLastErrorMessage();
     QString urlStr = QString::fromStdString(ONESEVENLIVE_GET_CONFIG_URL);
     QByteArray url = urlStr.toUtf8();
 
@@ -836,11 +1363,9 @@ bool OneSevenLiveApiWrappers::GetConfig(const std::string region, const std::str
     std::string error;
 
     if (!InsertCommand(url.constData(), "application/json", "GET", nullptr, json_out_resp, 0, true,
-                       extraHeaders)) {
+                       extraHeaders, true)) {
         obs_log(LOG_ERROR, "GetConfig error: %s", json_out_resp.dump().c_str());
-        lastErrorMessage = QString::fromStdString(json_out_resp["errorCode"].get<std::string>()) +
-                           " " +
-                           QString::fromStdString(json_out_resp["errorMessage"].get<std::string>());
+        setLastErrorFromResponse(json_out_resp);
         return false;
     }
 
@@ -852,7 +1377,7 @@ bool OneSevenLiveApiWrappers::GetUserInfo(const std::string userID, const std::s
                                           OneSevenLiveUserInfo &response) {
     obs_log(LOG_INFO, "GetUserInfo");
 
-    lastErrorMessage.clear();
+    clearLastErrorMessage();
     QString urlStr = QString::fromStdString(ONESEVENLIVE_GET_USERINFO_URL).arg(userID.c_str());
     QByteArray url = urlStr.toUtf8();
 
@@ -864,15 +1389,13 @@ bool OneSevenLiveApiWrappers::GetUserInfo(const std::string userID, const std::s
     if (!InsertCommand(url.constData(), "application/json", "GET", nullptr, json_out_resp, 0, true,
                        extraHeaders)) {
         obs_log(LOG_ERROR, "GetUserInfo error: %s", json_out_resp.dump().c_str());
-        lastErrorMessage = QString::fromStdString(json_out_resp["errorCode"].get<std::string>()) +
-                           " " +
-                           QString::fromStdString(json_out_resp["errorMessage"].get<std::string>());
+        setLastErrorFromResponse(json_out_resp);
         return false;
     }
 
     if (!JsonToOneSevenLiveUserInfo(json_out_resp, response)) {
         obs_log(LOG_ERROR, "Failed to convert response to struct");
-        lastErrorMessage = "Failed to convert response to struct";
+        setLastErrorMessage("Failed to convert response to struct");
         return false;
     }
 
@@ -882,15 +1405,14 @@ bool OneSevenLiveApiWrappers::GetUserInfo(const std::string userID, const std::s
 
 bool OneSevenLiveApiWrappers::GetAblyToken(const std::string &liveStreamID, Json &json_out) {
     // obs_log(LOG_INFO, "GetAblyToken");
-    lastErrorMessage.clear();
+    clearLastErrorMessage();
     QString urlStr =
         QString::fromStdString(ONESEVENLIVE_GET_ABLY_TOKEN_URL).arg(liveStreamID.c_str());
     QByteArray url = urlStr.toUtf8();
 
     if (!InsertCommand(url.constData(), "application/json", "GET", nullptr, json_out, 0, true)) {
         obs_log(LOG_ERROR, "GetAblyToken error: %s", json_out.dump().c_str());
-        lastErrorMessage = QString::fromStdString(json_out["errorCode"].get<std::string>()) + " " +
-                           QString::fromStdString(json_out["errorMessage"].get<std::string>());
+        setLastErrorFromResponse(json_out);
         return false;
     }
 
@@ -903,7 +1425,7 @@ bool OneSevenLiveApiWrappers::GetGiftTabs(const std::string &roomID, const std::
                                           Json &json_out_resp) {
     obs_log(LOG_INFO, "GetGiftTabs");
 
-    lastErrorMessage.clear();
+    clearLastErrorMessage();
 
     QString urlStr = QString::fromStdString(ONESEVENLIVE_GET_GIFTTABS_URL).arg(roomID.c_str());
     QByteArray url = urlStr.toUtf8();
@@ -911,11 +1433,9 @@ bool OneSevenLiveApiWrappers::GetGiftTabs(const std::string &roomID, const std::
     std::vector<std::string> extraHeaders = {"Language: " + language};
 
     if (!InsertCommand(url.constData(), "application/json", "GET", nullptr, json_out_resp, 0, true,
-                       extraHeaders)) {
+                       extraHeaders, false, true)) {
         obs_log(LOG_ERROR, "GetConfigStreamer error: %s", json_out_resp.dump().c_str());
-        lastErrorMessage = QString::fromStdString(json_out_resp["errorCode"].get<std::string>()) +
-                           " " +
-                           QString::fromStdString(json_out_resp["errorMessage"].get<std::string>());
+        setLastErrorFromResponse(json_out_resp);
         return false;
     }
 
@@ -925,18 +1445,16 @@ bool OneSevenLiveApiWrappers::GetGiftTabs(const std::string &roomID, const std::
 bool OneSevenLiveApiWrappers::GetGifts(const std::string language, Json &json_out_resp) {
     obs_log(LOG_INFO, "GetGifts: %s", language.c_str());
 
-    lastErrorMessage.clear();
+    clearLastErrorMessage();
 
     QByteArray url = ONESEVENLIVE_GET_GIFTS_URL.c_str();
 
     std::vector<std::string> extraHeaders = {"Language: " + language};
 
     if (!InsertCommand(url.constData(), "application/json", "GET", nullptr, json_out_resp, 0, true,
-                       extraHeaders)) {
+                       extraHeaders, true, true)) {
         obs_log(LOG_ERROR, "GetGifts error: %s", json_out_resp.dump().c_str());
-        lastErrorMessage = QString::fromStdString(json_out_resp["errorCode"].get<std::string>()) +
-                           " " +
-                           QString::fromStdString(json_out_resp["errorMessage"].get<std::string>());
+        setLastErrorFromResponse(json_out_resp);
         return false;
     }
 
@@ -948,16 +1466,14 @@ bool OneSevenLiveApiWrappers::GetGifts(const std::string language, Json &json_ou
 bool OneSevenLiveApiWrappers::GetRockViewers(const std::string &roomID, Json &json_out_resp) {
     // obs_log(LOG_INFO, "GetRockViewers");
 
-    lastErrorMessage.clear();
+    clearLastErrorMessage();
     QString urlStr = QString::fromStdString(ONESEVENLIVE_GET_ROCKVIEWERS_URL).arg(roomID.c_str());
     QByteArray url = urlStr.toUtf8();
 
     if (!InsertCommand(url.constData(), "application/json", "GET", nullptr, json_out_resp, 0,
                        true)) {
         obs_log(LOG_ERROR, "GetRockViewers error: %s", json_out_resp.dump().c_str());
-        lastErrorMessage = QString::fromStdString(json_out_resp["errorCode"].get<std::string>()) +
-                           " " +
-                           QString::fromStdString(json_out_resp["errorMessage"].get<std::string>());
+        setLastErrorFromResponse(json_out_resp);
         return false;
     }
 
@@ -969,7 +1485,7 @@ bool OneSevenLiveApiWrappers::GetCustomEvent(const std::string &userID,
                                              OneSevenLiveCustomEvent &response) {
     obs_log(LOG_INFO, "GetCustomEvent start");
 
-    lastErrorMessage.clear();
+    clearLastErrorMessage();
 
     // Build request URL with query parameter
     QString urlStr = QString::fromStdString(ONESEVENLIVE_GET_CUSTOMEVENT_URL) +
@@ -979,17 +1495,17 @@ bool OneSevenLiveApiWrappers::GetCustomEvent(const std::string &userID,
     Json json_out;
     if (!InsertCommand(url.constData(), "application/json", "GET", nullptr, json_out, 0, true)) {
         obs_log(LOG_ERROR, "GetCustomEvent failed %s", json_out.dump().c_str());
-        lastErrorMessage = QString::fromStdString("GetCustomEvent failed %s")
-                               .arg(json_out.dump().c_str())
-                               .toUtf8()
-                               .constData();
+        setLastErrorMessage(QString::fromStdString("GetCustomEvent failed %s")
+                                .arg(json_out.dump().c_str())
+                                .toUtf8()
+                                .constData());
         return false;
     }
 
     // Use JsonToOneSevenLiveCustomEvent function to parse data to struct
     if (!JsonToOneSevenLiveCustomEvent(json_out, response)) {
         obs_log(LOG_ERROR, "Failed to parse custom event data");
-        lastErrorMessage = "Failed to parse custom event data";
+        setLastErrorMessage("Failed to parse custom event data");
         return false;
     }
 
@@ -1000,7 +1516,7 @@ bool OneSevenLiveApiWrappers::GetCustomEvent(const std::string &userID,
 bool OneSevenLiveApiWrappers::GetArmyName(const std::string &userID,
                                           OneSevenLiveArmyNameResponse &response) {
     obs_log(LOG_INFO, "GetArmyName start");
-    lastErrorMessage.clear();
+    clearLastErrorMessage();
     QString urlStr = QString::fromStdString(ONESEVENLIVE_GET_ARMYNAME_URL).arg(userID.c_str());
     QByteArray url = urlStr.toUtf8();
 
@@ -1009,15 +1525,13 @@ bool OneSevenLiveApiWrappers::GetArmyName(const std::string &userID,
 
     if (!InsertCommand(url.constData(), "application/json", "GET", nullptr, json_out_resp)) {
         obs_log(LOG_ERROR, "GetArmyName error: %s", json_out_resp.dump().c_str());
-        lastErrorMessage = QString::fromStdString(json_out_resp["errorCode"].get<std::string>()) +
-                           " " +
-                           QString::fromStdString(json_out_resp["errorMessage"].get<std::string>());
+        setLastErrorFromResponse(json_out_resp);
         return false;
     }
 
     if (!JsonToOneSevenLiveArmyNameResponse(json_out_resp, response)) {
         obs_log(LOG_ERROR, "Failed to convert response to struct");
-        lastErrorMessage = "Failed to convert response to struct";
+        setLastErrorMessage("Failed to convert response to struct");
         return false;
     }
 
@@ -1029,7 +1543,7 @@ bool OneSevenLiveApiWrappers::PokeOne(const OneSevenLivePokeRequest &request,
                                       OneSevenLivePokeResponse &response) {
     obs_log(LOG_INFO, "PokeOne start");
 
-    lastErrorMessage.clear();
+    clearLastErrorMessage();
 
     QByteArray url = QByteArray(ONESEVENLIVE_POKE_URL.c_str());
     obs_log(LOG_INFO, "PokeOne url: %s", ONESEVENLIVE_POKE_URL.c_str());
@@ -1037,7 +1551,7 @@ bool OneSevenLiveApiWrappers::PokeOne(const OneSevenLivePokeRequest &request,
     Json requestData;
     if (!OneSevenLivePokeRequestToJson(request, requestData)) {
         obs_log(LOG_ERROR, "Failed to convert request to JSON");
-        lastErrorMessage = "Failed to convert request to JSON";
+        setLastErrorMessage("Failed to convert request to JSON");
         return false;
     }
 
@@ -1049,8 +1563,7 @@ bool OneSevenLiveApiWrappers::PokeOne(const OneSevenLivePokeRequest &request,
 
     if (!InsertCommand(url.constData(), "application/json", "POST", postData.c_str(), json_out)) {
         obs_log(LOG_ERROR, "PokeOne error: %s", json_out.dump().c_str());
-        lastErrorMessage = QString::fromStdString(json_out["errorCode"].get<std::string>()) + " " +
-                           QString::fromStdString(json_out["errorMessage"].get<std::string>());
+        setLastErrorFromResponse(json_out);
         return false;
     }
 
@@ -1061,14 +1574,13 @@ bool OneSevenLiveApiWrappers::PokeOne(const OneSevenLivePokeRequest &request,
     if (json_out.contains("errorCode")) {
         obs_log(LOG_ERROR, "PokeOne error: %s", json_out.dump().c_str());
         // lastErrorMessage = errorCode + errorMessage
-        lastErrorMessage = QString::fromStdString(json_out["errorCode"].get<std::string>()) + " " +
-                           QString::fromStdString(json_out["errorMessage"].get<std::string>());
+        setLastErrorFromResponse(json_out);
         return false;
     }
 
     if (!JsonToOneSevenLivePokeResponse(json_out, response)) {
         obs_log(LOG_ERROR, "Failed to convert response to struct");
-        lastErrorMessage = "Failed to convert response to struct";
+        setLastErrorMessage("Failed to convert response to struct");
         return false;
     }
 
@@ -1079,7 +1591,7 @@ bool OneSevenLiveApiWrappers::PokeAll(const OneSevenLivePokeAllRequest &request,
                                       OneSevenLivePokeResponse &response) {
     obs_log(LOG_INFO, "PokeAll start");
 
-    lastErrorMessage.clear();
+    clearLastErrorMessage();
 
     const QByteArray url = QByteArray(ONESEVENLIVE_POKE_ALL_URL.c_str());
     obs_log(LOG_INFO, "PokeAll url: %s", ONESEVENLIVE_POKE_ALL_URL.c_str());
@@ -1087,7 +1599,7 @@ bool OneSevenLiveApiWrappers::PokeAll(const OneSevenLivePokeAllRequest &request,
     Json requestData;
     if (!OneSevenLivePokeAllRequestToJson(request, requestData)) {
         obs_log(LOG_ERROR, "Failed to convert request to JSON");
-        lastErrorMessage = "Failed to convert request to JSON";
+        setLastErrorMessage("Failed to convert request to JSON");
         return false;
     }
 
@@ -1099,11 +1611,7 @@ bool OneSevenLiveApiWrappers::PokeAll(const OneSevenLivePokeAllRequest &request,
 
     if (!InsertCommand(url.constData(), "application/json", "POST", postData.c_str(), json_out)) {
         obs_log(LOG_ERROR, "PokeAll error: %s", json_out.dump().c_str());
-        // Pre-convert error strings to avoid repeated conversions
-        const std::string errorCodeStr = json_out["errorCode"].get<std::string>();
-        const std::string errorMessageStr = json_out["errorMessage"].get<std::string>();
-        lastErrorMessage =
-            QString::fromStdString(errorCodeStr) + " " + QString::fromStdString(errorMessageStr);
+        setLastErrorFromResponse(json_out);
         return false;
     }
 
@@ -1113,19 +1621,285 @@ bool OneSevenLiveApiWrappers::PokeAll(const OneSevenLivePokeAllRequest &request,
     // Check if errorCode field exists
     if (json_out.contains("errorCode")) {
         obs_log(LOG_ERROR, "PokeAll error: %s", json_out.dump().c_str());
-        // Pre-convert error strings to avoid repeated conversions
-        const std::string errorCodeStr = json_out["errorCode"].get<std::string>();
-        const std::string errorMessageStr = json_out["errorMessage"].get<std::string>();
-        lastErrorMessage =
-            QString::fromStdString(errorCodeStr) + " " + QString::fromStdString(errorMessageStr);
+        setLastErrorFromResponse(json_out);
         return false;
     }
 
     if (!JsonToOneSevenLivePokeResponse(json_out, response)) {
         obs_log(LOG_ERROR, "Failed to convert response to struct");
-        lastErrorMessage = "Failed to convert response to struct";
+        setLastErrorMessage("Failed to convert response to struct");
         return false;
     }
 
     return true;
 }
+
+// Asynchronous variants
+
+std::shared_ptr<CancellationToken> OneSevenLiveApiWrappers::LoginAsync(
+    const QString &username, const QString &password, QObject *context,
+    OneSevenLiveApiCallback<OneSevenLiveLoginData> callback) {
+    return OneSevenLiveApiAsync::call<OneSevenLiveLoginData>(
+        *this, context,
+        [username, password](OneSevenLiveApiWrappers &api, OneSevenLiveLoginData &out) {
+            return api.Login(username, password, out);
+        },
+        callback);
+}
+
+std::shared_ptr<CancellationToken> OneSevenLiveApiWrappers::GetSelfInfoAsync(
+    QObject *context, OneSevenLiveApiCallback<OneSevenLiveLoginData> callback) {
+    return OneSevenLiveApiAsync::call<OneSevenLiveLoginData>(
+        *this, context,
+        [](OneSevenLiveApiWrappers &api, OneSevenLiveLoginData &out) {
+            return api.GetSelfInfo(out);
+        },
+        callback);
+}
+
+std::shared_ptr<CancellationToken> OneSevenLiveApiWrappers::CommonRequestAsync(
+    const std::string action, QObject *context, OneSevenLiveApiCallback<Json> callback) {
+    return OneSevenLiveApiAsync::call<Json>(
+        *this, context,
+        [action](OneSevenLiveApiWrappers &api, Json &out) {
+            return api.CommonRequest(action, out);
+        },
+        callback);
+}
+
+std::shared_ptr<CancellationToken> OneSevenLiveApiWrappers::GetRoomInfoAsync(
+    const qint64 roomID, QObject *context, OneSevenLiveApiCallback<OneSevenLiveRoomInfo> callback) {
+    return OneSevenLiveApiAsync::call<OneSevenLiveRoomInfo>(
+        *this, context,
+        [roomID](OneSevenLiveApiWrappers &api, OneSevenLiveRoomInfo &out) {
+            return api.GetRoomInfo(roomID, out);
+        },
+        callback);
+}
+
+std::shared_ptr<CancellationToken> OneSevenLiveApiWrappers::CreateRtmpAsync(
+    const OneSevenLiveRtmpRequest &request, QObject *context,
+    OneSevenLiveApiCallback<OneSevenLiveRtmpResponse> callback) {
+    return OneSevenLiveApiAsync::call<OneSevenLiveRtmpResponse>(
+        *this, context,
+        [request](OneSevenLiveApiWrappers &api, OneSevenLiveRtmpResponse &out) {
+            return api.CreateRtmp(request, out);
+        },
+        callback);
+}
+
+std::shared_ptr<CancellationToken> OneSevenLiveApiWrappers::StartStreamAsync(
+    const std::string &liveStreamID, const std::string &userID, QObject *context,
+    OneSevenLiveApiStatusCallback callback) {
+    return OneSevenLiveApiAsync::call(
+        *this, context,
+        [liveStreamID, userID](OneSevenLiveApiWrappers &api) {
+            return api.StartStream(liveStreamID, userID);
+        },
+        callback);
+}
+
+std::shared_ptr<CancellationToken> OneSevenLiveApiWrappers::EnableStreamArchiveAsync(
+    const std::string &liveStreamID, int enableArchive, QObject *context,
+    OneSevenLiveApiStatusCallback callback) {
+    return OneSevenLiveApiAsync::call(
+        *this, context,
+        [liveStreamID, enableArchive](OneSevenLiveApiWrappers &api) {
+            return api.EnableStreamArchive(liveStreamID, enableArchive);
+        },
+        callback);
+}
+
+std::shared_ptr<CancellationToken> OneSevenLiveApiWrappers::StopStreamAsync(
+    const std::string &liveStreamID, const OneSevenLiveCloseLiveRequest &request, QObject *context,
+    OneSevenLiveApiStatusCallback callback) {
+    return OneSevenLiveApiAsync::call(
+        *this, context,
+        [liveStreamID, request](OneSevenLiveApiWrappers &api) {
+            return api.StopStream(liveStreamID, request);
+        },
+        callback);
+}
+
+std::shared_ptr<CancellationToken> OneSevenLiveApiWrappers::CheckStreamAsync(
+    const std::string &liveStreamID, QObject *context, OneSevenLiveApiStatusCallback callback) {
+    return OneSevenLiveApiAsync::call(
+        *this, context,
+        [liveStreamID](OneSevenLiveApiWrappers &api) {
+            return api.CheckStream(liveStreamID);
+        },
+        callback);
+}
+
+std::shared_ptr<CancellationToken> OneSevenLiveApiWrappers::GetConfigStreamerAsync(
+    const std::string region, const std::string language, QObject *context,
+    OneSevenLiveApiCallback<OneSevenLiveConfigStreamer> callback) {
+    return OneSevenLiveApiAsync::call<OneSevenLiveConfigStreamer>(
+        *this, context,
+        [region, language](OneSevenLiveApiWrappers &api, OneSevenLiveConfigStreamer &out) {
+            return api.GetConfigStreamer(region, language, out);
+        },
+        callback);
+}
+
+std::shared_ptr<CancellationToken> OneSevenLiveApiWrappers::GetAblyTokenAsync(
+    const std::string &liveStreamID, QObject *context, OneSevenLiveApiCallback<Json> callback) {
+    return OneSevenLiveApiAsync::call<Json>(
+        *this, context,
+        [liveStreamID](OneSevenLiveApiWrappers &api, Json &out) {
+            return api.GetAblyToken(liveStreamID, out);
+        },
+        callback);
+}
+
+std::shared_ptr<CancellationToken> OneSevenLiveApiWrappers::GetGiftTabsAsync(
+    const std::string &roomID, const std::string language, QObject *context,
+    OneSevenLiveApiCallback<Json> callback) {
+    return OneSevenLiveApiAsync::call<Json>(
+        *this, context,
+        [roomID, language](OneSevenLiveApiWrappers &api, Json &out) {
+            return api.GetGiftTabs(roomID, language, out);
+        },
+        callback);
+}
+
+std::shared_ptr<CancellationToken> OneSevenLiveApiWrappers::GetGiftsAsync(
+    const std::string language, QObject *context, OneSevenLiveApiCallback<Json> callback) {
+    return OneSevenLiveApiAsync::call<Json>(
+        *this, context,
+        [language](OneSevenLiveApiWrappers &api, Json &out) {
+            return api.GetGifts(language, out);
+        },
+        callback);
+}
+
+std::shared_ptr<CancellationToken> OneSevenLiveApiWrappers::GetRockViewersAsync(
+    const std::string &roomID, QObject *context, OneSevenLiveApiCallback<Json> callback) {
+    return OneSevenLiveApiAsync::call<Json>(
+        *this, context,
+        [roomID](OneSevenLiveApiWrappers &api, Json &out) {
+            return api.GetRockViewers(roomID, out);
+        },
+        callback);
+}
+
+std::shared_ptr<CancellationToken> OneSevenLiveApiWrappers::GetUserInfoAsync(
+    const std::string userID, const std::string region, const std::string language,
+    QObject *context, OneSevenLiveApiCallback<OneSevenLiveUserInfo> callback) {
+    return OneSevenLiveApiAsync::call<OneSevenLiveUserInfo>(
+        *this, context,
+        [userID, region, language](OneSevenLiveApiWrappers &api, OneSevenLiveUserInfo &out) {
+            return api.GetUserInfo(userID, region, language, out);
+        },
+        callback);
+}
+
+std::shared_ptr<CancellationToken> OneSevenLiveApiWrappers::GetConfigAsync(
+    const std::string region, const std::string language, QObject *context,
+    OneSevenLiveApiCallback<Json> callback) {
+    return OneSevenLiveApiAsync::call<Json>(
+        *this, context,
+        [region, language](OneSevenLiveApiWrappers &api, Json &out) {
+            return api.GetConfig(region, language, out);
+        },
+        callback);
+}
+
+std::shared_ptr<CancellationToken> OneSevenLiveApiWrappers::GetArmySubscriptionLevelsAsync(
+    const std::string region, const std::string language, QObject *context,
+    OneSevenLiveApiCallback<OneSevenLiveArmySubscriptionLevels> callback) {
+    return OneSevenLiveApiAsync::call<OneSevenLiveArmySubscriptionLevels>(
+        *this, context,
+        [region, language](OneSevenLiveApiWrappers &api, OneSevenLiveArmySubscriptionLevels &out) {
+            return api.GetArmySubscriptionLevels(region, language, out);
+        },
+        callback);
+}
+
+std::shared_ptr<CancellationToken> OneSevenLiveApiWrappers::GetRtmpByProviderAsync(
+    const std::string provider, QObject *context,
+    OneSevenLiveApiCallback<OneSevenLiveRtmpResponse> callback) {
+    return OneSevenLiveApiAsync::call<OneSevenLiveRtmpResponse>(
+        *this, context,
+        [provider](OneSevenLiveApiWrappers &api, OneSevenLiveRtmpResponse &out) {
+            return api.GetRtmpByProvider(provider, out);
+        },
+        callback);
+}
+
+std::shared_ptr<CancellationToken> OneSevenLiveApiWrappers::CreateCustomEventAsync(
+    const OneSevenLiveCustomEvent &request, QObject *context,
+    OneSevenLiveApiCallback<OneSevenLiveCustomEvent> callback) {
+    return OneSevenLiveApiAsync::call<OneSevenLiveCustomEvent>(
+        *this, context,
+        [request](OneSevenLiveApiWrappers &api, OneSevenLiveCustomEvent &out) {
+            return api.CreateCustomEvent(request, out);
+        },
+        callback);
+}
+
+std::shared_ptr<CancellationToken> OneSevenLiveApiWrappers::ChangeCustomEventStatusAsync(
+    const std::string &eventID, const OneSevenLiveCustomEventStatusRequest &request,
+    QObject *context, OneSevenLiveApiStatusCallback callback) {
+    return OneSevenLiveApiAsync::call(
+        *this, context,
+        [eventID, request](OneSevenLiveApiWrappers &api) {
+            return api.ChangeCustomEventStatus(eventID, request);
+        },
+        callback);
+}
+
+std::shared_ptr<CancellationToken> OneSevenLiveApiWrappers::GetCustomEventAsync(
+    const std::string &userID, QObject *context,
+    OneSevenLiveApiCallback<OneSevenLiveCustomEvent> callback) {
+    return OneSevenLiveApiAsync::call<OneSevenLiveCustomEvent>(
+        *this, context,
+        [userID](OneSevenLiveApiWrappers &api, OneSevenLiveCustomEvent &out) {
+            return api.GetCustomEvent(userID, out);
+        },
+        callback);
+}
+
+std::shared_ptr<CancellationToken> OneSevenLiveApiWrappers::GetArmyNameAsync(
+    const std::string &userID, QObject *context,
+    OneSevenLiveApiCallback<OneSevenLiveArmyNameResponse> callback) {
+    return OneSevenLiveApiAsync::call<OneSevenLiveArmyNameResponse>(
+        *this, context,
+        [userID](OneSevenLiveApiWrappers &api, OneSevenLiveArmyNameResponse &out) {
+            return api.GetArmyName(userID, out);
+        },
+        callback);
+}
+
+std::shared_ptr<CancellationToken> OneSevenLiveApiWrappers::PokeOneAsync(
+    const OneSevenLivePokeRequest &request, QObject *context,
+    OneSevenLiveApiCallback<OneSevenLivePokeResponse> callback) {
+    return OneSevenLiveApiAsync::call<OneSevenLivePokeResponse>(
+        *this, context,
+        [request](OneSevenLiveApiWrappers &api, OneSevenLivePokeResponse &out) {
+            return api.PokeOne(request, out);
+        },
+        callback);
+}
+
+std::shared_ptr<CancellationToken> OneSevenLiveApiWrappers::PokeAllAsync(
+    const OneSevenLivePokeAllRequest &request, QObject *context,
+    OneSevenLiveApiCallback<OneSevenLivePokeResponse> callback) {
+    return OneSevenLiveApiAsync::call<OneSevenLivePokeResponse>(
+        *this, context,
+        [request](OneSevenLiveApiWrappers &api, OneSevenLivePokeResponse &out) {
+            return api.PokeAll(request, out);
+        },
+        callback);
+}
+
+std::shared_ptr<CancellationToken> OneSevenLiveApiWrappers::ChangeEventAsync(
+    const OneSevenLiveChangeEventRequest &request, QObject *context,
+    OneSevenLiveApiStatusCallback callback) {
+    return OneSevenLiveApiAsync::call(
+        *this, context,
+        [request](OneSevenLiveApiWrappers &api) {
+            return api.ChangeEvent(request);
+        },
+        callback);
+}
@@ -2,10 +2,16 @@
 
 #include <QObject>
 #include <QString>
+#include <atomic>
+#include <map>
+#include <memory>
 #include <mutex>
 #include <nlohmann/json.hpp>
 
+#include "OneSevenLiveApiAsync.hpp"
 #include "OneSevenLiveModels.hpp"
+#include "../utility/ResponseCache.hpp"
+#include "../utility/SingleFlight.hpp"
 
 // for local http server proxy request
 /*
@@ -24,23 +30,40 @@
 
 #define MAX_CONSECUTIVE_FAILURES 10  // Maximum consecutive failure count
 
+#define TOKEN_REFRESH_MARGIN_SEC 300  // Refresh the access token this long before it expires
+#define TOKEN_REFRESH_RETRY_SEC 60    // Minimum time between two refresh attempts
+
 using Json = nlohmann::json;
 
+class HttpHeaderBlock;
+
+// All calls block the calling thread. Install a CancellationToken with CancellationScope to make
+// them cancelable; a deadline on the token bounds each call's timeout. The ...Async variants run
+// the same calls on the shared OneSevenLiveApiAsync pool and call back on the context object's
+// thread, unless the context object is destroyed first.
 class OneSevenLiveApiWrappers : public QObject {
     Q_OBJECT
 
+    // cacheable: send GETs as conditional requests and reuse the parsed response on 304. Only for
+    // answers that are the same for every account: the validator cache key leaves out the token.
+    // streamParse: parse the body while it downloads instead of collecting it first, for large
+    // responses
     bool TryInsertCommand(const char *url, const char *content_type, std::string request_type,
                           const char *data, Json &ret, long *error_code = nullptr,
                           int data_size = 0, bool token_required = true,
-                          const std::vector<std::string> extraHeaders = {});
-    bool UpdateAccessToken();
+                          const std::vector<std::string> extraHeaders = {},
+                          bool cacheable = false, bool streamParse = false);
+    bool UpdateAccessToken(const std::string &staleToken);
+    void refreshAccessTokenInBackground();
     bool InsertCommand(const char *url, const char *content_type, std::string request_type,
                        const char *data, Json &ret, int data_size = 0, bool token_required = true,
-                       const std::vector<std::string> extraHeaders = {});
+                       const std::vector<std::string> extraHeaders = {}, bool cacheable = false,
+                       bool streamParse = false);
 
    public:
     OneSevenLiveApiWrappers();
     OneSevenLiveApiWrappers(std::string token_);
+    ~OneSevenLiveApiWrappers() override;
 
     bool Login(const QString &username, const QString &password, OneSevenLiveLoginData &loginData);
 
@@ -90,6 +113,83 @@ class OneSevenLiveApiWrappers : public QObject {
     // Change event for live stream
     bool ChangeEvent(const OneSevenLiveChangeEventRequest &request);
 
+    // Asynchronous variants, see OneSevenLiveApiAsync. They return a token canceling the call.
+    std::shared_ptr<CancellationToken> LoginAsync(
+        const QString &username, const QString &password, QObject *context,
+        OneSevenLiveApiCallback<OneSevenLiveLoginData> callback);
+    std::shared_ptr<CancellationToken> GetSelfInfoAsync(
+        QObject *context, OneSevenLiveApiCallback<OneSevenLiveLoginData> callback);
+    std::shared_ptr<CancellationToken> CommonRequestAsync(const std::string action,
+                                                          QObject *context,
+                                                          OneSevenLiveApiCallback<Json> callback);
+    std::shared_ptr<CancellationToken> GetRoomInfoAsync(
+        const qint64 roomID, QObject *context,
+        OneSevenLiveApiCallback<OneSevenLiveRoomInfo> callback);
+    std::shared_ptr<CancellationToken> CreateRtmpAsync(
+        const OneSevenLiveRtmpRequest &request, QObject *context,
+        OneSevenLiveApiCallback<OneSevenLiveRtmpResponse> callback);
+    std::shared_ptr<CancellationToken> StartStreamAsync(const std::string &liveStreamID,
+                                                        const std::string &userID, QObject *context,
+                                                        OneSevenLiveApiStatusCallback callback);
+    std::shared_ptr<CancellationToken> EnableStreamArchiveAsync(
+        const std::string &liveStreamID, int enableArchive, QObject *context,
+        OneSevenLiveApiStatusCallback callback);
+    std::shared_ptr<CancellationToken> StopStreamAsync(const std::string &liveStreamID,
+                                                       const OneSevenLiveCloseLiveRequest &request,
+                                                       QObject *context,
+                                                       OneSevenLiveApiStatusCallback callback);
+    std::shared_ptr<CancellationToken> CheckStreamAsync(const std::string &liveStreamID,
+                                                        QObject *context,
+                                                        OneSevenLiveApiStatusCallback callback);
+    std::shared_ptr<CancellationToken> GetConfigStreamerAsync(
+        const std::string region, const std::string language, QObject *context,
+        OneSevenLiveApiCallback<OneSevenLiveConfigStreamer> callback);
+    std::shared_ptr<CancellationToken> GetAblyTokenAsync(const std::string &liveStreamID,
+                                                         QObject *context,
+                                                         OneSevenLiveApiCallback<Json> callback);
+    std::shared_ptr<CancellationToken> GetGiftTabsAsync(const std::string &roomID,
+                                                        const std::string language,
+                                                        QObject *context,
+                                                        OneSevenLiveApiCallback<Json> callback);
+    std::shared_ptr<CancellationToken> GetGiftsAsync(const std::string language, QObject *context,
+                                                     OneSevenLiveApiCallback<Json> callback);
+    std::shared_ptr<CancellationToken> GetRockViewersAsync(const std::string &roomID,
+                                                           QObject *context,
+                                                           OneSevenLiveApiCallback<Json> callback);
+    std::shared_ptr<CancellationToken> GetUserInfoAsync(
+        const std::string userID, const std::string region, const std::string language,
+        QObject *context, OneSevenLiveApiCallback<OneSevenLiveUserInfo> callback);
+    std::shared_ptr<CancellationToken> GetConfigAsync(const std::string region,
+                                                      const std::string language, QObject *context,
+                                                      OneSevenLiveApiCallback<Json> callback);
+    std::shared_ptr<CancellationToken> GetArmySubscriptionLevelsAsync(
+        const std::string region, const std::string language, QObject *context,
+        OneSevenLiveApiCallback<OneSevenLiveArmySubscriptionLevels> callback);
+    std::shared_ptr<CancellationToken> GetRtmpByProviderAsync(
+        const std::string provider, QObject *context,
+        OneSevenLiveApiCallback<OneSevenLiveRtmpResponse> callback);
+    std::shared_ptr<CancellationToken> CreateCustomEventAsync(
+        const OneSevenLiveCustomEvent &request, QObject *context,
+        OneSevenLiveApiCallback<OneSevenLiveCustomEvent> callback);
+    std::shared_ptr<CancellationToken> ChangeCustomEventStatusAsync(
+        const std::string &eventID, const OneSevenLiveCustomEventStatusRequest &request,
+        QObject *context, OneSevenLiveApiStatusCallback callback);
+    std::shared_ptr<CancellationToken> GetCustomEventAsync(
+        const std::string &userID, QObject *context,
+        OneSevenLiveApiCallback<OneSevenLiveCustomEvent> callback);
+    std::shared_ptr<CancellationToken> GetArmyNameAsync(
+        const std::string &userID, QObject *context,
+        OneSevenLiveApiCallback<OneSevenLiveArmyNameResponse> callback);
+    std::shared_ptr<CancellationToken> PokeOneAsync(
+        const OneSevenLivePokeRequest &request, QObject *context,
+        OneSevenLiveApiCallback<OneSevenLivePokeResponse> callback);
+    std::shared_ptr<CancellationToken> PokeAllAsync(
+        const OneSevenLivePokeAllRequest &request, QObject *context,
+        OneSevenLiveApiCallback<OneSevenLivePokeResponse> callback);
+    std::shared_ptr<CancellationToken> ChangeEventAsync(
+        const OneSevenLiveChangeEventRequest &request, QObject *context,
+        OneSevenLiveApiStatusCallback callback);
+
     /**
      * @brief Perform MD5 encryption on string
      * @param str String to be encrypted
@@ -103,18 +203,49 @@ class OneSevenLiveApiWrappers : public QObject {
      */
     static int64_t getCurrentTimestampMs();
 
+    /**
+     * @brief Write request coalescing counters to the OBS log
+     */
+    void logRequestStats() const;
+
     QString getLastErrorMessage() const {
         std::lock_guard<std::mutex> lock(stateMutex);
         return lastErrorMessage;
     }
 
+    /**
+     * @brief Get the error message of the last call made on the calling thread
+     * @return Unlike getLastErrorMessage(), not overwritten by calls on other threads
+     */
+    static QString threadLastErrorMessage();
+
+    /**
+     * @brief Get the HTTP status of the last call made on the calling thread
+     * @return 0 if the call got no response, e.g. after a transport error or a timeout
+     */
+    static long threadLastHttpStatus();
+
     /**
      * @brief Set authentication token
      * @param token_ The authentication token to set
      */
     void setToken(const std::string &token_) {
         std::lock_guard<std::mutex> lock(stateMutex);
+        if (token_ != token)
+            responseCache.clear();  // Cached answers may belong to another account
         token = token_;
+        expire_time = tokenExpiry(token);
+        publishRequestContext();
+    }
+
+    /**
+     * @brief Set the refresh token used to renew the access token before it expires
+     * @param refreshToken_ The refresh token returned by Login
+     */
+    void setRefreshToken(const std::string &refreshToken_) {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        refresh_token = refreshToken_;
+        publishRequestContext();
     }
 
     /**
@@ -122,10 +253,21 @@ class OneSevenLiveApiWrappers : public QObject {
      * @return Returns the current authentication token
      */
     std::string getToken() const {
-        std::lock_guard<std::mutex> lock(stateMutex);
-        return token;
+        return std::atomic_load(&requestContext)->token;
     }
 
+    /**
+     * @brief Read the expiry of a JWT access token
+     * @return Expiry in seconds since 1970-01-01 00:00:00 UTC, 0 if the token carries none
+     */
+    static uint64_t tokenExpiry(const std::string &jwt);
+
+   signals:
+    /**
+     * @brief Emitted from a worker thread after the access token was renewed
+     */
+    void tokenRefreshed(const QString &accessToken, const QString &refreshToken);
+
    protected:
     std::string refresh_token;
     std::string token;
@@ -143,7 +285,63 @@ class OneSevenLiveApiWrappers : public QObject {
     // Mutex for thread-safe access to shared state
     mutable std::mutex stateMutex;
 
+    // Immutable copy of the credentials and the headers every request carries. Replaced as a
+    // whole when the token changes, so requests read it without locking or building headers.
+    struct RequestContext {
+        std::string token;
+        uint64_t expireTime = 0;
+        bool renewable = false;  // A refresh token is set
+        std::shared_ptr<const HttpHeaderBlock> headers;  // Device headers and Authorization
+        std::shared_ptr<const HttpHeaderBlock> anonymousHeaders;  // Device headers only
+    };
+
+    // Read and replaced with std::atomic_load / std::atomic_store
+    std::shared_ptr<const RequestContext> requestContext;
+
+    // Rebuild requestContext from the members above, called with stateMutex held
+    void publishRequestContext();
+
+    // Outcome of one HTTP round trip, shared between coalesced callers
+    struct CommandResult {
+        bool success = false;
+        bool empty = true;
+        bool parsed = false;
+        bool canceled = false;  // Aborted through the caller's CancellationToken
+        bool transient = false;  // Failed in a way that may succeed when repeated
+        bool rejected = false;   // Failed fast by an open circuit breaker, nothing was sent
+        long httpStatusCode = 0;
+        uint64_t cacheGeneration = 0;  // responseCache.generation() before the request was sent
+        std::string error;
+        Json json;
+    };
+
+    SingleFlight<CommandResult> inflightCommands;
+
+    // Serializes token refreshes, so concurrent requests on an expired token share one
+    std::mutex refreshMutex;
+    std::atomic<bool> refreshPending{false};
+    std::atomic<int64_t> lastRefreshAttemptMs{0};
+
+    // Background refreshes reach the wrapper only through the guard, which the destructor clears
+    // after canceling them
+    struct RefreshGuard {
+        std::mutex mutex;
+        OneSevenLiveApiWrappers *api = nullptr;
+    };
+    std::shared_ptr<RefreshGuard> refreshGuard;
+    std::shared_ptr<CancellationToken> refreshCancel;
+
+    // Fresh answers of slowly changing endpoints, see registerCachePolicies()
+    ResponseCache responseCache;
+    void registerCachePolicies();
+
+    // Parsed bodies of cacheable responses, keyed like HttpValidatorCache entries
+    std::mutex parsedResponsesMutex;
+    std::map<std::string, Json> parsedResponses;
+
     // Thread-safe helper methods for error message management
     void setLastErrorMessage(const QString &message);
     void clearLastErrorMessage();
+    // errorCode and errorMessage of a failed call's response, if it has any
+    void setLastErrorFromResponse(const Json &response);
 };
@@ -0,0 +1,97 @@
+/******************************************************************************
+    Copyright (C) 2024 by 17Live
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "CancellationToken.hpp"
+
+#include <algorithm>
+
+namespace {
+    thread_local std::shared_ptr<CancellationToken> currentToken;
+}  // namespace
+
+std::shared_ptr<CancellationToken> CancellationToken::child(
+    std::shared_ptr<CancellationToken> parent, std::chrono::milliseconds timeout) {
+    auto token = std::make_shared<CancellationToken>();
+    token->parent = std::move(parent);
+    if (timeout.count() > 0) {
+        token->deadlineSet = true;
+        token->deadline = Clock::now() + timeout;
+    }
+    return token;
+}
+
+std::shared_ptr<CancellationToken> CancellationToken::linked(
+    std::shared_ptr<CancellationToken> parent, std::shared_ptr<CancellationToken> other) {
+    auto token = std::make_shared<CancellationToken>();
+    token->parent = std::move(parent);
+    token->other = std::move(other);
+    return token;
+}
+
+void CancellationToken::cancel() {
+    canceled.store(true, std::memory_order_release);
+}
+
+bool CancellationToken::isCanceled() const {
+    for (const CancellationToken *token = this; token; token = token->parent.get()) {
+        if (token->canceled.load(std::memory_order_acquire))
+            return true;
+        if (token->deadlineSet && Clock::now() >= token->deadline)
+            return true;
+        if (token->other && token->other->isCanceled())
+            return true;
+    }
+    return false;
+}
+
+bool CancellationToken::hasDeadline() const {
+    for (const CancellationToken *token = this; token; token = token->parent.get()) {
+        if (token->deadlineSet)
+            return true;
+        if (token->other && token->other->hasDeadline())
+            return true;
+    }
+    return false;
+}
+
+std::chrono::milliseconds CancellationToken::remaining() const {
+    Clock::time_point earliest = Clock::time_point::max();
+    for (const CancellationToken *token = this; token; token = token->parent.get()) {
+        if (token->deadlineSet)
+            earliest = std::min(earliest, token->deadline);
+        if (token->other && token->other->hasDeadline())
+            earliest = std::min(earliest, Clock::now() + token->other->remaining());
+    }
+
+    Clock::time_point now = Clock::now();
+    if (earliest <= now)
+        return std::chrono::milliseconds(0);
+    return std::chrono::duration_cast<std::chrono::milliseconds>(earliest - now);
+}
+
+std::shared_ptr<CancellationToken> CancellationToken::current() {
+    return currentToken;
+}
+
+CancellationScope::CancellationScope(std::shared_ptr<CancellationToken> token)
+    : previous(std::move(currentToken)) {
+    currentToken = std::move(token);
+}
+
+CancellationScope::~CancellationScope() {
+    currentToken = std::move(previous);
+}
@@ -0,0 +1,95 @@
+/******************************************************************************
+    Copyright (C) 2024 by 17Live
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+/**
+ * Cooperative cancellation for blocking HTTP calls.
+ *
+ * A token is canceled explicitly with cancel(), when its optional deadline passes, or when its
+ * parent is canceled. Blocking calls do not take a token argument: the caller installs one for
+ * the current thread with CancellationScope, and GetRemoteFile picks it up through current() and
+ * hands it to the HttpClient backend, which aborts the transfer once it is canceled.
+ */
+class CancellationToken {
+   public:
+    using Clock = std::chrono::steady_clock;
+
+    CancellationToken() = default;
+
+    /**
+     * Create a token canceled together with parent, and at the latest after timeout
+     * @param parent Token to follow, may be null
+     * @param timeout Deadline relative to now, zero for none
+     */
+    static std::shared_ptr<CancellationToken> child(std::shared_ptr<CancellationToken> parent,
+                                                    std::chrono::milliseconds timeout);
+
+    /**
+     * Create a token canceled together with either of two tokens
+     * @param parent Token to follow, may be null
+     * @param other Second token to follow, may be null
+     */
+    static std::shared_ptr<CancellationToken> linked(std::shared_ptr<CancellationToken> parent,
+                                                     std::shared_ptr<CancellationToken> other);
+
+    void cancel();
+    bool isCanceled() const;
+
+    /**
+     * @return true if a deadline is set on this token or one of its parents
+     */
+    bool hasDeadline() const;
+
+    /**
+     * Time left until the earliest deadline of this token and its parents
+     * @return Remaining time, zero once it passed; only meaningful if hasDeadline()
+     */
+    std::chrono::milliseconds remaining() const;
+
+    /**
+     * Token installed on the calling thread by the innermost CancellationScope, or null
+     */
+    static std::shared_ptr<CancellationToken> current();
+
+   private:
+    std::atomic<bool> canceled{false};
+    bool deadlineSet = false;
+    Clock::time_point deadline{};
+    std::shared_ptr<CancellationToken> parent;
+    std::shared_ptr<CancellationToken> other;  // Second parent of a linked() token
+};
+
+/**
+ * Installs a token as CancellationToken::current() for the lifetime of the scope, restoring the
+ * previous one on exit
+ */
+class CancellationScope {
+   public:
+    explicit CancellationScope(std::shared_ptr<CancellationToken> token);
+    ~CancellationScope();
+
+    CancellationScope(const CancellationScope &) = delete;
+    CancellationScope &operator=(const CancellationScope &) = delete;
+
+   private:
+    std::shared_ptr<CancellationToken> previous;
+};
@@ -0,0 +1,186 @@
+/******************************************************************************
+    Copyright (C) 2024 by 17Live
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "CircuitBreaker.hpp"
+
+#include <obs-module.h>
+
+#include "HttpMetrics.hpp"
+#include "plugin-support.h"
+
+static const char *state_name(CircuitState state) {
+    switch (state) {
+        case CircuitState::Closed:
+            return "closed";
+        case CircuitState::Open:
+            return "open";
+        case CircuitState::HalfOpen:
+            return "half-open";
+    }
+    return "unknown";
+}
+
+CircuitBreaker::CircuitBreaker(std::string name) : breakerName(std::move(name)) {}
+
+bool CircuitBreaker::allow() {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto now = std::chrono::steady_clock::now();
+
+    if (current == CircuitState::Closed)
+        return true;
+
+    if (current == CircuitState::Open) {
+        if (now - openedAt < std::chrono::seconds(CIRCUIT_OPEN_SEC)) {
+            rejected.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        transition(CircuitState::HalfOpen, "cool-down elapsed");
+    }
+
+    // Half-open: exactly one probe at a time
+    if (!probeInFlight || now - probeStartedAt > std::chrono::seconds(CIRCUIT_PROBE_EXPIRE_SEC)) {
+        probeInFlight = true;
+        probeStartedAt = now;
+        return true;
+    }
+
+    rejected.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void CircuitBreaker::abandon() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (current == CircuitState::HalfOpen)
+        probeInFlight = false;
+}
+
+void CircuitBreaker::recordSuccess() {
+    record(false, false);
+}
+
+void CircuitBreaker::recordFailure(bool timedOut) {
+    record(true, timedOut);
+}
+
+CircuitState CircuitBreaker::state() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return current;
+}
+
+void CircuitBreaker::record(bool failed, bool timedOut) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (current == CircuitState::HalfOpen) {
+        probeInFlight = false;
+        transition(failed ? CircuitState::Open : CircuitState::Closed,
+                   failed ? "probe failed" : "probe succeeded");
+        return;
+    }
+
+    // Late result of a call that started before the breaker opened
+    if (current == CircuitState::Open)
+        return;
+
+    outcomes[outcomeNext] = failed;
+    outcomeNext = (outcomeNext + 1) % CIRCUIT_WINDOW;
+    if (outcomeCount < CIRCUIT_WINDOW)
+        outcomeCount++;
+
+    if (timedOut)
+        consecutiveTimeouts++;
+    else if (!failed)
+        consecutiveTimeouts = 0;
+
+    int failures = 0;
+    for (int i = 0; i < outcomeCount; i++)
+        failures += outcomes[i] ? 1 : 0;
+
+    if (consecutiveTimeouts >= CIRCUIT_TIMEOUTS_TO_OPEN) {
+        transition(CircuitState::Open,
+                   (std::to_string(consecutiveTimeouts) + " consecutive timeouts").c_str());
+    } else if (outcomeCount >= CIRCUIT_MIN_CALLS &&
+               failures * 100 >= CIRCUIT_FAILURE_PERCENT * outcomeCount) {
+        transition(CircuitState::Open, (std::to_string(failures) + "/" +
+                                        std::to_string(outcomeCount) + " calls failed")
+                                           .c_str());
+    }
+}
+
+void CircuitBreaker::transition(CircuitState next, const char *reason) {
+    obs_log(next == CircuitState::Open ? LOG_WARNING : LOG_INFO,
+            "[Circuit Breaker] %s: %s -> %s (%s)", breakerName.c_str(), state_name(current),
+            state_name(next), reason);
+
+    current = next;
+    switch (next) {
+        case CircuitState::Open:
+            opened.fetch_add(1, std::memory_order_relaxed);
+            openedAt = std::chrono::steady_clock::now();
+            probeInFlight = false;
+            break;
+        case CircuitState::HalfOpen:
+            halfOpened.fetch_add(1, std::memory_order_relaxed);
+            break;
+        case CircuitState::Closed:
+            closed.fetch_add(1, std::memory_order_relaxed);
+            outcomeCount = 0;
+            outcomeNext = 0;
+            consecutiveTimeouts = 0;
+            break;
+    }
+}
+
+CircuitBreakerRegistry &CircuitBreakerRegistry::instance() {
+    static CircuitBreakerRegistry *registry = new CircuitBreakerRegistry();
+    return *registry;
+}
+
+CircuitBreaker &CircuitBreakerRegistry::forUrl(const std::string &url) {
+    size_t hostStart = url.find("://");
+    hostStart = hostStart == std::string::npos ? 0 : hostStart + 3;
+    size_t hostEnd = url.find_first_of(":/?#", hostStart);
+    std::string host = url.substr(
+        hostStart, hostEnd == std::string::npos ? std::string::npos : hostEnd - hostStart);
+
+    std::string endpoint = HttpMetrics::instance().endpointName(url);
+    std::string key = endpoint == host ? host : host + endpoint;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::unique_ptr<CircuitBreaker> &breaker = breakers[key];
+    if (!breaker)
+        breaker = std::make_unique<CircuitBreaker>(key);
+    return *breaker;
+}
+
+void CircuitBreakerRegistry::logStats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto &it : breakers) {
+        CircuitBreaker &breaker = *it.second;
+        uint64_t opened = breaker.opened.load(std::memory_order_relaxed);
+        uint64_t rejected = breaker.rejected.load(std::memory_order_relaxed);
+        if (!opened && !rejected)
+            continue;
+
+        obs_log(LOG_INFO,
+                "[Circuit Breaker] %s: %s, opened %llu, half-open %llu, closed %llu, rejected "
+                "%llu calls",
+                breaker.name().c_str(), state_name(breaker.state()), (unsigned long long) opened,
+                (unsigned long long) breaker.halfOpened.load(std::memory_order_relaxed),
+                (unsigned long long) breaker.closed.load(std::memory_order_relaxed),
+                (unsigned long long) rejected);
+    }
+}
@@ -0,0 +1,123 @@
+/******************************************************************************
+    Copyright (C) 2024 by 17Live
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#define CIRCUIT_WINDOW 20
+#define CIRCUIT_MIN_CALLS 5
+#define CIRCUIT_FAILURE_PERCENT 50
+#define CIRCUIT_TIMEOUTS_TO_OPEN 2
+#define CIRCUIT_OPEN_SEC 15
+// A half-open probe that never reports back frees its slot after this long
+#define CIRCUIT_PROBE_EXPIRE_SEC 120
+
+enum class CircuitState { Closed, Open, HalfOpen };
+
+/**
+ * Circuit breaker for one host + endpoint.
+ *
+ * Closed: calls pass, and the outcomes of the last CIRCUIT_WINDOW calls are tracked. The breaker
+ * opens when at least CIRCUIT_FAILURE_PERCENT of them failed (after CIRCUIT_MIN_CALLS calls) or
+ * after CIRCUIT_TIMEOUTS_TO_OPEN consecutive timeouts.
+ * Open: calls are rejected immediately for CIRCUIT_OPEN_SEC.
+ * Half-open: a single probe call is let through; its outcome closes or re-opens the breaker.
+ */
+class CircuitBreaker {
+   public:
+    explicit CircuitBreaker(std::string name);
+
+    /**
+     * Ask for permission to make a call
+     * @return false if the call must fail fast; otherwise report the outcome with
+     *         recordSuccess() or recordFailure(), or call abandon() if there is none
+     */
+    bool allow();
+
+    /**
+     * Give up an allowed call without an outcome, e.g. because it was canceled. If it was the
+     * half-open probe, the next call may probe instead of waiting out CIRCUIT_PROBE_EXPIRE_SEC.
+     */
+    void abandon();
+
+    void recordSuccess();
+
+    /**
+     * @param timedOut The call ran into its timeout, which opens the breaker sooner
+     */
+    void recordFailure(bool timedOut);
+
+    CircuitState state();
+    const std::string &name() const { return breakerName; }
+
+    std::atomic<uint64_t> opened{0};
+    std::atomic<uint64_t> halfOpened{0};
+    std::atomic<uint64_t> closed{0};
+    std::atomic<uint64_t> rejected{0};
+
+   private:
+    void transition(CircuitState next, const char *reason);
+    void record(bool failed, bool timedOut);
+
+    std::string breakerName;
+    std::mutex mutex;
+    CircuitState current = CircuitState::Closed;
+
+    bool outcomes[CIRCUIT_WINDOW] = {};  // true = failed
+    int outcomeCount = 0;
+    int outcomeNext = 0;
+    int consecutiveTimeouts = 0;
+
+    std::chrono::steady_clock::time_point openedAt{};
+    bool probeInFlight = false;
+    std::chrono::steady_clock::time_point probeStartedAt{};
+};
+
+/**
+ * Process-wide set of circuit breakers, one per host and logical endpoint (see
+ * HttpMetrics::endpointName)
+ */
+class CircuitBreakerRegistry {
+   public:
+    static CircuitBreakerRegistry &instance();
+
+    /**
+     * Get the breaker guarding a URL (created on first use)
+     */
+    CircuitBreaker &forUrl(const std::string &url);
+
+    /**
+     * Write state and transition counts of every breaker that ever tripped to the OBS log
+     */
+    void logStats();
+
+    CircuitBreakerRegistry(const CircuitBreakerRegistry &) = delete;
+    CircuitBreakerRegistry &operator=(const CircuitBreakerRegistry &) = delete;
+
+   private:
+    CircuitBreakerRegistry() = default;
+
+    std::mutex mutex;
+    std::map<std::string, std::unique_ptr<CircuitBreaker>> breakers;
+};
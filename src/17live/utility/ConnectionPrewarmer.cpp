@@ -0,0 +1,164 @@
+/******************************************************************************
+    Copyright (C) 2024 by 17Live
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "ConnectionPrewarmer.hpp"
+
+#include <obs-module.h>
+
+#include <future>
+#include <memory>
+#include <thread>
+
+#include "DnsPrefetcher.hpp"
+#include "HttpConnectionPool.hpp"
+#include "HttpEngine.hpp"
+#include "HttpMetrics.hpp"
+#include "NetworkDiagnostics.hpp"
+#include "curl-helper.h"
+#include "plugin-support.h"
+
+#define PREWARM_TIMEOUT_SEC 10
+
+namespace {
+    void log_warm(const char *reason, const std::string &origin, CURLcode code, long connects,
+                  double handshakeMs, double totalMs) {
+        if (code != CURLE_OK) {
+            obs_log(LOG_WARNING, "[Prewarm] (%s) %s: failed: %s", reason, origin.c_str(),
+                    curl_easy_strerror(code));
+        } else if (connects > 0) {
+            obs_log(LOG_INFO,
+                    "[Prewarm] (%s) %s: cold connection opened, handshake %.1f ms, total %.1f ms "
+                    "(saved on the next request)",
+                    reason, origin.c_str(), handshakeMs, totalMs);
+        } else {
+            obs_log(LOG_INFO, "[Prewarm] (%s) %s: already warm, total %.1f ms", reason,
+                    origin.c_str(), totalMs);
+        }
+    }
+
+    // Warm-up on the connection pool, for when GetRemoteFile bypasses HttpEngine
+    void warm_pooled(const char *reason, const std::string &origin) {
+        CURL *curl = HttpConnectionPool::instance().acquire();
+        if (!curl)
+            return;
+
+        std::string versionString("User-Agent: obs-basic ");
+        versionString += obs_get_version_string();
+        struct curl_slist *header = curl_slist_append(nullptr, versionString.c_str());
+
+        curl_easy_setopt(curl, CURLOPT_URL, origin.c_str());
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, header);
+        curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
+        curl_easy_setopt(curl, CURLOPT_TIMEOUT, (long) PREWARM_TIMEOUT_SEC);
+        curl_obs_set_revoke_setting(curl);
+
+        CURLcode code = curl_easy_perform(curl);
+        HttpMetrics::instance().record(curl, origin, code);
+        if (code == CURLE_OK)
+            HttpConnectionPool::instance().recordTransfer(curl);
+
+        long connects = 0;
+        curl_off_t connect = 0, appConnect = 0, total = 0;
+        curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &connects);
+        curl_easy_getinfo(curl, CURLINFO_CONNECT_TIME_T, &connect);
+        curl_easy_getinfo(curl, CURLINFO_APPCONNECT_TIME_T, &appConnect);
+        curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME_T, &total);
+        curl_slist_free_all(header);
+
+        log_warm(reason, origin, code, connects, (appConnect > 0 ? appConnect : connect) / 1000.0,
+                 total / 1000.0);
+    }
+}  // namespace
+
+ConnectionPrewarmer &ConnectionPrewarmer::instance() {
+    static ConnectionPrewarmer *prewarmer = new ConnectionPrewarmer();
+    return *prewarmer;
+}
+
+void ConnectionPrewarmer::addOrigin(const std::string &url) {
+    size_t schemeEnd = url.find("://");
+    if (schemeEnd == std::string::npos)
+        return;
+
+    size_t pathStart = url.find('/', schemeEnd + 3);
+    std::string origin = url.substr(0, pathStart) + "/";
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const std::string &existing : origins) {
+        if (existing == origin)
+            return;
+    }
+    origins.push_back(origin);
+}
+
+void ConnectionPrewarmer::warm(const char *reason) {
+    if (warming.exchange(true))
+        return;
+
+    std::vector<std::string> targets;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        targets = origins;
+    }
+
+    std::thread([this, reason, targets]() {
+        if (HttpEngine::instance().isHttp2Enabled()) {
+            // All origins at once; each HEAD leaves its connection in the engine's cache
+            std::vector<std::future<HttpResponse>> results;
+            for (const std::string &origin : targets) {
+                auto promise = std::make_shared<std::promise<HttpResponse>>();
+                results.push_back(promise->get_future());
+
+                HttpRequest request;
+                request.url = origin;
+                request.method = "HEAD";
+                request.timeoutSec = PREWARM_TIMEOUT_SEC;
+                request.failOnError = false;
+                HttpEngine::instance().submit(std::move(request),
+                                              [promise](HttpResponse &&response) {
+                                                  promise->set_value(std::move(response));
+                                              });
+            }
+
+            for (size_t i = 0; i < targets.size(); i++) {
+                HttpResponse response = results[i].get();
+                log_warm(reason, targets[i], response.code, response.newConnections,
+                         response.handshakeMs, response.totalMs);
+            }
+        } else {
+            for (const std::string &origin : targets)
+                warm_pooled(reason, origin);
+        }
+
+        warming = false;
+    }).detach();
+}
+
+void ConnectionPrewarmer::probeIngest(const std::string &rtmpUrl) {
+    std::string host;
+    int port = 0;
+    if (!DnsPrefetcher::parseHostPort(rtmpUrl, host, port))
+        return;
+
+    std::thread([host, port]() {
+        NetworkDiagnosticResult result =
+            NetworkDiagnostics::testTcpConnection(host, port, PREWARM_TIMEOUT_SEC);
+        if (!result.tcp_connection_success)
+            obs_log(LOG_WARNING, "[Prewarm] Ingest %s:%d unreachable: %s", host.c_str(), port,
+                    result.error_message.c_str());
+    }).detach();
+}
@@ -0,0 +1,63 @@
+/******************************************************************************
+    Copyright (C) 2024 by 17Live
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * Opens and TLS-handshakes connections ahead of the latency-critical requests (login, room info,
+ * go-live), so they start on warm sockets.
+ *
+ * Each origin gets a HEAD request on the transport GetRemoteFile uses (HttpEngine with HTTP/2,
+ * otherwise the connection pool), which leaves an idle connection in that transport's cache.
+ * The cold connection cost measured by the warm-up is logged per origin; HttpMetrics reports
+ * how later requests fared on cold versus warm connections.
+ */
+class ConnectionPrewarmer {
+   public:
+    static ConnectionPrewarmer &instance();
+
+    /**
+     * Add an origin (scheme://host[:port]) to keep warm; any path is ignored
+     */
+    void addOrigin(const std::string &url);
+
+    /**
+     * Warm all origins in the background; ignored while a previous warm-up is still running
+     * @param reason Shown in the log, e.g. "startup"
+     */
+    void warm(const char *reason);
+
+    /**
+     * Check TCP reachability and connect time of an RTMP ingest server in the background
+     */
+    void probeIngest(const std::string &rtmpUrl);
+
+    ConnectionPrewarmer(const ConnectionPrewarmer &) = delete;
+    ConnectionPrewarmer &operator=(const ConnectionPrewarmer &) = delete;
+
+   private:
+    ConnectionPrewarmer() = default;
+
+    std::mutex mutex;
+    std::vector<std::string> origins;
+    std::atomic<bool> warming{false};
+};
@@ -0,0 +1,260 @@
+/******************************************************************************
+    Copyright (C) 2024 by 17Live
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "DnsPrefetcher.hpp"
+
+#include <obs-module.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#endif
+
+#include "plugin-support.h"
+
+// getaddrinfo does not report record TTLs, so refresh well inside the common 300 s TTL
+#define DNS_PREFETCH_REFRESH_SEC 240
+#define DNS_PREFETCH_RETRY_SEC 30
+
+DnsPrefetcher &DnsPrefetcher::instance() {
+    static DnsPrefetcher *prefetcher = new DnsPrefetcher();
+    return *prefetcher;
+}
+
+void DnsPrefetcher::start() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (running)
+        return;
+
+    running = true;
+    worker = std::thread(&DnsPrefetcher::run, this);
+}
+
+void DnsPrefetcher::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!running)
+            return;
+        running = false;
+    }
+    wake.notify_all();
+    if (worker.joinable())
+        worker.join();
+}
+
+void DnsPrefetcher::addHost(const std::string &host, int port) {
+    if (host.empty() || port <= 0)
+        return;
+
+    // Literal addresses never need resolving
+    unsigned char buffer[sizeof(struct in6_addr)];
+    if (inet_pton(AF_INET, host.c_str(), buffer) == 1 ||
+        inet_pton(AF_INET6, host.c_str(), buffer) == 1)
+        return;
+
+    std::string key = host + ":" + std::to_string(port);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (hosts.count(key))
+            return;
+
+        HostEntry &entry = hosts[key];
+        entry.host = host;
+        entry.port = port;
+    }
+    wake.notify_all();
+}
+
+void DnsPrefetcher::addUrl(const std::string &url) {
+    std::string host;
+    int port = 0;
+    if (parseHostPort(url, host, port))
+        addHost(host, port);
+}
+
+bool DnsPrefetcher::parseHostPort(const std::string &url, std::string &host, int &port) {
+    size_t schemeEnd = url.find("://");
+    if (schemeEnd == std::string::npos)
+        return false;
+
+    std::string scheme = url.substr(0, schemeEnd);
+    if (scheme == "https" || scheme == "rtmps")
+        port = 443;
+    else if (scheme == "http")
+        port = 80;
+    else if (scheme == "rtmp")
+        port = 1935;
+    else
+        return false;
+
+    size_t hostStart = schemeEnd + 3;
+    size_t hostEnd = url.find_first_of(":/?#", hostStart);
+    host = url.substr(hostStart,
+                      hostEnd == std::string::npos ? std::string::npos : hostEnd - hostStart);
+
+    if (hostEnd != std::string::npos && url[hostEnd] == ':') {
+        int explicitPort = atoi(url.c_str() + hostEnd + 1);
+        if (explicitPort > 0)
+            port = explicitPort;
+    }
+
+    return !host.empty();
+}
+
+void DnsPrefetcher::refresh() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto &it : hosts)
+            it.second.nextRefresh = {};
+    }
+    wake.notify_all();
+}
+
+std::shared_ptr<const DnsSnapshot> DnsPrefetcher::apply(CURL *curl) const {
+    std::shared_ptr<const DnsSnapshot> current;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        current = snapshot;
+    }
+
+    if (current && current->entries)
+        curl_easy_setopt(curl, CURLOPT_RESOLVE, current->entries);
+    return current;
+}
+
+void DnsPrefetcher::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (running) {
+        auto now = std::chrono::steady_clock::now();
+        auto next = now + std::chrono::seconds(DNS_PREFETCH_REFRESH_SEC);
+
+        std::vector<std::string> due;
+        for (const auto &it : hosts) {
+            if (it.second.nextRefresh <= now)
+                due.push_back(it.first);
+            else if (it.second.nextRefresh < next)
+                next = it.second.nextRefresh;
+        }
+
+        if (due.empty()) {
+            wake.wait_until(lock, next);
+            continue;
+        }
+
+        bool changed = false;
+        for (const std::string &key : due) {
+            std::string host = hosts[key].host;
+
+            // Resolve without the lock so apply() never waits on the network
+            lock.unlock();
+            auto start = std::chrono::steady_clock::now();
+            std::vector<std::string> addresses;
+            bool ok = resolve(host, addresses);
+            double elapsedMs = std::chrono::duration<double, std::milli>(
+                                   std::chrono::steady_clock::now() - start)
+                                   .count();
+            lock.lock();
+
+            HostEntry &entry = hosts[key];
+            if (!ok) {
+                entry.nextRefresh = std::chrono::steady_clock::now() +
+                                    std::chrono::seconds(DNS_PREFETCH_RETRY_SEC);
+                obs_log(LOG_WARNING,
+                        "[DNS Prefetch] Failed to resolve %s (%.1fms), keeping %d cached "
+                        "addresses",
+                        key.c_str(), elapsedMs, (int) entry.addresses.size());
+                continue;
+            }
+
+            entry.nextRefresh = std::chrono::steady_clock::now() +
+                                std::chrono::seconds(DNS_PREFETCH_REFRESH_SEC);
+            if (entry.addresses != addresses) {
+                std::string list;
+                for (const std::string &address : addresses)
+                    list += (list.empty() ? "" : ", ") + address;
+                obs_log(LOG_INFO, "[DNS Prefetch] %s -> %s (%.1fms)", key.c_str(), list.c_str(),
+                        elapsedMs);
+
+                entry.addresses = std::move(addresses);
+                changed = true;
+            }
+        }
+
+        if (changed)
+            publish();
+    }
+}
+
+void DnsPrefetcher::publish() {
+    auto next = std::make_shared<DnsSnapshot>();
+
+    for (const auto &it : hosts) {
+        const HostEntry &entry = it.second;
+        if (entry.addresses.empty())
+            continue;
+
+        std::string line = it.first + ":";
+        for (size_t i = 0; i < entry.addresses.size(); ++i) {
+            if (i > 0)
+                line += ",";
+            const std::string &address = entry.addresses[i];
+            line += address.find(':') != std::string::npos ? "[" + address + "]" : address;
+        }
+        next->entries = curl_slist_append(next->entries, line.c_str());
+    }
+
+    snapshot = std::move(next);
+}
+
+bool DnsPrefetcher::resolve(const std::string &host, std::vector<std::string> &addresses) {
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    struct addrinfo *res = nullptr;
+    if (getaddrinfo(host.c_str(), nullptr, &hints, &res) != 0)
+        return false;
+
+    for (struct addrinfo *p = res; p != nullptr; p = p->ai_next) {
+        char address[INET6_ADDRSTRLEN];
+        void *addr;
+
+        if (p->ai_family == AF_INET)
+            addr = &((struct sockaddr_in *) p->ai_addr)->sin_addr;
+        else if (p->ai_family == AF_INET6)
+            addr = &((struct sockaddr_in6 *) p->ai_addr)->sin6_addr;
+        else
+            continue;
+
+        if (inet_ntop(p->ai_family, addr, address, sizeof(address)) &&
+            std::find(addresses.begin(), addresses.end(), address) == addresses.end())
+            addresses.push_back(address);
+    }
+
+    freeaddrinfo(res);
+    return !addresses.empty();
+}
@@ -0,0 +1,114 @@
+/******************************************************************************
+    Copyright (C) 2024 by 17Live
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#pragma once
+
+#include <curl/curl.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Immutable set of pre-resolved addresses in CURLOPT_RESOLVE format ("host:port:addr,...")
+ */
+struct DnsSnapshot {
+    struct curl_slist *entries = nullptr;
+
+    DnsSnapshot() = default;
+    DnsSnapshot(const DnsSnapshot &) = delete;
+    DnsSnapshot &operator=(const DnsSnapshot &) = delete;
+    ~DnsSnapshot() { curl_slist_free_all(entries); }
+};
+
+/**
+ * Background resolver for the hosts the plugin talks to (API, CDN, ingest).
+ *
+ * Hosts are resolved on a worker thread and refreshed before their TTL runs out. Every curl
+ * handle gets the latest addresses through CURLOPT_RESOLVE, so requests find the name in the DNS
+ * cache instead of blocking on getaddrinfo. If a refresh fails, the last good addresses are kept
+ * and the host is retried sooner.
+ */
+class DnsPrefetcher {
+   public:
+    static DnsPrefetcher &instance();
+
+    /**
+     * Start the resolver thread (no-op if it is already running)
+     */
+    void start();
+
+    /**
+     * Stop the resolver thread; addresses resolved so far stay in use
+     */
+    void stop();
+
+    /**
+     * Resolve and keep refreshing a host
+     */
+    void addHost(const std::string &host, int port);
+
+    /**
+     * Resolve and keep refreshing the host of a URL (http, https, rtmp or rtmps)
+     */
+    void addUrl(const std::string &url);
+
+    /**
+     * Split an http, https, rtmp or rtmps URL into host and port (scheme default if absent)
+     */
+    static bool parseHostPort(const std::string &url, std::string &host, int &port);
+
+    /**
+     * Re-resolve every host now, e.g. after the network changed
+     */
+    void refresh();
+
+    /**
+     * Seed the handle's DNS cache with the current snapshot
+     * @return The snapshot, which the caller must keep alive until the transfer has finished
+     */
+    std::shared_ptr<const DnsSnapshot> apply(CURL *curl) const;
+
+    DnsPrefetcher(const DnsPrefetcher &) = delete;
+    DnsPrefetcher &operator=(const DnsPrefetcher &) = delete;
+
+   private:
+    DnsPrefetcher() = default;
+
+    struct HostEntry {
+        std::string host;
+        int port = 0;
+        std::vector<std::string> addresses;
+        std::chrono::steady_clock::time_point nextRefresh{};
+    };
+
+    void run();
+    void publish();
+    static bool resolve(const std::string &host, std::vector<std::string> &addresses);
+
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::map<std::string, HostEntry> hosts;  // keyed by "host:port"
+    std::shared_ptr<const DnsSnapshot> snapshot;
+    std::thread worker;
+    bool running = false;
+};
@@ -2,56 +2,645 @@
 
 #include <obs-module.h>
 
+#include <QByteArrayView>
+#include <QCryptographicHash>
 #include <QDesktopServices>
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
 #include <QStandardPaths>
 #include <QUrl>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+#include <vector>
 
-#include "RemoteTextThread.hpp"
+#include "CancellationToken.hpp"
+#include "HttpClient.hpp"
+#include "HttpConnectionPool.hpp"
+#include "HttpMetrics.hpp"
+#include "TransferShaper.hpp"
+#include "curl-helper.h"
 #include "moc_DownloadWorker.cpp"
 #include "plugin-support.h"
 
-DownloadWorker::DownloadWorker(const QString& url, const QString& filePath)
-    : downloadUrl(url), filePath(filePath), canceled(false) {}
+#define DOWNLOAD_MAX_ATTEMPTS 3
+#define DOWNLOAD_PROGRESS_INTERVAL_MS 200
+#define DOWNLOAD_SEGMENTS 4
+#define DOWNLOAD_SEGMENT_MIN_SIZE (4 * 1024 * 1024)
+#define DOWNLOAD_PLAN_SAVE_INTERVAL_MS 2000
+#define DOWNLOAD_CONNECT_TIMEOUT_SEC 30
+#define DOWNLOAD_STALL_TIMEOUT_SEC 60
+
+namespace {
+    // Shared between the transfer callbacks of one attempt
+    struct DownloadState {
+        DownloadWorker* worker;
+        QFile& file;
+        QCryptographicHash& hash;
+        qint64 offset;  // bytes already on disk when the attempt started
+        bool writeFailed = false;
+        std::chrono::steady_clock::time_point lastProgress{};
+    };
+
+    bool download_write(const char* data, size_t size, DownloadState& state) {
+        if (state.file.write(data, static_cast<qint64>(size)) != static_cast<qint64>(size)) {
+            state.writeFailed = true;
+            return false;
+        }
+        state.hash.addData(QByteArrayView(data, static_cast<qsizetype>(size)));
+        return true;
+    }
+
+    // received and total already include the bytes that were on disk
+    bool download_progress(DownloadState& state, int64_t received, int64_t total) {
+        if (state.worker->isCanceled())
+            return false;
+
+        auto now = std::chrono::steady_clock::now();
+        if (now - state.lastProgress < std::chrono::milliseconds(DOWNLOAD_PROGRESS_INTERVAL_MS))
+            return true;
+        state.lastProgress = now;
+
+        emit state.worker->progress(static_cast<qint64>(received), static_cast<qint64>(total));
+        return true;
+    }
+
+    bool is_transient(CURLcode code) {
+        switch (code) {
+            case CURLE_COULDNT_RESOLVE_HOST:
+            case CURLE_COULDNT_CONNECT:
+            case CURLE_PARTIAL_FILE:
+            case CURLE_OPERATION_TIMEDOUT:
+            case CURLE_GOT_NOTHING:
+            case CURLE_SEND_ERROR:
+            case CURLE_RECV_ERROR:
+            case CURLE_HTTP2_STREAM:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    QString normalized_digest(const QString& digest) {
+        QString hex = digest.trimmed().toLower();
+        if (hex.startsWith("sha256:"))
+            hex = hex.mid(7);
+        return hex;
+    }
+
+    enum class DownloadOutcome { Completed, Canceled, Failed, RangesUnsupported };
+
+    void set_transfer_options(CURL* curl, const std::string& url, struct curl_slist* header,
+                              char* errorBuffer) {
+        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, header);
+        curl_easy_setopt(curl, CURLOPT_ERRORBUFFER, errorBuffer);
+        curl_easy_setopt(curl, CURLOPT_FAILONERROR, 1L);
+        curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+        curl_easy_setopt(curl, CURLOPT_MAXREDIRS, 10L);
+        curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, (long) DOWNLOAD_CONNECT_TIMEOUT_SEC);
+        // No overall timeout for large assets; give up only when the transfer stalls
+        curl_easy_setopt(curl, CURLOPT_LOW_SPEED_LIMIT, 1L);
+        curl_easy_setopt(curl, CURLOPT_LOW_SPEED_TIME, (long) DOWNLOAD_STALL_TIMEOUT_SEC);
+        curl_obs_set_revoke_setting(curl);
+    }
+
+    // Single stream on the selected HttpClient backend, resuming after what is on disk
+    DownloadOutcome stream_download(DownloadWorker& worker, const std::string& url, QFile& part,
+                                    QCryptographicHash& hash, std::string& error) {
+        for (int attempt = 1; attempt <= DOWNLOAD_MAX_ATTEMPTS; ++attempt) {
+            DownloadState state{&worker, part, hash, part.size()};
+
+            HttpRequest request;
+            request.url = url;
+            request.followRedirects = true;
+            request.connectTimeoutSec = DOWNLOAD_CONNECT_TIMEOUT_SEC;
+            // No overall timeout for large assets; give up only when the transfer stalls
+            request.stallTimeoutSec = DOWNLOAD_STALL_TIMEOUT_SEC;
+            request.resumeFrom = state.offset;
+            request.transferClass = TransferClass::Background;
+            request.cancel = worker.cancellationToken();
+            request.onData = [&state](const char* data, size_t size) {
+                return download_write(data, size, state);
+            };
+            request.onProgress = [&state](int64_t received, int64_t total) {
+                return download_progress(state, received, total);
+            };
+
+            HttpResponse response = HttpClient::instance().perform(request);
+            CURLcode code = response.code;
+            long status = response.status;
+            part.flush();
+
+            if (code == CURLE_OK)
+                return DownloadOutcome::Completed;
+
+            error = response.error;
+
+            if (code == CURLE_ABORTED_BY_CALLBACK && worker.isCanceled())
+                return DownloadOutcome::Canceled;
+
+            if (state.writeFailed) {
+                error = "Cannot write file";
+                return DownloadOutcome::Failed;
+            }
+
+            if (state.offset > 0 && (status == 416 || code == CURLE_RANGE_ERROR)) {
+                // Server cannot resume, or the partial file does not fit the remote one (changed
+                // or already complete), so start over
+                obs_log(LOG_WARNING, "[Download] Cannot resume (%s), discarding partial file",
+                        error.c_str());
+                part.resize(0);
+                part.seek(0);
+                hash.reset();
+                continue;
+            }
+
+            if (!is_transient(code) || attempt == DOWNLOAD_MAX_ATTEMPTS)
+                return DownloadOutcome::Failed;
+
+            obs_log(LOG_WARNING, "[Download] Attempt %d failed (%s), resuming from %lld bytes",
+                    attempt, error.c_str(), (long long) part.size());
+        }
+
+        return DownloadOutcome::Failed;
+    }
+
+    std::string to_lower(std::string value) {
+        std::transform(value.begin(), value.end(), value.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return value;
+    }
+
+    // Result of a one-byte range request. HEAD and Accept-Ranges are not used because signed
+    // CDN redirects often reject HEAD, and only a 206 proves that ranges are honoured.
+    struct RangeProbe {
+        bool ok = false;
+        bool ranges = false;
+        qint64 length = -1;
+    };
+
+    size_t probe_header(char* ptr, size_t size, size_t nmemb, RangeProbe& probe) {
+        size_t total = size * nmemb;
+        std::string line(ptr, total);
+
+        // Headers of every redirect hop arrive here, only the last response counts
+        if (line.compare(0, 5, "HTTP/") == 0) {
+            probe.ranges = false;
+            probe.length = -1;
+        } else if (line.size() > 14 && to_lower(line.substr(0, 14)) == "content-range:") {
+            long long first = 0, last = 0, length = 0;
+            if (sscanf(line.c_str() + 14, " bytes %lld-%lld/%lld", &first, &last, &length) == 3) {
+                probe.ranges = true;
+                probe.length = length;
+            }
+        }
+        return total;
+    }
+
+    size_t probe_write(char* ptr, size_t size, size_t nmemb, void* userdata) {
+        (void) ptr;
+        (void) userdata;
+        return size * nmemb > 1 ? 0 : size * nmemb;  // a full 200 body is not wanted
+    }
+
+    RangeProbe probe_ranges(const std::string& url, struct curl_slist* header) {
+        RangeProbe probe;
+        CURL* curl = HttpConnectionPool::instance().acquire();
+        if (!curl)
+            return probe;
+
+        char errorBuffer[CURL_ERROR_SIZE];
+        errorBuffer[0] = 0;
+
+        set_transfer_options(curl, url, header, errorBuffer);
+        curl_easy_setopt(curl, CURLOPT_RANGE, "0-0");
+        curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, probe_header);
+        curl_easy_setopt(curl, CURLOPT_HEADERDATA, &probe);
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, probe_write);
+        curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
+
+        CURLcode code = curl_easy_perform(curl);
+        long status = 0;
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+
+        // A server without range support sends the whole body, which the write callback stops
+        probe.ok = code == CURLE_OK || code == CURLE_WRITE_ERROR;
+        probe.ranges = probe.ok && status == 206 && probe.ranges && probe.length > 0;
+        if (!probe.ok)
+            obs_log(LOG_WARNING, "[Download] Range probe failed: %s",
+                    strlen(errorBuffer) ? errorBuffer : curl_easy_strerror(code));
+        return probe;
+    }
+
+    struct Segment {
+        qint64 start = 0;
+        qint64 end = 0;  // inclusive
+        qint64 written = 0;
+        int attempts = 0;
+        CURL* easy = nullptr;
+        QFile* file = nullptr;
+        bool statusChecked = false;
+        bool rejected = false;  // server ignored the range
+        bool writeFailed = false;
+        char error[CURL_ERROR_SIZE];
+
+        qint64 size() const { return end - start + 1; }
+        bool complete() const { return written == size(); }
+    };
+
+    /**
+     * Byte ranges of a segmented download. It is kept next to the .part file as
+     * "<part>.segments" so an interrupted download resumes every range where it stopped.
+     */
+    struct SegmentPlan {
+        qint64 length = 0;
+        std::vector<Segment> segments;
+    };
+
+    SegmentPlan make_plan(qint64 length, int count) {
+        SegmentPlan plan;
+        plan.length = length;
+        plan.segments.resize(count);
+
+        qint64 chunk = length / count;
+        for (int i = 0; i < count; ++i) {
+            plan.segments[i].start = i * chunk;
+            plan.segments[i].end = i == count - 1 ? length - 1 : (i + 1) * chunk - 1;
+        }
+        return plan;
+    }
+
+    bool load_plan(const std::filesystem::path& path, SegmentPlan& plan) {
+        std::ifstream in(path, std::ios::in);
+        if (!in)
+            return false;
+
+        size_t count = 0;
+        if (!(in >> plan.length >> count) || plan.length <= 0 || count == 0 ||
+            count > DOWNLOAD_SEGMENTS * 4)
+            return false;
+
+        plan.segments.resize(count);
+        for (Segment& segment : plan.segments) {
+            if (!(in >> segment.start >> segment.end >> segment.written) ||
+                segment.start > segment.end || segment.end >= plan.length ||
+                segment.written < 0 || segment.written > segment.size())
+                return false;
+        }
+        return true;
+    }
+
+    void save_plan(const std::filesystem::path& path, const SegmentPlan& plan) {
+        std::filesystem::path tmp = path;
+        tmp += ".tmp";
+        {
+            std::ofstream out(tmp, std::ios::out | std::ios::trunc);
+            out << plan.length << " " << plan.segments.size() << "\n";
+            for (const Segment& segment : plan.segments)
+                out << segment.start << " " << segment.end << " " << segment.written << "\n";
+            if (!out)
+                return;
+        }
+        std::error_code ec;
+        std::filesystem::rename(tmp, path, ec);
+    }
+
+    size_t segment_write(char* ptr, size_t size, size_t nmemb, Segment& segment) {
+        size_t total = size * nmemb;
+
+        if (!segment.statusChecked) {
+            segment.statusChecked = true;
+            long status = 0;
+            curl_easy_getinfo(segment.easy, CURLINFO_RESPONSE_CODE, &status);
+            if (status != 206) {
+                segment.rejected = true;
+                return 0;
+            }
+        }
+
+        if (segment.written + static_cast<qint64>(total) > segment.size()) {
+            segment.rejected = true;
+            return 0;
+        }
+
+        if (!segment.file->seek(segment.start + segment.written) ||
+            segment.file->write(ptr, static_cast<qint64>(total)) != static_cast<qint64>(total)) {
+            segment.writeFailed = true;
+            return 0;
+        }
+        segment.written += static_cast<qint64>(total);
+        return total;
+    }
+
+    void start_segment(CURLM* multi, Segment& segment, const std::string& url,
+                       struct curl_slist* header, int segments) {
+        if (!segment.easy) {
+            segment.easy = HttpConnectionPool::instance().createHandle();
+            if (!segment.easy)
+                return;
+            set_transfer_options(segment.easy, url, header, segment.error);
+            curl_easy_setopt(segment.easy, CURLOPT_WRITEFUNCTION, segment_write);
+            curl_easy_setopt(segment.easy, CURLOPT_WRITEDATA, &segment);
+            curl_easy_setopt(segment.easy, CURLOPT_PRIVATE, &segment);
+        }
+
+        std::string range = std::to_string(segment.start + segment.written) + "-" +
+                            std::to_string(segment.end);
+        segment.error[0] = 0;
+        segment.statusChecked = false;
+        curl_easy_setopt(segment.easy, CURLOPT_RANGE, range.c_str());
+        // The ranges share the background cap while OBS is streaming
+        TransferShaper::instance().apply(segment.easy, TransferClass::Background, segments);
+        curl_multi_add_handle(multi, segment.easy);
+    }
+
+    DownloadOutcome segmented_download(DownloadWorker& worker, const std::string& url,
+                                       struct curl_slist* header, QFile& part, SegmentPlan& plan,
+                                       const std::filesystem::path& planPath,
+                                       std::string& error) {
+        CURLM* multi = curl_multi_init();
+        if (!multi) {
+            error = "Failed to initialize curl";
+            return DownloadOutcome::Failed;
+        }
+
+        int segments = static_cast<int>(plan.segments.size());
+        size_t active = 0;
+        for (Segment& segment : plan.segments) {
+            segment.file = &part;
+            if (segment.complete())
+                continue;
+            start_segment(multi, segment, url, header, segments);
+            if (!segment.easy) {
+                error = "Failed to initialize curl";
+                break;
+            }
+            ++active;
+        }
+
+        DownloadOutcome outcome = DownloadOutcome::Completed;
+        auto lastProgress = std::chrono::steady_clock::time_point{};
+        auto lastSave = std::chrono::steady_clock::now();
+
+        while (error.empty() && active > 0) {
+            int running = 0;
+            curl_multi_perform(multi, &running);
+
+            CURLMsg* msg;
+            int queued = 0;
+            while ((msg = curl_multi_info_read(multi, &queued))) {
+                if (msg->msg != CURLMSG_DONE)
+                    continue;
+
+                Segment* segment = nullptr;
+                curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char**) &segment);
+                CURLcode code = msg->data.result;
+                curl_multi_remove_handle(multi, segment->easy);
+                HttpMetrics::instance().record(segment->easy, url.c_str(), code);
+
+                curl_off_t down = 0;
+                curl_easy_getinfo(segment->easy, CURLINFO_SIZE_DOWNLOAD_T, &down);
+                TransferShaper::instance().record(TransferClass::Background,
+                                                  (uint64_t) std::max<curl_off_t>(down, 0), 0);
+
+                if (code == CURLE_OK && segment->complete()) {
+                    HttpConnectionPool::instance().recordTransfer(segment->easy);
+                    --active;
+                    continue;
+                }
+
+                if (segment->rejected) {
+                    outcome = DownloadOutcome::RangesUnsupported;
+                    error = "Server ignored the requested byte range";
+                    break;
+                }
+                if (segment->writeFailed) {
+                    error = "Cannot write file";
+                    break;
+                }
+
+                std::string reason = code == CURLE_OK            ? "short response"
+                                     : strlen(segment->error) ? segment->error
+                                                              : curl_easy_strerror(code);
+                if (++segment->attempts >= DOWNLOAD_MAX_ATTEMPTS) {
+                    error = reason;
+                    break;
+                }
+
+                // Only this range is retried, the others keep streaming
+                obs_log(LOG_WARNING,
+                        "[Download] Segment %lld-%lld attempt %d failed (%s), resuming at %lld",
+                        (long long) segment->start, (long long) segment->end, segment->attempts,
+                        reason.c_str(), (long long) (segment->start + segment->written));
+                start_segment(multi, *segment, url, header, segments);
+            }
+
+            if (!error.empty()) {
+                if (outcome == DownloadOutcome::Completed)
+                    outcome = DownloadOutcome::Failed;
+                break;
+            }
+
+            if (worker.isCanceled()) {
+                outcome = DownloadOutcome::Canceled;
+                break;
+            }
+
+            auto now = std::chrono::steady_clock::now();
+            if (now - lastProgress >= std::chrono::milliseconds(DOWNLOAD_PROGRESS_INTERVAL_MS)) {
+                lastProgress = now;
+                qint64 received = 0;
+                for (const Segment& segment : plan.segments)
+                    received += segment.written;
+                emit worker.progress(received, plan.length);
+            }
+
+            if (now - lastSave >= std::chrono::milliseconds(DOWNLOAD_PLAN_SAVE_INTERVAL_MS)) {
+                lastSave = now;
+                part.flush();
+                save_plan(planPath, plan);
+            }
+
+            // Short poll so a cancel request is noticed within one chunk
+            if (active > 0)
+                curl_multi_poll(multi, nullptr, 0, 100, nullptr);
+        }
+
+        for (Segment& segment : plan.segments) {
+            if (!segment.easy)
+                continue;
+            curl_multi_remove_handle(multi, segment.easy);
+            curl_easy_cleanup(segment.easy);
+            segment.easy = nullptr;
+        }
+        curl_multi_cleanup(multi);
+
+        part.flush();
+        if (outcome == DownloadOutcome::Canceled || outcome == DownloadOutcome::Failed)
+            save_plan(planPath, plan);
+        return outcome;
+    }
+}  // namespace
+
+DownloadWorker::DownloadWorker(const QString& url, const QString& filePath,
+                               const QString& expectedSha256)
+    : downloadUrl(url),
+      filePath(filePath),
+      expectedSha256(normalized_digest(expectedSha256)),
+      segments(DOWNLOAD_SEGMENTS),
+      canceled(false),
+      cancelToken(std::make_shared<CancellationToken>()) {}
+
+void DownloadWorker::setSegments(int count) {
+    segments = count < 1 ? 1 : count;
+}
 
 void DownloadWorker::cancel() {
     QMutexLocker locker(&mutex);
     canceled = true;
+    cancelToken->cancel();
+}
+
+bool DownloadWorker::isCanceled() {
+    QMutexLocker locker(&mutex);
+    return canceled;
+}
+
+std::shared_ptr<CancellationToken> DownloadWorker::cancellationToken() const {
+    return cancelToken;
 }
 
 void DownloadWorker::process() {
+    const QString partPath = filePath + ".part";
+    const std::filesystem::path planPath(partPath.toStdU16String() + u".segments");
+    const std::string url = downloadUrl.toStdString();
+
+    QFile part(partPath);
+    if (!part.open(QIODevice::ReadWrite)) {
+        emit finished(false, "Cannot write file");
+        return;
+    }
+
+    std::string userAgent("User-Agent: obs-basic ");
+    userAgent += obs_get_version_string();
+    struct curl_slist* header = curl_slist_append(nullptr, userAgent.c_str());
+
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    DownloadOutcome outcome = DownloadOutcome::Failed;
     std::string error;
-    long responseCode = 0;
-    std::string content;
+    bool segmented = false;
 
-    bool success = GetRemoteFile(downloadUrl.toStdString().c_str(), content, error, &responseCode,
-                                 nullptr, "GET", nullptr, {}, nullptr, 0, true);
+    // A .part without a plan belongs to a single-stream download and is resumed as one
+    SegmentPlan plan;
+    bool resumePlan = load_plan(planPath, plan);
+    // While OBS is streaming, parallel ranges would compete with its upload; stay on one stream
+    bool streaming = TransferShaper::instance().isStreaming();
+    if (segments > 1 && (resumePlan || (part.size() == 0 && !streaming))) {
+        RangeProbe probe = probe_ranges(url, header);
+        if (resumePlan && probe.ok &&
+            (!probe.ranges || probe.length != plan.length || part.size() != plan.length)) {
+            obs_log(LOG_WARNING, "[Download] Remote file changed, discarding partial download");
+            resumePlan = false;
+            part.resize(0);
+        }
+
+        int count = static_cast<int>(
+            std::min<qint64>(segments, probe.length / DOWNLOAD_SEGMENT_MIN_SIZE));
+        if (resumePlan && !probe.ok) {
+            error = "Cannot reach download server";
+            segmented = true;
+        } else if (resumePlan) {
+            obs_log(LOG_INFO, "[Download] Resuming %d segments of %lld bytes",
+                    (int) plan.segments.size(), (long long) plan.length);
+            segmented = true;
+        } else if (probe.ranges && count > 1) {
+            obs_log(LOG_INFO, "[Download] Fetching %lld bytes in %d segments",
+                    (long long) probe.length, count);
+            plan = make_plan(probe.length, count);
+            segmented = part.resize(plan.length);  // preallocate, segments write in place
+        }
+    }
+    if (!segmented) {
+        std::error_code ec;
+        std::filesystem::remove(planPath, ec);
+    }
+
+    if (segmented && error.empty()) {
+        outcome = segmented_download(*this, url, header, part, plan, planPath, error);
+        if (outcome == DownloadOutcome::RangesUnsupported) {
+            obs_log(LOG_WARNING, "[Download] %s, falling back to a single stream", error.c_str());
+            std::error_code ec;
+            std::filesystem::remove(planPath, ec);
+            part.resize(0);
+            error.clear();
+            segmented = false;
+        } else if (outcome == DownloadOutcome::Completed) {
+            std::error_code ec;
+            std::filesystem::remove(planPath, ec);
+            // Segments arrive out of order, so the digest is taken in one pass at the end
+            part.seek(0);
+            hash.addData(&part);
+        }
+    }
 
-    {
-        QMutexLocker locker(&mutex);
-        if (canceled) {
-            // emit finished(false, "Download canceled");
-            return;
+    if (!segmented) {
+        // Digest covers the whole file, so a resumed download first hashes what is on disk
+        if (part.size() > 0) {
+            obs_log(LOG_INFO, "[Download] Resuming from %lld bytes", (long long) part.size());
+            part.seek(0);
+            hash.addData(&part);
         }
+        part.seek(part.size());
+        outcome = stream_download(*this, url, part, hash, error);
     }
 
-    obs_log(LOG_INFO, "Download response code: %ld", responseCode);
-    obs_log(LOG_INFO, "Download error: %s", error.c_str());
+    curl_slist_free_all(header);
+    qint64 size = part.size();
+    part.close();
 
-    if (!success || responseCode != 200) {
+    if (outcome == DownloadOutcome::Canceled) {
+        // Keep the .part file so the next attempt can resume
+        obs_log(LOG_INFO, "[Download] Canceled");
+        emit finished(false, "Download canceled");
+        return;
+    }
+
+    if (outcome != DownloadOutcome::Completed) {
+        obs_log(LOG_WARNING, "[Download] Failed: %s", error.c_str());
         emit finished(false, QString::fromStdString(error));
         return;
     }
 
-    QFile file(filePath);
-    if (!file.open(QIODevice::WriteOnly)) {
+    emit progress(size, size);
+
+    QString digest = QString::fromLatin1(hash.result().toHex());
+    if (!expectedSha256.isEmpty() && digest != expectedSha256) {
+        obs_log(LOG_WARNING, "[Download] SHA-256 mismatch: expected %s, got %s",
+                expectedSha256.toUtf8().constData(), digest.toUtf8().constData());
+        QFile::remove(partPath);
+        emit finished(false, "Checksum mismatch");
+        return;
+    }
+    obs_log(LOG_INFO, "[Download] Completed %lld bytes, sha256 %s%s", (long long) size,
+            digest.toUtf8().constData(), expectedSha256.isEmpty() ? " (not verified)" : "");
+
+    // Replaces an existing file in a single step, so the target is never half-written
+    std::error_code ec;
+    std::filesystem::rename(std::filesystem::path(partPath.toStdU16String()),
+                            std::filesystem::path(filePath.toStdU16String()), ec);
+    if (ec) {
+        obs_log(LOG_WARNING, "[Download] Cannot move %s into place: %s",
+                partPath.toUtf8().constData(), ec.message().c_str());
         emit finished(false, "Cannot write file");
         return;
     }
-    file.write(content.c_str(), content.size());
-    file.close();
 
     emit finished(true, "");
 }
@@ -4,16 +4,42 @@
 #include <QObject>
 #include <QThread>
 #include <QWaitCondition>
+#include <memory>
+
+class CancellationToken;
 
 class DownloadWorker : public QObject {
     Q_OBJECT
    public:
-    DownloadWorker(const QString& url, const QString& filePath);
+    /**
+     * Streams url to filePath through "<filePath>.part". When the server honours byte ranges
+     * and the file is large enough, it is fetched as several concurrent ranges written into
+     * the preallocated .part file; otherwise it falls back to a single stream. An interrupted
+     * download leaves the .part file behind and is resumed next time. expectedSha256 is the
+     * hex digest (optionally "sha256:"-prefixed, as in GitHub release assets); when set, the
+     * file is only renamed into place if the digest matches.
+     *
+     * Downloads are background transfers: while OBS is streaming a new download uses a single
+     * capped stream, and a resumed segmented one splits the cap between its ranges.
+     */
+    DownloadWorker(const QString& url, const QString& filePath,
+                   const QString& expectedSha256 = QString());
+
+    /**
+     * Set the maximum number of concurrent byte ranges (1 disables segmented downloads)
+     */
+    void setSegments(int count);
 
     void cancel();
+    bool isCanceled();
+
+    /**
+     * Token canceled together with the download, for transfers and waits that honour one
+     */
+    std::shared_ptr<CancellationToken> cancellationToken() const;
 
    signals:
-    void progress(int value);
+    void progress(qint64 bytesReceived, qint64 bytesTotal);
     void finished(bool success, const QString& error);
 
    public slots:
@@ -22,6 +48,9 @@ class DownloadWorker : public QObject {
    private:
     QString downloadUrl;
     QString filePath;
+    QString expectedSha256;
+    int segments;
     bool canceled;
     QMutex mutex;
+    std::shared_ptr<CancellationToken> cancelToken;
 };
@@ -0,0 +1,218 @@
+/******************************************************************************
+    Copyright (C) 2024 by 17Live
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+
+#include "HttpCassette.hpp"
+
+#include <obs-module.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <nlohmann/json.hpp>
+#include <thread>
+
+#include "plugin-support.h"
+
+using Json = nlohmann::json;
+
+static const char base64_chars[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static std::string base64_encode(const std::string &in) {
+    std::string out;
+    out.reserve((in.size() + 2) / 3 * 4);
+
+    size_t i = 0;
+    for (; i + 2 < in.size(); i += 3) {
+        uint32_t n = ((uint8_t) in[i] << 16) | ((uint8_t) in[i + 1] << 8) | (uint8_t) in[i + 2];
+        out += base64_chars[(n >> 18) & 63];
+        out += base64_chars[(n >> 12) & 63];
+        out += base64_chars[(n >> 6) & 63];
+        out += base64_chars[n & 63];
+    }
+
+    if (i < in.size()) {
+        uint32_t n = (uint8_t) in[i] << 16;
+        if (i + 1 < in.size())
+            n |= (uint8_t) in[i + 1] << 8;
+        out += base64_chars[(n >> 18) & 63];
+        out += base64_chars[(n >> 12) & 63];
+        out += i + 1 < in.size() ? base64_chars[(n >> 6) & 63] : '=';
+        out += '=';
+    }
+    return out;
+}
+
+static std::string base64_decode(const std::string &in) {
+    std::string out;
+    out.reserve(in.size() / 4 * 3);
+
+    uint32_t n = 0;
+    int bits = 0;
+    for (char c : in) {
+        const char *pos = strchr(base64_chars, c);
+        if (c == '=' || !c || !pos)
+            continue;
+        n = (n << 6) | (uint32_t) (pos - base64_chars);
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            out += (char) ((n >> bits) & 0xFF);
+        }
+    }
+    return out;
+}
+
+static bool is_valid_utf8(const std::string &str) {
+    try {
+        (void) Json(str).dump();
+        return true;
+    } catch (const Json::type_error &) {
+        return false;
+    }
+}
+
+HttpCassette &HttpCassette::instance() {
+    static HttpCassette *cassette = new HttpCassette();
+    return *cassette;
+}
+
+HttpCassette::HttpCassette() {
+    const char *file = getenv(HTTP_CASSETTE_ENV);
+    if (!file || !*file)
+        return;
+
+    path = file;
+
+    const char *modeName = getenv(HTTP_CASSETTE_MODE_ENV);
+    bool replaying = modeName && std::string(modeName) == "replay";
+
+    const char *latency = getenv(HTTP_CASSETTE_LATENCY_ENV);
+    if (latency && std::string(latency) == "none")
+        latencyMs = 0;
+    else if (latency && *latency && std::string(latency) != "recorded")
+        latencyMs = std::max(atoi(latency), 0);
+
+    if (replaying) {
+        load();
+        mode = Mode::Replay;
+        obs_log(LOG_INFO, "[HTTP Cassette] Replaying %zu distinct requests from %s", entries.size(),
+                path.c_str());
+        return;
+    }
+
+    output.open(path, std::ios::out | std::ios::app | std::ios::binary);
+    if (!output.is_open()) {
+        obs_log(LOG_WARNING, "[HTTP Cassette] Cannot open %s for recording", path.c_str());
+        return;
+    }
+
+    mode = Mode::Record;
+    obs_log(LOG_INFO, "[HTTP Cassette] Recording to %s", path.c_str());
+}
+
+std::string HttpCassette::key(const std::string &method, const std::string &url,
+                              const std::string &body) {
+    std::string normalized = method.empty() ? (body.empty() ? "GET" : "POST") : method;
+    return normalized + " " + url + "\n" + body;
+}
+
+void HttpCassette::load() {
+    std::ifstream input(path, std::ios::in | std::ios::binary);
+    if (!input.is_open()) {
+        obs_log(LOG_WARNING, "[HTTP Cassette] Cannot open %s for replay", path.c_str());
+        return;
+    }
+
+    std::string line;
+    size_t lineNumber = 0;
+    while (std::getline(input, line)) {
+        lineNumber++;
+        if (line.empty())
+            continue;
+
+        try {
+            Json j = Json::parse(line);
+
+            HttpCassetteEntry entry;
+            entry.method = j.value("method", "");
+            entry.url = j.value("url", "");
+            entry.requestBody = j.value("requestBody", "");
+            entry.success = j.value("success", false);
+            entry.status = j.value("status", 0L);
+            entry.error = j.value("error", "");
+            entry.headers = j.value("headers", std::vector<std::string>());
+            entry.body = j.contains("bodyBase64")
+                             ? base64_decode(j["bodyBase64"].get<std::string>())
+                             : j.value("body", "");
+            entry.totalMs = j.value("totalMs", 0.0);
+
+            entries[key(entry.method, entry.url, entry.requestBody)].push_back(std::move(entry));
+        } catch (const Json::exception &e) {
+            obs_log(LOG_WARNING, "[HTTP Cassette] Skipping line %zu of %s: %s", lineNumber,
+                    path.c_str(), e.what());
+        }
+    }
+}
+
+void HttpCassette::record(const HttpCassetteEntry &entry) {
+    Json j;
+    j["method"] = entry.method.empty() ? (entry.requestBody.empty() ? "GET" : "POST")
+                                       : entry.method;
+    j["url"] = entry.url;
+    j["requestBody"] = entry.requestBody;
+    j["success"] = entry.success;
+    j["status"] = entry.status;
+    j["error"] = entry.error;
+    j["headers"] = entry.headers;
+    if (is_valid_utf8(entry.body))
+        j["body"] = entry.body;
+    else
+        j["bodyBase64"] = base64_encode(entry.body);
+    j["totalMs"] = entry.totalMs;
+
+    std::string line = j.dump(-1, ' ', false, Json::error_handler_t::replace);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    output << line << '\n';
+    output.flush();
+}
+
+bool HttpCassette::replay(const std::string &method, const std::string &url,
+                          const std::string &body, HttpCassetteEntry &entry) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = entries.find(key(method, url, body));
+        if (it == entries.end()) {
+            obs_log(LOG_WARNING, "[HTTP Cassette] No recorded response for %s %s",
+                    method.empty() ? "GET" : method.c_str(), url.c_str());
+            return false;
+        }
+
+        size_t &cursor = cursors[it->first];
+        entry = it->second[cursor % it->second.size()];
+        cursor++;
+    }
+
+    double delay = latencyMs >= 0 ? latencyMs : entry.totalMs;
+    if (delay > 0)
+        std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(delay));
+
+    return true;
+}
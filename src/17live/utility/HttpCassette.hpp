@@ -0,0 +1,102 @@
+/******************************************************************************
+    Copyright (C) 2024 by 17Live
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+
+#pragma once
+
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Path of the cassette file; record/replay is disabled when unset
+#define HTTP_CASSETTE_ENV "OBS_17LIVE_HTTP_CASSETTE"
+// "record" (default) or "replay"
+#define HTTP_CASSETTE_MODE_ENV "OBS_17LIVE_HTTP_CASSETTE_MODE"
+// Replay latency: "recorded" (default), "none", or a fixed number of milliseconds
+#define HTTP_CASSETTE_LATENCY_ENV "OBS_17LIVE_HTTP_CASSETTE_LATENCY"
+
+/**
+ * One recorded request/response pair. Request headers are not stored so that cassettes never
+ * contain access tokens.
+ */
+struct HttpCassetteEntry {
+    std::string method;
+    std::string url;
+    std::string requestBody;
+
+    bool success = false;
+    long status = 0;
+    std::string error;
+    std::vector<std::string> headers;
+    std::string body;
+    double totalMs = 0.0;
+};
+
+/**
+ * Record/replay of GetRemoteFile traffic for offline benchmarking and regression runs.
+ *
+ * The cassette is a JSON Lines file, one HttpCassetteEntry per line. In replay mode requests
+ * are matched on method, URL and request body; repeated requests are served the recorded
+ * responses in order and wrap around after the last one.
+ */
+class HttpCassette {
+   public:
+    enum class Mode { Off, Record, Replay };
+
+    /**
+     * Get the cassette, configured from the environment on first use
+     */
+    static HttpCassette &instance();
+
+    bool isRecording() const { return mode == Mode::Record; }
+    bool isReplaying() const { return mode == Mode::Replay; }
+
+    /**
+     * Append an entry to the cassette file
+     */
+    void record(const HttpCassetteEntry &entry);
+
+    /**
+     * Look up the next recorded response and apply the configured latency
+     * @return false if the cassette has no entry for the request
+     */
+    bool replay(const std::string &method, const std::string &url, const std::string &body,
+                HttpCassetteEntry &entry);
+
+    HttpCassette(const HttpCassette &) = delete;
+    HttpCassette &operator=(const HttpCassette &) = delete;
+
+   private:
+    HttpCassette();
+
+    void load();
+    static std::string key(const std::string &method, const std::string &url,
+                           const std::string &body);
+
+    Mode mode = Mode::Off;
+    std::string path;
+
+    // Negative: use recorded latency
+    int latencyMs = -1;
+
+    std::mutex mutex;
+    std::ofstream output;
+    std::map<std::string, std::vector<HttpCassetteEntry>> entries;
+    std::map<std::string, size_t> cursors;
+};
@@ -0,0 +1,623 @@
+/******************************************************************************
+    Copyright (C) 2024 by 17Live
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "HttpClient.hpp"
+
+#include <obs-module.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#include "../../../deps/cpp-httplib/httplib.h"
+#include "HttpConnectionPool.hpp"
+#include "HttpMetrics.hpp"
+#include "curl-helper.h"
+#include "plugin-support.h"
+
+// cpp-httplib waits this long for a connection or the next read when the request sets no timeout
+#define HTTPLIB_DEFAULT_TIMEOUT_SEC 300
+
+static std::string user_agent_header() {
+    std::string versionString("User-Agent: obs-basic ");
+    versionString += obs_get_version_string();
+    return versionString;
+}
+
+CurlTransfer::CurlTransfer(CURL *curl_, const HttpRequest &request_)
+    : curl(curl_), request(request_) {
+    error[0] = 0;
+
+    headers = curl_slist_append(headers, user_agent_header().c_str());
+
+    if (!request.contentType.empty()) {
+        std::string contentTypeString("Content-Type: ");
+        contentTypeString += request.contentType;
+        headers = curl_slist_append(headers, contentTypeString.c_str());
+    }
+
+    for (const std::string &h : request.headers)
+        headers = curl_slist_append(headers, h.c_str());
+
+    // The shared block is linked behind the request's own headers, not copied
+    if (headers && request.sharedHeaders && request.sharedHeaders->list()) {
+        sharedTail = headers;
+        while (sharedTail->next)
+            sharedTail = sharedTail->next;
+        sharedTail->next = request.sharedHeaders->list();
+    }
+
+    curl_easy_setopt(curl, CURLOPT_URL, request.url.c_str());
+    curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "");
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    curl_easy_setopt(curl, CURLOPT_ERRORBUFFER, error);
+    if (request.failOnError)
+        curl_easy_setopt(curl, CURLOPT_FAILONERROR, 1L);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeBody);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, this);
+    curl_obs_set_revoke_setting(curl);
+
+    if (request.cancel || request.onProgress) {
+        curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, progress);
+        curl_easy_setopt(curl, CURLOPT_XFERINFODATA, this);
+        curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+    }
+
+    if (request.collectHeaders) {
+        curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, writeHeader);
+        curl_easy_setopt(curl, CURLOPT_HEADERDATA, &response.headers);
+    }
+
+    if (request.timeoutSec)
+        curl_easy_setopt(curl, CURLOPT_TIMEOUT, (long) request.timeoutSec);
+    if (request.connectTimeoutSec)
+        curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, (long) request.connectTimeoutSec);
+    if (request.stallTimeoutSec) {
+        curl_easy_setopt(curl, CURLOPT_LOW_SPEED_LIMIT, 1L);
+        curl_easy_setopt(curl, CURLOPT_LOW_SPEED_TIME, (long) request.stallTimeoutSec);
+    }
+
+    if (request.followRedirects) {
+        curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+        curl_easy_setopt(curl, CURLOPT_MAXREDIRS, 10L);
+    }
+
+    if (request.resumeFrom > 0)
+        curl_easy_setopt(curl, CURLOPT_RESUME_FROM_LARGE, (curl_off_t) request.resumeFrom);
+
+    TransferShaper::instance().apply(curl, request.transferClass);
+
+    if (request.method == "HEAD") {
+        curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
+    } else if (!request.method.empty() && request.method != "GET") {
+        curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, request.method.c_str());
+
+        // Special case of "POST"
+        if (request.method == "POST") {
+            curl_easy_setopt(curl, CURLOPT_POST, 1L);
+            if (request.body.empty())
+                curl_easy_setopt(curl, CURLOPT_POSTFIELDS, "{}");
+        }
+    }
+
+    if (!request.body.empty()) {
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE, (curl_off_t) request.body.size());
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, request.body.data());
+    }
+}
+
+CurlTransfer::~CurlTransfer() {
+    // Unlink the shared block first, it belongs to the HttpHeaderBlock
+    if (sharedTail)
+        sharedTail->next = nullptr;
+    curl_slist_free_all(headers);
+}
+
+HttpResponse &CurlTransfer::finish(CURLcode result) {
+    response.code = result;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response.status);
+    curl_easy_getinfo(curl, CURLINFO_HTTP_VERSION, &response.httpVersion);
+    curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &response.newConnections);
+
+    curl_off_t connect = 0, appConnect = 0, total = 0;
+    curl_easy_getinfo(curl, CURLINFO_CONNECT_TIME_T, &connect);
+    curl_easy_getinfo(curl, CURLINFO_APPCONNECT_TIME_T, &appConnect);
+    curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME_T, &total);
+    response.handshakeMs = (appConnect > 0 ? appConnect : connect) / 1000.0;
+    response.totalMs = total / 1000.0;
+
+    if (result == CURLE_ABORTED_BY_CALLBACK && request.cancel && request.cancel->isCanceled())
+        response.error = "Request canceled";
+    else if (result != CURLE_OK)
+        response.error = strlen(error) ? error : curl_easy_strerror(result);
+
+    curl_off_t down = 0, up = 0;
+    curl_easy_getinfo(curl, CURLINFO_SIZE_DOWNLOAD_T, &down);
+    curl_easy_getinfo(curl, CURLINFO_SIZE_UPLOAD_T, &up);
+    TransferShaper::instance().record(request.transferClass,
+                                      (uint64_t) std::max<curl_off_t>(down, 0),
+                                      (uint64_t) std::max<curl_off_t>(up, 0));
+
+    HttpMetrics::instance().record(curl, request.url, result);
+    return response;
+}
+
+size_t CurlTransfer::writeBody(char *ptr, size_t size, size_t nmemb, void *userdata) {
+    CurlTransfer &transfer = *static_cast<CurlTransfer *>(userdata);
+    const HttpRequest &request = transfer.request;
+
+    size_t total = size * nmemb;
+    if (total && request.onData) {
+        if (request.cancel && request.cancel->isCanceled())
+            return 0;
+        return request.onData(ptr, total) ? total : 0;
+    }
+
+    if (total) {
+        std::string &body = transfer.response.body;
+        if (body.empty())
+            body.reserve(ContentLengthHint(transfer.curl));
+        body.append(ptr, total);
+    }
+
+    return total;
+}
+
+size_t CurlTransfer::writeHeader(char *ptr, size_t size, size_t nmemb, void *userdata) {
+    std::vector<std::string> &list = *static_cast<std::vector<std::string> *>(userdata);
+
+    size_t total = size * nmemb;
+    std::string str(ptr, total);
+
+    while (!str.empty() && (str.back() == '\n' || str.back() == '\r'))
+        str.pop_back();
+
+    if (!str.empty())
+        list.push_back(std::move(str));
+    return total;
+}
+
+int CurlTransfer::progress(void *userp, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal,
+                           curl_off_t ulnow) {
+    (void) ultotal;
+    (void) ulnow;
+
+    const HttpRequest &request = static_cast<CurlTransfer *>(userp)->request;
+
+    // Non-zero makes curl fail the transfer with CURLE_ABORTED_BY_CALLBACK
+    if (request.cancel && request.cancel->isCanceled())
+        return 1;
+
+    if (request.onProgress) {
+        int64_t total = dltotal > 0 ? request.resumeFrom + (int64_t) dltotal : 0;
+        if (!request.onProgress(request.resumeFrom + (int64_t) dlnow, total))
+            return 1;
+    }
+
+    return 0;
+}
+
+namespace {
+    HttpResponse canceled_response() {
+        HttpResponse response;
+        response.code = CURLE_ABORTED_BY_CALLBACK;
+        response.error = "Request canceled";
+        return response;
+    }
+
+    class CurlEasyClient : public HttpClient {
+       public:
+        const char *name() const override { return "curl-easy"; }
+
+        HttpResponse perform(const HttpRequest &request) override {
+            HttpResponse response;
+
+            TransferSlot slot(request.transferClass, request.cancel);
+            if (!slot.isAcquired())
+                return canceled_response();
+
+            CURL *curl = HttpConnectionPool::instance().acquire();
+            if (!curl) {
+                response.error = curl_easy_strerror(CURLE_FAILED_INIT);
+                return response;
+            }
+
+            CurlTransfer transfer(curl, request);
+            CURLcode code = curl_easy_perform(curl);
+            if (code == CURLE_OK)
+                HttpConnectionPool::instance().recordTransfer(curl);
+
+            return std::move(transfer.finish(code));
+        }
+    };
+
+    class CurlMultiClient : public HttpClient {
+       public:
+        explicit CurlMultiClient(HttpClient &fallback_) : fallback(fallback_) {}
+
+        const char *name() const override { return "curl-multi"; }
+
+        HttpResponse perform(const HttpRequest &request) override {
+            HttpEngine &engine = HttpEngine::instance();
+            if (!engine.isHttp2Enabled())
+                return fallback.perform(request);
+
+            bool streamed = false;
+            HttpRequest engineRequest = request;
+            if (request.onData) {
+                engineRequest.onData = [&request, &streamed](const char *data, size_t size) {
+                    streamed = true;
+                    return request.onData(data, size);
+                };
+            }
+
+            HttpResponse response = engine.perform(std::move(engineRequest));
+
+            // Engine unavailable: nothing was sent, retry over plain HTTP/1.1. An HTTP/2 stream
+            // can be reset after the server applied the request, so after framing errors only
+            // reads are sent again. Neither once part of the body was streamed to the caller.
+            bool idempotent = request.body.empty() &&
+                              (request.method.empty() || request.method == "GET" ||
+                               request.method == "HEAD");
+            bool http2Error =
+                response.code == CURLE_HTTP2 || response.code == CURLE_HTTP2_STREAM;
+            bool retry =
+                !streamed && (response.code == CURLE_FAILED_INIT || (http2Error && idempotent));
+            if (!retry)
+                return response;
+
+            obs_log(LOG_WARNING, "[HTTP Engine] %s, falling back to HTTP/1.1 for %s",
+                    response.error.c_str(), request.url.c_str());
+            return fallback.perform(request);
+        }
+
+       private:
+        HttpClient &fallback;
+    };
+
+    class HttplibClient : public HttpClient {
+       public:
+        const char *name() const override { return "httplib"; }
+
+        HttpResponse perform(const HttpRequest &request) override;
+
+       private:
+        // Keep-alive clients of the calling thread, by scheme://host:port. They are dropped
+        // when HttpConnectionPool::invalidate() was called since they were opened.
+        static std::map<std::string, std::unique_ptr<httplib::Client>> &threadClients() {
+            thread_local std::map<std::string, std::unique_ptr<httplib::Client>> clients;
+            thread_local uint64_t generation = 0;
+
+            uint64_t current = HttpConnectionPool::instance().generation();
+            if (generation != current) {
+                clients.clear();
+                generation = current;
+            }
+            return clients;
+        }
+    };
+
+    CURLcode httplib_error_code(httplib::Error error) {
+        switch (error) {
+            case httplib::Error::Success:
+                return CURLE_OK;
+            case httplib::Error::Connection:
+            case httplib::Error::BindIPAddress:
+                return CURLE_COULDNT_CONNECT;
+            case httplib::Error::Read:
+                return CURLE_RECV_ERROR;
+            case httplib::Error::Write:
+                return CURLE_SEND_ERROR;
+            case httplib::Error::ExceedRedirectCount:
+                return CURLE_TOO_MANY_REDIRECTS;
+            case httplib::Error::Canceled:
+                return CURLE_ABORTED_BY_CALLBACK;
+            case httplib::Error::SSLConnection:
+            case httplib::Error::SSLLoadingCerts:
+                return CURLE_SSL_CONNECT_ERROR;
+            case httplib::Error::SSLServerVerification:
+                return CURLE_PEER_FAILED_VERIFICATION;
+            case httplib::Error::Compression:
+                return CURLE_BAD_CONTENT_ENCODING;
+            default:
+                return CURLE_RECV_ERROR;
+        }
+    }
+
+    long httplib_version(const std::string &version) {
+        if (version == "HTTP/1.0")
+            return CURL_HTTP_VERSION_1_0;
+        if (version == "HTTP/1.1")
+            return CURL_HTTP_VERSION_1_1;
+        return CURL_HTTP_VERSION_NONE;
+    }
+
+    HttpResponse HttplibClient::perform(const HttpRequest &request) {
+        using Clock = std::chrono::steady_clock;
+
+        HttpResponse response;
+        Clock::time_point started = Clock::now();
+
+        size_t schemeEnd = request.url.find("://");
+        size_t pathStart =
+            request.url.find('/', schemeEnd == std::string::npos ? 0 : schemeEnd + 3);
+        std::string origin = request.url.substr(0, pathStart);
+        std::string path = pathStart == std::string::npos ? "/" : request.url.substr(pathStart);
+
+        TransferSlot slot(request.transferClass, request.cancel);
+        if (!slot.isAcquired() || (request.cancel && request.cancel->isCanceled()))
+            return canceled_response();
+
+        auto &clients = threadClients();
+        auto it = clients.find(origin);
+        if (it == clients.end()) {
+            std::unique_ptr<httplib::Client> client;
+            try {
+                client = std::make_unique<httplib::Client>(origin.c_str());
+            } catch (const std::exception &e) {
+                // https without CPPHTTPLIB_OPENSSL_SUPPORT, or an unknown scheme
+                response.code = CURLE_UNSUPPORTED_PROTOCOL;
+                response.error = std::string("cpp-httplib: ") + e.what();
+                return response;
+            }
+
+            if (!client->is_valid()) {
+                response.code = CURLE_UNSUPPORTED_PROTOCOL;
+                response.error = "cpp-httplib cannot handle " + origin;
+                return response;
+            }
+
+            client->set_keep_alive(true);
+            client->set_tcp_nodelay(true);  // curl's default
+            it = clients.emplace(origin, std::move(client)).first;
+            response.newConnections = 1;
+        }
+        httplib::Client &client = *it->second;
+
+        int connectTimeout = request.connectTimeoutSec ? request.connectTimeoutSec
+                             : request.timeoutSec      ? request.timeoutSec
+                                                       : HTTPLIB_DEFAULT_TIMEOUT_SEC;
+        int readTimeout = request.stallTimeoutSec ? request.stallTimeoutSec
+                          : request.timeoutSec    ? request.timeoutSec
+                                                  : HTTPLIB_DEFAULT_TIMEOUT_SEC;
+        client.set_connection_timeout(connectTimeout);
+        client.set_read_timeout(readTimeout);
+        client.set_follow_location(request.followRedirects);
+
+        httplib::Request req;
+        // Like curl, a body without an explicit method is POSTed
+        req.method = !request.method.empty() ? request.method
+                     : request.body.empty()  ? "GET"
+                                             : "POST";
+        req.path = path;
+        req.body = request.body;
+        if (req.method == "POST" && req.body.empty())
+            req.body = "{}";
+
+        std::vector<std::string> headerLines = request.headers;
+        headerLines.insert(headerLines.begin(), user_agent_header());
+        if (request.sharedHeaders)
+            headerLines.insert(headerLines.end(), request.sharedHeaders->lines().begin(),
+                               request.sharedHeaders->lines().end());
+        if (!request.contentType.empty())
+            headerLines.push_back("Content-Type: " + request.contentType);
+        for (const std::string &h : headerLines) {
+            size_t colon = h.find(':');
+            if (colon == std::string::npos)
+                continue;
+            size_t valueStart = h.find_first_not_of(' ', colon + 1);
+            req.headers.emplace(h.substr(0, colon), valueStart == std::string::npos
+                                                        ? std::string()
+                                                        : h.substr(valueStart));
+        }
+        if (request.resumeFrom > 0)
+            req.headers.emplace("Range", "bytes=" + std::to_string(request.resumeFrom) + "-");
+
+        // Set by the callbacks below when they abort the transfer, cpp-httplib only reports
+        // Error::Canceled then
+        CURLcode abortCode = CURLE_OK;
+        std::string abortError;
+        bool redirecting = false;
+
+        // curl's MAX_RECV_SPEED for the body; the request body is sent at full speed
+        curl_off_t recvLimit = TransferShaper::instance().recvLimit(request.transferClass);
+        uint64_t received = 0;
+        Clock::time_point bodyStarted;
+
+        auto shouldAbort = [&]() {
+            if (request.cancel && request.cancel->isCanceled()) {
+                abortCode = CURLE_ABORTED_BY_CALLBACK;
+                abortError = "Request canceled";
+                return true;
+            }
+            if (request.timeoutSec &&
+                Clock::now() - started >= std::chrono::seconds(request.timeoutSec)) {
+                abortCode = CURLE_OPERATION_TIMEDOUT;
+                abortError = "Operation timed out after " + std::to_string(request.timeoutSec) +
+                             " seconds";
+                return true;
+            }
+            return false;
+        };
+
+        req.response_handler_ = [&](const httplib::Response &res) {
+            response.status = res.status;
+            redirecting = request.followRedirects && res.status > 300 && res.status < 400 &&
+                          res.has_header("Location");
+            if (redirecting)
+                return true;
+
+            if (request.failOnError && res.status >= 400) {
+                abortCode = CURLE_HTTP_RETURNED_ERROR;
+                abortError = "The requested URL returned error: " + std::to_string(res.status);
+                return false;
+            }
+            if (request.resumeFrom > 0 && res.status != 206) {
+                abortCode = CURLE_RANGE_ERROR;
+                abortError = "HTTP server doesn't seem to support byte ranges. Cannot resume.";
+                return false;
+            }
+            return !shouldAbort();
+        };
+
+        req.content_receiver_ = [&](const char *data, size_t size, uint64_t, uint64_t) {
+            if (redirecting)
+                return true;
+            if (shouldAbort())
+                return false;
+
+            if (request.onData) {
+                if (!request.onData(data, size)) {
+                    abortCode = CURLE_WRITE_ERROR;
+                    abortError = "Failure writing output to destination";
+                    return false;
+                }
+            } else {
+                response.body.append(data, size);
+            }
+
+            if (!received)
+                bodyStarted = Clock::now();
+            received += size;
+            if (recvLimit > 0) {
+                // Hold the connection until the average speed is back under the cap
+                auto due = bodyStarted + std::chrono::microseconds(received * 1000000 /
+                                                                   (uint64_t) recvLimit);
+                if (due > Clock::now())
+                    std::this_thread::sleep_until(due);
+            }
+            return true;
+        };
+
+        req.progress_ = [&](uint64_t current, uint64_t total) {
+            if (redirecting || !request.onProgress)
+                return true;
+
+            int64_t received = request.resumeFrom + (int64_t) current;
+            if (!request.onProgress(received, total ? request.resumeFrom + (int64_t) total : 0)) {
+                abortCode = CURLE_ABORTED_BY_CALLBACK;
+                abortError = "Callback aborted";
+                return false;
+            }
+            return true;
+        };
+
+        httplib::Result result = client.send(req);
+
+        response.totalMs =
+            std::chrono::duration<double, std::milli>(Clock::now() - started).count();
+        TransferShaper::instance().record(request.transferClass, received, req.body.size());
+
+        if (result) {
+            response.status = result->status;
+            response.httpVersion = httplib_version(result->version);
+            if (request.collectHeaders) {
+                for (const auto &header : result->headers)
+                    response.headers.push_back(header.first + ": " + header.second);
+            }
+        }
+
+        if (abortCode != CURLE_OK) {
+            response.code = abortCode;
+            response.error = abortError;
+        } else if (!result) {
+            response.code = httplib_error_code(result.error());
+            response.error = curl_easy_strerror(response.code);
+        } else {
+            response.code = CURLE_OK;
+        }
+
+        // An aborted connection is in an unknown state, start over with a fresh one next time
+        if (response.code != CURLE_OK)
+            clients.erase(origin);
+
+        return response;
+    }
+
+    struct Backends {
+        CurlEasyClient curlEasy;
+        CurlMultiClient curlMulti{curlEasy};
+        HttplibClient httplib;
+        std::atomic<HttpClient *> selected{nullptr};
+    };
+
+    Backends &registry() {
+        static Backends *list = new Backends();
+        return *list;
+    }
+
+    HttpClient *find_backend(const std::string &name) {
+        Backends &list = registry();
+        HttpClient *all[] = {&list.curlMulti, &list.curlEasy, &list.httplib};
+        for (HttpClient *client : all) {
+            if (name == client->name())
+                return client;
+        }
+        return nullptr;
+    }
+}  // namespace
+
+HttpClient &HttpClient::instance() {
+    Backends &list = registry();
+    HttpClient *client = list.selected.load(std::memory_order_acquire);
+    if (client)
+        return *client;
+
+    static std::once_flag once;
+    std::call_once(once, [&list]() {
+        HttpClient *initial = &list.curlMulti;
+        const char *name = getenv(HTTP_CLIENT_BACKEND_ENV);
+        if (name && *name) {
+            if (HttpClient *named = find_backend(name)) {
+                initial = named;
+            } else {
+                obs_log(LOG_WARNING, "[HTTP Client] Unknown backend '%s', using %s", name,
+                        initial->name());
+            }
+        }
+
+        HttpClient *expected = nullptr;
+        if (list.selected.compare_exchange_strong(expected, initial))
+            obs_log(LOG_INFO, "[HTTP Client] Using the %s backend", initial->name());
+    });
+
+    return *list.selected.load(std::memory_order_acquire);
+}
+
+bool HttpClient::select(const std::string &name) {
+    HttpClient *client = find_backend(name);
+    if (!client)
+        return false;
+
+    HttpClient *previous = registry().selected.exchange(client, std::memory_order_acq_rel);
+    if (previous != client)
+        obs_log(LOG_INFO, "[HTTP Client] Switched to the %s backend", client->name());
+    return true;
+}
+
+HttpClient *HttpClient::backend(const std::string &name) {
+    return find_backend(name);
+}
+
+std::vector<std::string> HttpClient::backends() {
+    return {"curl-multi", "curl-easy", "httplib"};
+}
@@ -0,0 +1,125 @@
+/******************************************************************************
+    Copyright (C) 2024 by 17Live
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#pragma once
+
+#include <curl/curl.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "HttpEngine.hpp"
+
+// Backend used by HttpClient::instance(): "curl-multi" (default), "curl-easy" or "httplib"
+#define HTTP_CLIENT_BACKEND_ENV "OBS_17LIVE_HTTP_BACKEND"
+
+#define HTTP_CLIENT_DEFAULT_BACKEND "curl-multi"
+
+/**
+ * Blocking HTTP client, implemented by interchangeable backends:
+ *
+ * - curl-multi: HttpEngine, multiplexing concurrent requests over HTTP/2. Falls back to
+ *   curl-easy while HTTP/2 is disabled, and when a GET or HEAD fails with an HTTP/2 framing
+ *   error. Other requests are not sent twice, the server may have applied them already.
+ * - curl-easy: one transfer at a time on the calling thread's pooled easy handle.
+ * - httplib: the vendored cpp-httplib client, with one keep-alive connection per origin and
+ *   thread. It only speaks https when cpp-httplib is built with OpenSSL support and does not
+ *   report transfers to HttpMetrics.
+ *
+ * All backends honour HttpRequest::cancel, onData and onProgress, shape background transfers
+ * through TransferShaper (httplib only caps the receive speed), and report errors as CURLcodes
+ * so callers do not need to know which one served the request.
+ */
+class HttpClient {
+   public:
+    virtual ~HttpClient() = default;
+
+    virtual const char *name() const = 0;
+
+    /**
+     * Perform a request on the calling thread
+     * @param request Request to perform
+     * @return Response; code is CURLE_OK on success
+     */
+    virtual HttpResponse perform(const HttpRequest &request) = 0;
+
+    /**
+     * Backend used for all requests, initially the one named by OBS_17LIVE_HTTP_BACKEND
+     */
+    static HttpClient &instance();
+
+    /**
+     * Switch the backend used by instance(); requests already running finish on the old one
+     * @param name Backend name
+     * @return false if there is no backend with that name
+     */
+    static bool select(const std::string &name);
+
+    /**
+     * Get a backend by name, regardless of the current selection
+     * @param name Backend name
+     * @return Backend, or null if there is none with that name
+     */
+    static HttpClient *backend(const std::string &name);
+
+    /**
+     * Names of all backends
+     */
+    static std::vector<std::string> backends();
+};
+
+/**
+ * An HttpRequest applied to a libcurl easy handle. Shared by HttpEngine and the curl-easy
+ * backend so both send the same headers and options and fill HttpResponse the same way.
+ */
+class CurlTransfer {
+   public:
+    /**
+     * Set all request options on curl
+     * @param curl Easy handle, freshly created or reset
+     * @param request Request to perform, must outlive the transfer
+     */
+    CurlTransfer(CURL *curl, const HttpRequest &request);
+    ~CurlTransfer();
+
+    CURL *handle() const { return curl; }
+
+    /**
+     * Collect status, timing and error once curl finished the transfer, and record it in
+     * HttpMetrics
+     * @param result Result of the transfer
+     * @return Response, may be moved from
+     */
+    HttpResponse &finish(CURLcode result);
+
+    CurlTransfer(const CurlTransfer &) = delete;
+    CurlTransfer &operator=(const CurlTransfer &) = delete;
+
+   private:
+    static size_t writeBody(char *ptr, size_t size, size_t nmemb, void *userdata);
+    static size_t writeHeader(char *ptr, size_t size, size_t nmemb, void *userdata);
+    static int progress(void *userp, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal,
+                        curl_off_t ulnow);
+
+    CURL *curl;
+    const HttpRequest &request;
+    HttpResponse response;
+    struct curl_slist *headers = nullptr;
+    struct curl_slist *sharedTail = nullptr;  // Own node linked to request.sharedHeaders
+    char error[CURL_ERROR_SIZE];
+};
@@ -0,0 +1,185 @@
+/******************************************************************************
+    Copyright (C) 2024 by 17Live
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "HttpConnectionPool.hpp"
+
+#include <obs-module.h>
+
+#include <algorithm>
+#include <chrono>
+
+#include "DnsPrefetcher.hpp"
+#include "plugin-support.h"
+
+namespace {
+    // Per-thread easy handle, cleaned up when the owning thread exits. Live connections are
+    // kept in the shared connection cache, not in the handle, so they survive the thread.
+    struct ThreadHandle {
+        CURL* curl = nullptr;
+        std::shared_ptr<const DnsSnapshot> dns;  // kept until the handle's next transfer
+
+        ~ThreadHandle() {
+            if (curl)
+                curl_easy_cleanup(curl);
+        }
+    };
+
+    thread_local ThreadHandle threadHandle;
+}  // namespace
+
+HttpConnectionPool& HttpConnectionPool::instance() {
+    static HttpConnectionPool* pool = new HttpConnectionPool();
+    return *pool;
+}
+
+HttpConnectionPool::HttpConnectionPool() {
+    share = curl_share_init();
+    if (!share) {
+        obs_log(LOG_WARNING, "[HTTP Pool] curl_share_init failed, connections will not be shared");
+        return;
+    }
+
+    curl_share_setopt(share, CURLSHOPT_LOCKFUNC, lockShare);
+    curl_share_setopt(share, CURLSHOPT_UNLOCKFUNC, unlockShare);
+    curl_share_setopt(share, CURLSHOPT_USERDATA, this);
+    curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+#if LIBCURL_VERSION_NUM >= 0x073900
+    curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+#endif
+}
+
+void HttpConnectionPool::lockShare(CURL* handle, curl_lock_data data, curl_lock_access access,
+                                   void* userptr) {
+    (void) handle;
+    (void) access;
+    static_cast<HttpConnectionPool*>(userptr)->shareLocks[data].lock();
+}
+
+void HttpConnectionPool::unlockShare(CURL* handle, curl_lock_data data, void* userptr) {
+    (void) handle;
+    static_cast<HttpConnectionPool*>(userptr)->shareLocks[data].unlock();
+}
+
+CURL* HttpConnectionPool::acquire() {
+    if (!threadHandle.curl) {
+        threadHandle.curl = curl_easy_init();
+        if (!threadHandle.curl)
+            return nullptr;
+    } else {
+        // Reset keeps the handle's caches and live connections, but drops all options
+        curl_easy_reset(threadHandle.curl);
+    }
+
+    applyDefaults(threadHandle.curl);
+    threadHandle.dns = DnsPrefetcher::instance().apply(threadHandle.curl);
+    return threadHandle.curl;
+}
+
+CURL* HttpConnectionPool::createHandle() {
+    CURL* curl = curl_easy_init();
+    if (curl)
+        applyDefaults(curl);
+    return curl;
+}
+
+void HttpConnectionPool::attach(CURL* curl) {
+    if (share)
+        curl_easy_setopt(curl, CURLOPT_SHARE, share);
+}
+
+void HttpConnectionPool::applyDefaults(CURL* curl) {
+    attach(curl);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPIDLE, 60L);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPINTVL, 30L);
+    restrictReuse(curl);
+}
+
+static int64_t steady_ms() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+void HttpConnectionPool::invalidate() {
+    invalidatedAtMs.store(std::max<int64_t>(steady_ms(), 1), std::memory_order_relaxed);
+    invalidations.fetch_add(1, std::memory_order_release);
+}
+
+void HttpConnectionPool::restrictReuse(CURL* curl) const {
+    int64_t invalidatedAt = invalidatedAtMs.load(std::memory_order_relaxed);
+    if (!invalidatedAt)
+        return;
+
+    // Anything created before the invalidation is older than the time since then. The
+    // connection and DNS caches are shared, so there is nothing to flush: each handle just
+    // refuses the stale entries, and libcurl closes them once they sit idle long enough.
+    long since = (long) ((steady_ms() - invalidatedAt) / 1000);
+    if (since >= HTTP_POOL_INVALIDATE_WINDOW_SEC)
+        return;
+
+    // The limits count whole seconds, too coarse right after the invalidation
+#if LIBCURL_VERSION_NUM >= 0x075000
+    if (since > 0)
+        curl_easy_setopt(curl, CURLOPT_MAXLIFETIME_CONN, since);
+#elif LIBCURL_VERSION_NUM >= 0x074100
+    if (since > 0)
+        curl_easy_setopt(curl, CURLOPT_MAXAGE_CONN, since);
+#else
+    since = 0;
+#endif
+    if (since == 0)
+        curl_easy_setopt(curl, CURLOPT_FRESH_CONNECT, 1L);
+    curl_easy_setopt(curl, CURLOPT_DNS_CACHE_TIMEOUT, since);
+}
+
+uint64_t HttpConnectionPool::generation() const {
+    return invalidations.load(std::memory_order_acquire);
+}
+
+void HttpConnectionPool::recordTransfer(CURL* handle) {
+    long connects = 0;
+    if (curl_easy_getinfo(handle, CURLINFO_NUM_CONNECTS, &connects) != CURLE_OK)
+        return;
+
+    transfers.fetch_add(1, std::memory_order_relaxed);
+    if (connects == 0) {
+        reusedConnections.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        newConnections.fetch_add(static_cast<uint64_t>(connects), std::memory_order_relaxed);
+    }
+}
+
+HttpConnectionPoolStats HttpConnectionPool::stats() const {
+    HttpConnectionPoolStats result;
+    result.transfers = transfers.load(std::memory_order_relaxed);
+    result.reusedConnections = reusedConnections.load(std::memory_order_relaxed);
+    result.newConnections = newConnections.load(std::memory_order_relaxed);
+    return result;
+}
+
+void HttpConnectionPool::logStats() const {
+    HttpConnectionPoolStats s = stats();
+    double reuseRate = s.transfers ? (100.0 * s.reusedConnections / s.transfers) : 0.0;
+
+    obs_log(LOG_INFO,
+            "[HTTP Pool] transfers: %llu, reused connections: %llu (%.1f%%), new connections: "
+            "%llu",
+            (unsigned long long) s.transfers, (unsigned long long) s.reusedConnections, reuseRate,
+            (unsigned long long) s.newConnections);
+}
@@ -0,0 +1,126 @@
+/******************************************************************************
+    Copyright (C) 2024 by 17Live
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#pragma once
+
+#include <curl/curl.h>
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+// How long after invalidate() handles keep refusing older connections and DNS answers. libcurl
+// closes connections that have been idle for two minutes, so by then none of them are left.
+#define HTTP_POOL_INVALIDATE_WINDOW_SEC 120
+
+/**
+ * Connection reuse counters reported by HttpConnectionPool
+ */
+struct HttpConnectionPoolStats {
+    uint64_t transfers = 0;
+    uint64_t reusedConnections = 0;
+    uint64_t newConnections = 0;
+};
+
+/**
+ * Process-wide libcurl transport state shared by GetRemoteFile and RemoteTextThread.
+ *
+ * Every thread gets one reusable easy handle. All handles are attached to a single CURLSH
+ * that shares the DNS cache, TLS session cache and connection cache, so keep-alive
+ * connections outlive the short-lived worker threads that issue API calls.
+ */
+class HttpConnectionPool {
+   public:
+    /**
+     * Get the pool instance (created on first use, intentionally never destroyed so that
+     * handles owned by late-exiting threads can still be detached safely)
+     */
+    static HttpConnectionPool& instance();
+
+    /**
+     * Get the calling thread's easy handle, reset to default options and attached to the
+     * shared caches with TCP keep-alive enabled
+     * @return Easy handle owned by the pool, or nullptr if libcurl failed to initialize
+     */
+    CURL* acquire();
+
+    /**
+     * Create an additional easy handle attached to the shared caches, for callers that run
+     * several transfers at once on one thread (e.g. a curl_multi). Unlike acquire(), the
+     * caller owns the handle and must release it with curl_easy_cleanup.
+     * @return New easy handle, or nullptr if libcurl failed to initialize
+     */
+    CURL* createHandle();
+
+    /**
+     * Attach a handle to the shared caches again after curl_easy_reset(), which detaches it.
+     * Handles from acquire() and createHandle() are attached already.
+     */
+    void attach(CURL* curl);
+
+    /**
+     * Stop reusing connections and cached DNS answers from before now, e.g. after the network
+     * changed. Transfers already running are not interrupted.
+     */
+    void invalidate();
+
+    /**
+     * Keep a handle from reusing connections and DNS answers dropped by invalidate(). Handles
+     * from acquire() get this automatically; call it for other handles before each transfer.
+     */
+    void restrictReuse(CURL* curl) const;
+
+    /**
+     * Incremented by every invalidate(), for transports that keep connections outside libcurl
+     */
+    uint64_t generation() const;
+
+    /**
+     * Update reuse counters after a successful transfer on a handle attached to the pool
+     * @param handle The easy handle that performed the transfer
+     */
+    void recordTransfer(CURL* handle);
+
+    HttpConnectionPoolStats stats() const;
+
+    /**
+     * Write the connection reuse counters to the OBS log
+     */
+    void logStats() const;
+
+    HttpConnectionPool(const HttpConnectionPool&) = delete;
+    HttpConnectionPool& operator=(const HttpConnectionPool&) = delete;
+
+   private:
+    HttpConnectionPool();
+
+    void applyDefaults(CURL* curl);
+
+    static void lockShare(CURL* handle, curl_lock_data data, curl_lock_access access,
+                          void* userptr);
+    static void unlockShare(CURL* handle, curl_lock_data data, void* userptr);
+
+    CURLSH* share = nullptr;
+    std::mutex shareLocks[CURL_LOCK_DATA_LAST];
+
+    std::atomic<uint64_t> invalidations{0};
+    std::atomic<int64_t> invalidatedAtMs{0};  // steady_clock, 0 if never invalidated
+
+    std::atomic<uint64_t> transfers{0};
+    std::atomic<uint64_t> reusedConnections{0};
+    std::atomic<uint64_t> newConnections{0};
+};
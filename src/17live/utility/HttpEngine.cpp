@@ -0,0 +1,434 @@
+/******************************************************************************
+    Copyright (C) 2024 by 17Live
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+
+#include "HttpEngine.hpp"
+
+#include <obs-module.h>
+
+#include <algorithm>
+#include <chrono>
+#include <future>
+
+#include "DnsPrefetcher.hpp"
+#include "HttpClient.hpp"
+#include "HttpConnectionPool.hpp"
+#include "plugin-support.h"
+
+struct HttpEngine::Job {
+    HttpRequest request;
+    std::string host;
+    std::string coalesceKey;
+    Callback callback;
+    HttpResponse response;
+    CURL *easy = nullptr;
+    std::unique_ptr<CurlTransfer> transfer;
+    std::shared_ptr<const DnsSnapshot> dns;
+};
+
+HttpHeaderBlock::HttpHeaderBlock(std::vector<std::string> lines) : headerLines(std::move(lines)) {
+    for (const std::string &h : headerLines) {
+        joined += "\n";
+        joined += h;
+        slist = curl_slist_append(slist, h.c_str());
+    }
+}
+
+HttpHeaderBlock::~HttpHeaderBlock() {
+    curl_slist_free_all(slist);
+}
+
+static std::string coalesce_key(const HttpRequest &request) {
+    if ((!request.method.empty() && request.method != "GET") || !request.body.empty() ||
+        request.cancel || request.onData || request.onProgress || request.resumeFrom)
+        return std::string();
+
+    std::string key = request.url;
+    key += request.failOnError ? "\nF" : "\n-";
+    key += request.collectHeaders ? "H" : "-";
+    key += request.followRedirects ? "R" : "-";
+    key += request.transferClass == TransferClass::Background ? "B" : "-";
+    key += std::to_string(request.timeoutSec) + "/" + std::to_string(request.connectTimeoutSec) +
+           "/" + std::to_string(request.stallTimeoutSec);
+    for (const std::string &h : request.headers) {
+        key += "\n";
+        key += h;
+    }
+    if (request.sharedHeaders)
+        key += request.sharedHeaders->key();
+    return key;
+}
+
+static std::string host_of(const std::string &url) {
+    size_t start = url.find("://");
+    start = start == std::string::npos ? 0 : start + 3;
+
+    size_t end = url.find_first_of(":/?#", start);
+    return url.substr(start, end == std::string::npos ? std::string::npos : end - start);
+}
+
+static const char *http_version_name(long version) {
+    switch (version) {
+        case CURL_HTTP_VERSION_1_0:
+            return "HTTP/1.0";
+        case CURL_HTTP_VERSION_1_1:
+            return "HTTP/1.1";
+        case CURL_HTTP_VERSION_2_0:
+            return "HTTP/2";
+#if LIBCURL_VERSION_NUM >= 0x074200
+        case CURL_HTTP_VERSION_3:
+            return "HTTP/3";
+#endif
+        default:
+            return "unknown";
+    }
+}
+
+size_t ContentLengthHint(CURL *curl) {
+    curl_off_t length = -1;
+    if (curl_easy_getinfo(curl, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &length) != CURLE_OK ||
+        length <= 0)
+        return 0;
+
+    return (size_t) std::min<curl_off_t>(length, HTTP_RESPONSE_RESERVE_MAX);
+}
+
+HttpEngine &HttpEngine::instance() {
+    static HttpEngine *engine = new HttpEngine();
+    return *engine;
+}
+
+HttpEngine::HttpEngine() {
+    multi = curl_multi_init();
+    if (!multi) {
+        obs_log(LOG_ERROR, "[HTTP Engine] curl_multi_init failed");
+        stopping = true;
+        return;
+    }
+
+    curl_multi_setopt(multi, CURLMOPT_MAX_HOST_CONNECTIONS, 6L);
+    curl_multi_setopt(multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+
+    worker = std::thread(&HttpEngine::run, this);
+}
+
+void HttpEngine::submit(HttpRequest request, Callback callback) {
+    auto job = std::make_unique<Job>();
+    job->coalesceKey = coalesce_key(request);
+    job->request = std::move(request);
+    job->callback = std::move(callback);
+
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        if (!stopping) {
+            if (!job->coalesceKey.empty()) {
+                auto it = coalesced.find(job->coalesceKey);
+                if (it != coalesced.end()) {
+                    it->second.push_back(std::move(job->callback));
+                    coalescedHits.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+
+                coalesced.emplace(job->coalesceKey, std::vector<Callback>());
+                coalescedMisses.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            pending.push_back(std::move(job));
+            curl_multi_wakeup(multi);
+            return;
+        }
+    }
+
+    HttpResponse response;
+    response.code = CURLE_FAILED_INIT;
+    response.error = "HTTP engine is not running";
+    job->callback(std::move(response));
+}
+
+static HttpResponse aborted_response(const char *reason) {
+    HttpResponse response;
+    response.code = CURLE_ABORTED_BY_CALLBACK;
+    response.error = reason;
+    return response;
+}
+
+HttpResponse HttpEngine::perform(HttpRequest request) {
+    auto promise = std::make_shared<std::promise<HttpResponse>>();
+    std::future<HttpResponse> future = promise->get_future();
+    // Body and progress callbacks may reference the caller's stack, so then the transfer must
+    // have ended
+    std::shared_ptr<CancellationToken> cancel =
+        request.onData || request.onProgress ? nullptr : request.cancel;
+
+    submit(std::move(request),
+           [promise](HttpResponse &&response) { promise->set_value(std::move(response)); });
+
+    if (cancel) {
+        // The engine aborts the transfer from its progress callback; don't wait for that
+        while (future.wait_for(std::chrono::milliseconds(HTTP_ENGINE_CANCEL_POLL_MS)) !=
+               std::future_status::ready) {
+            if (cancel->isCanceled())
+                return aborted_response("Request canceled");
+        }
+    }
+
+    return future.get();
+}
+
+void HttpEngine::setHttp2Enabled(bool enabled) {
+    http2Enabled = enabled;
+}
+
+bool HttpEngine::isHttp2Enabled() const {
+    return http2Enabled;
+}
+
+void HttpEngine::setMaxConcurrent(size_t value) {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    maxConcurrent = std::max<size_t>(value, 1);
+    if (!stopping)
+        curl_multi_wakeup(multi);
+}
+
+void HttpEngine::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        if (stopping)
+            return;
+        stopping = true;
+        curl_multi_wakeup(multi);
+    }
+
+    if (worker.joinable())
+        worker.join();
+}
+
+void HttpEngine::run() {
+    for (;;) {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            if (stopping)
+                break;
+        }
+
+        startPending();
+
+        int running = 0;
+        curl_multi_perform(multi, &running);
+
+        int left = 0;
+        bool finished = false;
+        while (CURLMsg *msg = curl_multi_info_read(multi, &left)) {
+            if (msg->msg == CURLMSG_DONE) {
+                finishJob(msg->easy_handle, msg->data.result);
+                finished = true;
+            }
+        }
+
+        // A finished job frees a slot, start queued jobs before waiting again
+        if (!finished)
+            curl_multi_poll(multi, nullptr, 0, 1000, nullptr);
+    }
+
+    failAll("HTTP engine shut down");
+    logHostStats();
+
+    for (CURL *easy : idleHandles)
+        curl_easy_cleanup(easy);
+    idleHandles.clear();
+}
+
+void HttpEngine::startPending() {
+    TransferShaper &shaper = TransferShaper::instance();
+    std::vector<std::unique_ptr<Job>> starting;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        auto it = pending.begin();
+        while (it != pending.end() && activeJobs.size() + starting.size() < maxConcurrent) {
+            // Background jobs over the shaper's limit keep their place in the queue
+            if (!shaper.tryAcquire((*it)->request.transferClass)) {
+                ++it;
+                continue;
+            }
+            starting.push_back(std::move(*it));
+            it = pending.erase(it);
+        }
+    }
+
+    for (auto &job : starting) {
+        if (job->request.cancel && job->request.cancel->isCanceled()) {
+            shaper.release(job->request.transferClass);
+            job->response = aborted_response("Request canceled");
+            complete(std::move(job));
+            continue;
+        }
+
+        job->easy = takeHandle();
+        if (!job->easy) {
+            shaper.release(job->request.transferClass);
+            job->response.code = CURLE_FAILED_INIT;
+            job->response.error = curl_easy_strerror(CURLE_FAILED_INIT);
+            complete(std::move(job));
+            continue;
+        }
+
+        configure(*job);
+        curl_multi_add_handle(multi, job->easy);
+
+        HostStats &host = hostStats[job->host];
+        host.inFlight++;
+        host.peakInFlight = std::max(host.peakInFlight, host.inFlight);
+
+        activeJobs.push_back(std::move(job));
+    }
+}
+
+void HttpEngine::configure(Job &job) {
+    CURL *curl = job.easy;
+
+    job.host = host_of(job.request.url);
+    job.transfer = std::make_unique<CurlTransfer>(curl, job.request);
+
+    curl_easy_setopt(curl, CURLOPT_PRIVATE, &job);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    HttpConnectionPool::instance().restrictReuse(curl);
+    job.dns = DnsPrefetcher::instance().apply(curl);
+
+    if (http2Enabled) {
+        // Falls back to HTTP/1.1 through ALPN; PIPEWAIT lets a burst of requests to the same
+        // host wait for the first connection and share it instead of opening new ones
+        curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+        curl_easy_setopt(curl, CURLOPT_PIPEWAIT, 1L);
+    } else {
+        curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_1);
+    }
+}
+
+void HttpEngine::finishJob(CURL *easy, CURLcode result) {
+    auto it = std::find_if(activeJobs.begin(), activeJobs.end(),
+                           [easy](const std::unique_ptr<Job> &job) { return job->easy == easy; });
+    if (it == activeJobs.end())
+        return;
+
+    std::unique_ptr<Job> job = std::move(*it);
+    activeJobs.erase(it);
+
+    job->response = std::move(job->transfer->finish(result));
+
+    HostStats &host = hostStats[job->host];
+    host.inFlight--;
+    if (result == CURLE_OK) {
+        HttpConnectionPool::instance().recordTransfer(easy);
+        host.transfers++;
+        host.newConnections += (uint64_t) job->response.newConnections;
+
+        if (job->response.httpVersion && job->response.httpVersion != host.httpVersion) {
+            host.httpVersion = job->response.httpVersion;
+            obs_log(LOG_INFO, "[HTTP Engine] %s negotiated %s", job->host.c_str(),
+                    http_version_name(host.httpVersion));
+        }
+    }
+
+    curl_multi_remove_handle(multi, easy);
+    releaseHandle(easy);
+    job->transfer.reset();
+    TransferShaper::instance().release(job->request.transferClass);
+
+    complete(std::move(job));
+}
+
+void HttpEngine::complete(std::unique_ptr<Job> job) {
+    std::vector<Callback> waiters;
+    if (!job->coalesceKey.empty()) {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        auto it = coalesced.find(job->coalesceKey);
+        if (it != coalesced.end()) {
+            waiters = std::move(it->second);
+            coalesced.erase(it);
+        }
+    }
+
+    for (Callback &waiter : waiters)
+        waiter(HttpResponse(job->response));
+
+    job->callback(std::move(job->response));
+}
+
+void HttpEngine::failAll(const char *reason) {
+    std::deque<std::unique_ptr<Job>> queued;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        queued.swap(pending);
+    }
+
+    for (auto &job : activeJobs) {
+        curl_multi_remove_handle(multi, job->easy);
+        curl_easy_cleanup(job->easy);
+        job->transfer.reset();
+        TransferShaper::instance().release(job->request.transferClass);
+        queued.push_back(std::move(job));
+    }
+    activeJobs.clear();
+
+    for (auto &job : queued) {
+        job->response.code = CURLE_ABORTED_BY_CALLBACK;
+        job->response.error = reason;
+        complete(std::move(job));
+    }
+}
+
+CURL *HttpEngine::takeHandle() {
+    // Attached to the pool's DNS, TLS session and connection caches, which the blocking
+    // transfers use as well
+    if (idleHandles.empty())
+        return HttpConnectionPool::instance().createHandle();
+
+    CURL *easy = idleHandles.back();
+    idleHandles.pop_back();
+    return easy;
+}
+
+void HttpEngine::releaseHandle(CURL *easy) {
+    if (idleHandles.size() >= HTTP_ENGINE_MAX_CONCURRENT) {
+        curl_easy_cleanup(easy);
+        return;
+    }
+
+    curl_easy_reset(easy);
+    HttpConnectionPool::instance().attach(easy);
+    idleHandles.push_back(easy);
+}
+
+void HttpEngine::logHostStats() const {
+    obs_log(LOG_INFO, "[HTTP Engine] coalesced GETs: %llu joined, %llu sent",
+            (unsigned long long) coalescedHits.load(std::memory_order_relaxed),
+            (unsigned long long) coalescedMisses.load(std::memory_order_relaxed));
+
+    for (const auto &entry : hostStats) {
+        const HostStats &host = entry.second;
+        if (!host.transfers)
+            continue;
+
+        obs_log(LOG_INFO,
+                "[HTTP Engine] %s: %s, transfers: %llu, new connections: %llu, peak concurrent "
+                "streams: %zu",
+                entry.first.c_str(), http_version_name(host.httpVersion),
+                (unsigned long long) host.transfers, (unsigned long long) host.newConnections,
+                host.peakInFlight);
+    }
+}
@@ -0,0 +1,235 @@
+/******************************************************************************
+    Copyright (C) 2024 by 17Live
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+
+#pragma once
+
+#include <curl/curl.h>
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "CancellationToken.hpp"
+#include "TransferShaper.hpp"
+
+#define HTTP_ENGINE_MAX_CONCURRENT 8
+
+// How often a blocked perform() checks its cancellation token
+#define HTTP_ENGINE_CANCEL_POLL_MS 50
+
+// Upper bound for buffer capacity reserved up front from a Content-Length header
+#define HTTP_RESPONSE_RESERVE_MAX (64 * 1024 * 1024)
+
+/**
+ * Size hint for a response body, taken from the Content-Length header once it has been received.
+ * When the body is content-encoded this is the compressed size, so it is only a lower bound.
+ * @param curl Easy handle of a transfer in progress
+ * @return Number of bytes to reserve, 0 if unknown
+ */
+size_t ContentLengthHint(CURL *curl);
+
+/**
+ * Immutable header lines shared by many requests, such as the device and credential headers of
+ * every API call. The curl_slist is built once; CurlTransfer links it behind the request's own
+ * headers instead of copying it, so requests carrying the block allocate nothing for it.
+ */
+class HttpHeaderBlock {
+   public:
+    explicit HttpHeaderBlock(std::vector<std::string> lines);
+    ~HttpHeaderBlock();
+
+    const std::vector<std::string> &lines() const { return headerLines; }
+
+    /**
+     * All lines joined, for keys that must tell requests with different headers apart
+     */
+    const std::string &key() const { return joined; }
+
+    /**
+     * Prebuilt list, read concurrently by transfers and never modified
+     */
+    struct curl_slist *list() const { return slist; }
+
+    HttpHeaderBlock(const HttpHeaderBlock &) = delete;
+    HttpHeaderBlock &operator=(const HttpHeaderBlock &) = delete;
+
+   private:
+    std::vector<std::string> headerLines;
+    std::string joined;
+    struct curl_slist *slist = nullptr;
+};
+
+/**
+ * Request description accepted by HttpEngine and the HttpClient backends
+ */
+struct HttpRequest {
+    std::string url;
+    std::string method;  // Empty or "GET" for a plain GET, "HEAD" skips the body
+    std::string contentType;
+    std::string body;
+    std::vector<std::string> headers;
+    std::shared_ptr<const HttpHeaderBlock> sharedHeaders;  // Sent along with headers, may be null
+    int timeoutSec = 0;
+    int connectTimeoutSec = 0;
+    int stallTimeoutSec = 0;  // Abort once no byte arrived for this long
+    bool failOnError = true;
+    bool collectHeaders = false;  // Fill HttpResponse::headers
+    bool followRedirects = false;
+    int64_t resumeFrom = 0;  // Fetch the body from this offset, CURLE_RANGE_ERROR if unsupported
+    TransferClass transferClass = TransferClass::Interactive;  // Shaped while OBS is streaming
+    std::shared_ptr<CancellationToken> cancel;  // Aborts the transfer once canceled
+
+    // Receives the body chunk by chunk on the engine thread instead of HttpResponse::body;
+    // returning false aborts the transfer
+    std::function<bool(const char *data, size_t size)> onData;
+
+    // Called while the body is received; both counts include resumeFrom and total is 0 while
+    // unknown. Returning false aborts the transfer.
+    std::function<bool(int64_t received, int64_t total)> onProgress;
+};
+
+/**
+ * Result of a transfer performed by HttpEngine or an HttpClient backend
+ */
+struct HttpResponse {
+    CURLcode code = CURLE_FAILED_INIT;
+    long status = 0;
+    long httpVersion = 0;  // CURL_HTTP_VERSION_* actually used for the transfer
+    long newConnections = 0;  // 0 when the transfer reused a warm connection
+    double handshakeMs = 0.0;  // DNS + TCP connect + TLS
+    double totalMs = 0.0;
+    std::string body;
+    std::string error;
+    std::vector<std::string> headers;
+
+    bool ok() const { return code == CURLE_OK; }
+};
+
+/**
+ * Single event-loop HTTP engine built on curl_multi.
+ *
+ * All transfers run on one background thread. At most maxConcurrent transfers are active at a
+ * time, the rest wait in a FIFO queue. Completion callbacks are invoked on the engine thread
+ * and must not block; use RemoteRequest to get results delivered on the Qt main thread.
+ *
+ * In HTTP/2 mode (the default) transfers negotiate HTTP/2 over TLS and concurrent requests to
+ * the same host are multiplexed as streams on one connection. Servers without HTTP/2 support
+ * are served over HTTP/1.1 via ALPN.
+ *
+ * While OBS is streaming, background-class requests beyond TransferShaper's concurrency limit
+ * stay queued and interactive requests submitted after them may start first.
+ *
+ * Identical body-less GETs submitted while one is already in flight are attached to that
+ * transfer and receive a copy of its response. Requests carrying a cancellation token, a
+ * streaming body or progress callback, or a resume offset are never coalesced.
+ */
+class HttpEngine {
+   public:
+    using Callback = std::function<void(HttpResponse &&response)>;
+
+    /**
+     * Get the engine instance, the event loop is started on first use
+     */
+    static HttpEngine &instance();
+
+    /**
+     * Queue a request
+     * @param request Request to perform
+     * @param callback Invoked exactly once on the engine thread when the transfer finishes
+     */
+    void submit(HttpRequest request, Callback callback);
+
+    /**
+     * Queue a request and block until it finishes. Must not be called from the engine thread.
+     * When request.cancel is canceled the call returns CURLE_ABORTED_BY_CALLBACK right away and
+     * the transfer is aborted in the background; with request.onData set it returns once the
+     * transfer was aborted.
+     * @param request Request to perform
+     * @return Response, with code CURLE_FAILED_INIT if the engine is not running
+     */
+    HttpResponse perform(HttpRequest request);
+
+    /**
+     * Enable or disable HTTP/2 negotiation for transfers started after the call
+     */
+    void setHttp2Enabled(bool enabled);
+    bool isHttp2Enabled() const;
+
+    /**
+     * Change the number of transfers allowed to run at the same time
+     */
+    void setMaxConcurrent(size_t value);
+
+    /**
+     * Stop the event loop, failing all queued and active transfers
+     */
+    void shutdown();
+
+    HttpEngine(const HttpEngine &) = delete;
+    HttpEngine &operator=(const HttpEngine &) = delete;
+
+   private:
+    struct Job;
+
+    // Per-host protocol and concurrency bookkeeping, only touched on the engine thread
+    struct HostStats {
+        long httpVersion = 0;
+        size_t inFlight = 0;
+        size_t peakInFlight = 0;
+        uint64_t transfers = 0;
+        uint64_t newConnections = 0;
+    };
+
+    HttpEngine();
+
+    void run();
+    void startPending();
+    void finishJob(CURL *easy, CURLcode result);
+    void complete(std::unique_ptr<Job> job);
+    void failAll(const char *reason);
+    CURL *takeHandle();
+    void releaseHandle(CURL *easy);
+    void configure(Job &job);
+    void logHostStats() const;
+
+    CURLM *multi = nullptr;
+    std::thread worker;
+
+    std::mutex queueMutex;
+    std::deque<std::unique_ptr<Job>> pending;
+    size_t maxConcurrent = HTTP_ENGINE_MAX_CONCURRENT;
+    bool stopping = false;
+    std::atomic<bool> http2Enabled{true};
+
+    // Callbacks waiting on an identical in-flight GET, keyed by Job::coalesceKey
+    std::map<std::string, std::vector<Callback>> coalesced;
+    std::atomic<uint64_t> coalescedHits{0};
+    std::atomic<uint64_t> coalescedMisses{0};
+
+    // Only touched on the engine thread
+    std::vector<std::unique_ptr<Job>> activeJobs;
+    std::vector<CURL *> idleHandles;
+    std::map<std::string, HostStats> hostStats;
+};
@@ -0,0 +1,312 @@
+/******************************************************************************
+    Copyright (C) 2024 by 17Live
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+
+#include "HttpMetrics.hpp"
+
+#include <obs-module.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+
+#include "plugin-support.h"
+
+static std::string host_of(const std::string &url) {
+    size_t start = url.find("://");
+    start = start == std::string::npos ? 0 : start + 3;
+
+    size_t end = url.find_first_of(":/?#", start);
+    return url.substr(start, end == std::string::npos ? std::string::npos : end - start);
+}
+
+static uint32_t to_us(curl_off_t value) {
+    if (value <= 0)
+        return 0;
+    return (uint32_t) std::min<curl_off_t>(value, UINT32_MAX);
+}
+
+static size_t bucket_of(uint32_t us) {
+    size_t bucket = (size_t) (HTTP_METRICS_BUCKETS_PER_OCTAVE * std::log2((double) us + 1.0));
+    return std::min<size_t>(bucket, HTTP_METRICS_BUCKETS - 1);
+}
+
+static double bucket_upper_ms(size_t bucket) {
+    return (std::exp2((double) (bucket + 1) / HTTP_METRICS_BUCKETS_PER_OCTAVE) - 1.0) / 1000.0;
+}
+
+static double percentile_ms(const std::vector<uint32_t> &sorted, double p) {
+    if (sorted.empty())
+        return 0.0;
+    size_t index = (size_t) std::ceil(p * sorted.size()) - 1;
+    return sorted[std::min(index, sorted.size() - 1)] / 1000.0;
+}
+
+HttpMetrics &HttpMetrics::instance() {
+    static HttpMetrics *metrics = new HttpMetrics();
+    return *metrics;
+}
+
+void HttpMetrics::registerEndpoint(const std::string &urlTemplate) {
+    std::vector<std::string> pieces;
+    size_t start = 0;
+    for (size_t i = 0; i < urlTemplate.size(); i++) {
+        if (urlTemplate[i] == '%' && i + 1 < urlTemplate.size() &&
+            isdigit((unsigned char) urlTemplate[i + 1])) {
+            pieces.push_back(urlTemplate.substr(start, i - start));
+            start = i + 2;
+            i++;
+        }
+    }
+    pieces.push_back(urlTemplate.substr(start));
+
+    // Display the path only, the host is the same for every API endpoint
+    std::string name = urlTemplate;
+    size_t scheme = name.find("://");
+    if (scheme != std::string::npos) {
+        size_t path = name.find('/', scheme + 3);
+        if (path != std::string::npos)
+            name = name.substr(path);
+    }
+
+    publish(name, std::move(pieces), false);
+}
+
+HttpMetrics::Endpoint *HttpMetrics::publish(const std::string &name,
+                                            std::vector<std::string> pieces, bool isHost) {
+    std::lock_guard<std::mutex> lock(publishMutex);
+
+    size_t count = endpointCount.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < count; i++) {
+        if (endpoints[i].name == name && endpoints[i].isHost == isHost)
+            return &endpoints[i];
+    }
+
+    if (count == HTTP_METRICS_MAX_ENDPOINTS) {
+        obs_log(LOG_WARNING, "[HTTP Metrics] Endpoint table full, not tracking %s", name.c_str());
+        return nullptr;
+    }
+
+    Endpoint &endpoint = endpoints[count];
+    endpoint.name = name;
+    endpoint.pieces = std::move(pieces);
+    endpoint.literalLength = 0;
+    for (const std::string &piece : endpoint.pieces)
+        endpoint.literalLength += piece.size();
+    endpoint.isHost = isHost;
+    endpointCount.store(count + 1, std::memory_order_release);
+    return &endpoint;
+}
+
+bool HttpMetrics::matches(const Endpoint &endpoint, const std::string &url) {
+    const std::vector<std::string> &pieces = endpoint.pieces;
+    if (url.compare(0, pieces[0].size(), pieces[0]) != 0)
+        return false;
+
+    size_t pos = pieces[0].size();
+    for (size_t i = 1; i < pieces.size(); i++) {
+        // A placeholder matches a non-empty value that does not cross a path or query boundary
+        size_t end = url.find_first_of("/?&#", pos);
+        if (end == std::string::npos)
+            end = url.size();
+        if (end == pos)
+            return false;
+
+        // Take the shortest value after which the following literal matches, or the whole
+        // value if the template ends with the placeholder
+        const std::string &literal = pieces[i];
+        size_t valueEnd = literal.empty() ? end : pos + 1;
+        bool found = false;
+        for (; valueEnd <= end; valueEnd++) {
+            if (url.compare(valueEnd, literal.size(), literal) == 0) {
+                found = true;
+                break;
+            }
+        }
+        if (!found)
+            return false;
+
+        pos = valueEnd + literal.size();
+    }
+
+    // Extra query parameters appended to the template are allowed
+    return pos == url.size() || url[pos] == '?' || url[pos] == '&';
+}
+
+HttpMetrics::Endpoint *HttpMetrics::find(const std::string &url, const std::string &host) {
+    // Prefer the most specific template when several match
+    size_t count = endpointCount.load(std::memory_order_acquire);
+    Endpoint *best = nullptr;
+    for (size_t i = 0; i < count; i++) {
+        if (!endpoints[i].isHost && matches(endpoints[i], url) &&
+            (!best || endpoints[i].literalLength > best->literalLength))
+            best = &endpoints[i];
+    }
+    if (best)
+        return best;
+
+    for (size_t i = 0; i < count; i++) {
+        if (endpoints[i].isHost && endpoints[i].name == host)
+            return &endpoints[i];
+    }
+
+    return publish(host, {}, true);
+}
+
+std::string HttpMetrics::endpointName(const std::string &url) {
+    std::string host = host_of(url);
+    Endpoint *endpoint = find(url, host);
+    return endpoint ? endpoint->name : host;
+}
+
+double HttpMetrics::recentPercentile(const std::string &url, double p, size_t minSamples) {
+    Endpoint *endpoint = find(url, host_of(url));
+    if (!endpoint)
+        return -1.0;
+
+    size_t samples = (size_t) std::min<uint64_t>(endpoint->next.load(std::memory_order_relaxed),
+                                                 HTTP_METRICS_RING_SIZE);
+    if (samples == 0 || samples < minSamples)
+        return -1.0;
+
+    std::vector<uint32_t> total;
+    total.reserve(samples);
+    for (size_t s = 0; s < samples; s++)
+        total.push_back(endpoint->ring[s].total.load(std::memory_order_relaxed));
+    std::sort(total.begin(), total.end());
+    return percentile_ms(total, p);
+}
+
+void HttpMetrics::record(CURL *curl, const std::string &url, CURLcode result) {
+    Endpoint *endpoint = find(url, host_of(url));
+    if (!endpoint)
+        return;
+
+    curl_off_t nameLookup = 0, connect = 0, appConnect = 0, startTransfer = 0, total = 0;
+    curl_off_t down = 0, up = 0;
+    long connects = 0;
+    curl_easy_getinfo(curl, CURLINFO_NAMELOOKUP_TIME_T, &nameLookup);
+    curl_easy_getinfo(curl, CURLINFO_CONNECT_TIME_T, &connect);
+    curl_easy_getinfo(curl, CURLINFO_APPCONNECT_TIME_T, &appConnect);
+    curl_easy_getinfo(curl, CURLINFO_STARTTRANSFER_TIME_T, &startTransfer);
+    curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME_T, &total);
+    curl_easy_getinfo(curl, CURLINFO_SIZE_DOWNLOAD_T, &down);
+    curl_easy_getinfo(curl, CURLINFO_SIZE_UPLOAD_T, &up);
+    curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &connects);
+
+    endpoint->requests.fetch_add(1, std::memory_order_relaxed);
+    if (result != CURLE_OK)
+        endpoint->errors.fetch_add(1, std::memory_order_relaxed);
+    endpoint->bytesDown.fetch_add((uint64_t) std::max<curl_off_t>(down, 0),
+                                  std::memory_order_relaxed);
+    endpoint->bytesUp.fetch_add((uint64_t) std::max<curl_off_t>(up, 0), std::memory_order_relaxed);
+
+    // libcurl reports cumulative times since the start of the transfer, store each phase
+    curl_off_t handshakeDone = appConnect > 0 ? appConnect : connect;
+    Sample &sample = endpoint->ring[endpoint->next.fetch_add(1, std::memory_order_relaxed) %
+                                    HTTP_METRICS_RING_SIZE];
+    sample.dns.store(to_us(nameLookup), std::memory_order_relaxed);
+    sample.connect.store(to_us(connect - nameLookup), std::memory_order_relaxed);
+    sample.tls.store(appConnect > 0 ? to_us(appConnect - connect) : 0, std::memory_order_relaxed);
+    sample.server.store(startTransfer > 0 ? to_us(startTransfer - handshakeDone) : 0,
+                        std::memory_order_relaxed);
+    sample.total.store(to_us(total), std::memory_order_relaxed);
+
+    endpoint->histogram[bucket_of(to_us(total))].fetch_add(1, std::memory_order_relaxed);
+
+    if (result == CURLE_OK) {
+        bool cold = connects > 0;
+        (cold ? endpoint->coldRequests : endpoint->warmRequests)
+            .fetch_add(1, std::memory_order_relaxed);
+        (cold ? endpoint->coldTotalUs : endpoint->warmTotalUs)
+            .fetch_add(to_us(total), std::memory_order_relaxed);
+    }
+}
+
+void HttpMetrics::logSummary() const {
+    size_t count = endpointCount.load(std::memory_order_acquire);
+    obs_log(LOG_INFO, "[HTTP Metrics] ---- network statistics ----");
+
+    for (size_t i = 0; i < count; i++) {
+        const Endpoint &endpoint = endpoints[i];
+        uint64_t requests = endpoint.requests.load(std::memory_order_relaxed);
+        if (!requests)
+            continue;
+
+        // Recent samples from the ring buffer
+        size_t samples =
+            (size_t) std::min<uint64_t>(endpoint.next.load(std::memory_order_relaxed),
+                                        HTTP_METRICS_RING_SIZE);
+        std::vector<uint32_t> dns, connect, tls, server, total;
+        for (size_t s = 0; s < samples; s++) {
+            const Sample &sample = endpoint.ring[s];
+            dns.push_back(sample.dns.load(std::memory_order_relaxed));
+            connect.push_back(sample.connect.load(std::memory_order_relaxed));
+            tls.push_back(sample.tls.load(std::memory_order_relaxed));
+            server.push_back(sample.server.load(std::memory_order_relaxed));
+            total.push_back(sample.total.load(std::memory_order_relaxed));
+        }
+        for (auto *values : {&dns, &connect, &tls, &server, &total})
+            std::sort(values->begin(), values->end());
+
+        // Lifetime percentiles from the histogram, reported as bucket upper bounds
+        uint64_t histogramTotal = 0;
+        for (const auto &bucket : endpoint.histogram)
+            histogramTotal += bucket.load(std::memory_order_relaxed);
+
+        double lifetime[3] = {0.0, 0.0, 0.0};
+        const double targets[3] = {0.50, 0.95, 0.99};
+        uint64_t seen = 0;
+        size_t next = 0;
+        for (size_t b = 0; b < HTTP_METRICS_BUCKETS && next < 3; b++) {
+            seen += endpoint.histogram[b].load(std::memory_order_relaxed);
+            while (next < 3 && seen >= (uint64_t) std::ceil(targets[next] * histogramTotal) &&
+                   seen > 0) {
+                lifetime[next++] = bucket_upper_ms(b);
+            }
+        }
+
+        obs_log(LOG_INFO,
+                "[HTTP Metrics] %s%s: %llu requests, %llu errors, %.1f KB in, %.1f KB out",
+                endpoint.isHost ? "host " : "", endpoint.name.c_str(),
+                (unsigned long long) requests,
+                (unsigned long long) endpoint.errors.load(std::memory_order_relaxed),
+                endpoint.bytesDown.load(std::memory_order_relaxed) / 1024.0,
+                endpoint.bytesUp.load(std::memory_order_relaxed) / 1024.0);
+        obs_log(LOG_INFO,
+                "[HTTP Metrics]   last %zu: total p50 %.1f ms, p95 %.1f ms, p99 %.1f ms | "
+                "p50 dns %.1f ms, connect %.1f ms, tls %.1f ms, server %.1f ms",
+                samples, percentile_ms(total, 0.50), percentile_ms(total, 0.95),
+                percentile_ms(total, 0.99), percentile_ms(dns, 0.50),
+                percentile_ms(connect, 0.50), percentile_ms(tls, 0.50),
+                percentile_ms(server, 0.50));
+        obs_log(LOG_INFO,
+                "[HTTP Metrics]   since start: total p50 <= %.1f ms, p95 <= %.1f ms, p99 <= %.1f "
+                "ms",
+                lifetime[0], lifetime[1], lifetime[2]);
+
+        uint64_t cold = endpoint.coldRequests.load(std::memory_order_relaxed);
+        uint64_t warm = endpoint.warmRequests.load(std::memory_order_relaxed);
+        obs_log(LOG_INFO,
+                "[HTTP Metrics]   cold connection: %llu requests, mean %.1f ms | warm "
+                "connection: %llu requests, mean %.1f ms",
+                (unsigned long long) cold,
+                cold ? endpoint.coldTotalUs.load(std::memory_order_relaxed) / 1000.0 / cold : 0.0,
+                (unsigned long long) warm,
+                warm ? endpoint.warmTotalUs.load(std::memory_order_relaxed) / 1000.0 / warm : 0.0);
+    }
+}
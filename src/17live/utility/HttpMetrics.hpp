@@ -0,0 +1,127 @@
+/******************************************************************************
+    Copyright (C) 2024 by 17Live
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+
+#pragma once
+
+#include <curl/curl.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#define HTTP_METRICS_MAX_ENDPOINTS 64
+#define HTTP_METRICS_RING_SIZE 256
+// Four buckets per power of two of microseconds, the last bucket collects everything slower
+#define HTTP_METRICS_BUCKETS_PER_OCTAVE 4
+#define HTTP_METRICS_BUCKETS 112
+
+/**
+ * Per-endpoint network timing collected from libcurl transfers.
+ *
+ * Transfers are grouped by logical endpoint: URL templates registered with registerEndpoint(),
+ * where "%1", "%2", ... match one path or query value. Requests that match no template are
+ * grouped by host. Recording is lock-free; each endpoint keeps a ring buffer of the most recent
+ * phase timings, a log-scale histogram of total time since startup, and the mean total time of
+ * transfers on new (cold) versus reused (warm) connections.
+ */
+class HttpMetrics {
+   public:
+    static HttpMetrics &instance();
+
+    /**
+     * Register a logical endpoint
+     * @param urlTemplate Full URL with %N placeholders, as used with QString::arg()
+     */
+    void registerEndpoint(const std::string &urlTemplate);
+
+    /**
+     * Record timings and byte counts of a finished transfer
+     * @param curl Easy handle that performed the transfer
+     * @param url Requested URL
+     * @param result Transfer result
+     */
+    void record(CURL *curl, const std::string &url, CURLcode result);
+
+    /**
+     * Logical endpoint a URL is grouped under
+     * @return Path of the matching template, or the host if none matches
+     */
+    std::string endpointName(const std::string &url);
+
+    /**
+     * Percentile of the total time of recent transfers to the endpoint a URL is grouped under
+     * @param p Percentile as a fraction, e.g. 0.95
+     * @param minSamples Number of recent transfers needed for a meaningful value
+     * @return Milliseconds, or a negative value if fewer than minSamples transfers were recorded
+     */
+    double recentPercentile(const std::string &url, double p, size_t minSamples);
+
+    /**
+     * Write request counts, byte counts and p50/p95/p99 latency of every endpoint to the OBS log
+     */
+    void logSummary() const;
+
+    HttpMetrics(const HttpMetrics &) = delete;
+    HttpMetrics &operator=(const HttpMetrics &) = delete;
+
+   private:
+    // Phase durations of one transfer in microseconds
+    struct Sample {
+        std::atomic<uint32_t> dns{0};
+        std::atomic<uint32_t> connect{0};
+        std::atomic<uint32_t> tls{0};
+        std::atomic<uint32_t> server{0};
+        std::atomic<uint32_t> total{0};
+    };
+
+    struct Endpoint {
+        // Immutable once the endpoint is published through endpointCount
+        std::string name;
+        std::vector<std::string> pieces;  // Literal parts between placeholders
+        size_t literalLength = 0;
+        bool isHost = false;
+
+        std::atomic<uint64_t> requests{0};
+        std::atomic<uint64_t> errors{0};
+        std::atomic<uint64_t> bytesDown{0};
+        std::atomic<uint64_t> bytesUp{0};
+
+        // Total time split by whether the transfer had to open a new connection
+        std::atomic<uint64_t> coldRequests{0};
+        std::atomic<uint64_t> coldTotalUs{0};
+        std::atomic<uint64_t> warmRequests{0};
+        std::atomic<uint64_t> warmTotalUs{0};
+
+        std::atomic<uint64_t> next{0};
+        std::array<Sample, HTTP_METRICS_RING_SIZE> ring;
+        std::array<std::atomic<uint64_t>, HTTP_METRICS_BUCKETS> histogram{};
+    };
+
+    HttpMetrics() = default;
+
+    Endpoint *find(const std::string &url, const std::string &host);
+    Endpoint *publish(const std::string &name, std::vector<std::string> pieces, bool isHost);
+    static bool matches(const Endpoint &endpoint, const std::string &url);
+
+    std::array<Endpoint, HTTP_METRICS_MAX_ENDPOINTS> endpoints;
+    std::atomic<size_t> endpointCount{0};
+    std::mutex publishMutex;
+};
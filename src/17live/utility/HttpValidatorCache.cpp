@@ -0,0 +1,266 @@
+/******************************************************************************
+    Copyright (C) 2024 by 17Live
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+
+#include "HttpValidatorCache.hpp"
+
+#include <obs-module.h>
+
+#include <atomic>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <sstream>
+
+#include "plugin-support.h"
+
+using Json = nlohmann::json;
+
+static uint64_t fnv1a(const std::string &str) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : str) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static bool starts_with_nocase(const std::string &str, const char *prefix) {
+    size_t i = 0;
+    for (; prefix[i]; i++) {
+        if (i >= str.size() || tolower((unsigned char) str[i]) != tolower((unsigned char) prefix[i]))
+            return false;
+    }
+    return true;
+}
+
+static std::string header_value(const std::vector<std::string> &headers, const char *name) {
+    std::string prefix = std::string(name) + ":";
+
+    // With redirects the list holds several responses, the last match belongs to the final one
+    std::string value;
+    for (const std::string &h : headers) {
+        if (!starts_with_nocase(h, prefix.c_str()))
+            continue;
+
+        size_t start = h.find_first_not_of(' ', prefix.size());
+        value = start == std::string::npos ? std::string() : h.substr(start);
+    }
+    return value;
+}
+
+static bool write_file(const std::string &path, const std::string &data) {
+    // Write to a temporary file first so a crash never leaves a truncated entry behind
+    std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!out.is_open())
+            return false;
+        out.write(data.data(), (std::streamsize) data.size());
+        if (!out.good())
+            return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmp, path, ec);
+    return !ec;
+}
+
+HttpValidatorCache &HttpValidatorCache::instance() {
+    static HttpValidatorCache *cache = new HttpValidatorCache();
+    return *cache;
+}
+
+void HttpValidatorCache::setDirectory(const std::string &path) {
+    std::error_code ec;
+    std::filesystem::create_directories(path, ec);
+    if (ec) {
+        obs_log(LOG_WARNING, "[HTTP Cache] Cannot create %s: %s", path.c_str(),
+                ec.message().c_str());
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    directory = path;
+    validators.clear();
+}
+
+std::string HttpValidatorCache::keyFor(const std::string &url,
+                                       const std::vector<std::string> &headers) {
+    std::string key = url;
+    for (const std::string &h : headers) {
+        if (starts_with_nocase(h, "Authorization:"))
+            continue;
+        key += "\n";
+        key += h;
+    }
+    return key;
+}
+
+std::string HttpValidatorCache::fileFor(const std::string &key, const char *extension) const {
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.%s", (unsigned long long) fnv1a(key), extension);
+    return directory + "/" + name;
+}
+
+bool HttpValidatorCache::lookup(const std::string &key, HttpValidator &validator) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (directory.empty())
+        return false;
+
+    auto it = validators.find(key);
+    if (it != validators.end()) {
+        validator = it->second;
+        return true;
+    }
+
+    std::ifstream in(fileFor(key, "meta"), std::ios::in | std::ios::binary);
+    if (!in.is_open())
+        return false;
+
+    try {
+        Json meta = Json::parse(in);
+        // Guard against hash collisions
+        if (meta.value("key", "") != key)
+            return false;
+
+        validator.etag = meta.value("etag", "");
+        validator.lastModified = meta.value("lastModified", "");
+    } catch (const Json::exception &e) {
+        obs_log(LOG_WARNING, "[HTTP Cache] Ignoring corrupt entry: %s", e.what());
+        return false;
+    }
+
+    validators[key] = validator;
+    return true;
+}
+
+bool HttpValidatorCache::loadBody(const std::string &key, std::string &body) {
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (directory.empty())
+            return false;
+        path = fileFor(key, "body");
+    }
+
+    std::ifstream in(path, std::ios::in | std::ios::binary);
+    if (!in.is_open())
+        return false;
+
+    std::ostringstream data;
+    data << in.rdbuf();
+    body = data.str();
+    return true;
+}
+
+bool HttpValidatorCache::writeMeta(const std::string &key, const HttpValidator &validator) {
+    Json meta;
+    meta["key"] = key;
+    meta["etag"] = validator.etag;
+    meta["lastModified"] = validator.lastModified;
+    return write_file(fileFor(key, "meta"),
+                      meta.dump(-1, ' ', false, Json::error_handler_t::replace));
+}
+
+void HttpValidatorCache::store(const std::string &key,
+                               const std::vector<std::string> &responseHeaders,
+                               const std::string &body) {
+    HttpValidator validator;
+    validator.etag = header_value(responseHeaders, "ETag");
+    validator.lastModified = header_value(responseHeaders, "Last-Modified");
+    if (validator.etag.empty() && validator.lastModified.empty())
+        return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (directory.empty())
+        return;
+
+    // Body first: a meta file must never point at a missing or older body
+    if (!write_file(fileFor(key, "body"), body) || !writeMeta(key, validator)) {
+        obs_log(LOG_WARNING, "[HTTP Cache] Failed to store response for %s",
+                key.substr(0, key.find('\n')).c_str());
+        return;
+    }
+
+    validators[key] = validator;
+}
+
+std::unique_ptr<HttpValidatorCache::StreamedBody>
+HttpValidatorCache::beginBody(const std::string &key) {
+    // Concurrent requests for the same key each write their own file
+    static std::atomic<uint64_t> counter{0};
+
+    std::unique_ptr<StreamedBody> body = std::make_unique<StreamedBody>();
+    body->key = key;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (directory.empty())
+            return nullptr;
+        body->path = fileFor(key, "body") + "." + std::to_string(++counter) + ".part";
+    }
+
+    body->out.open(body->path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!body->out.is_open())
+        return nullptr;
+    return body;
+}
+
+void HttpValidatorCache::store(StreamedBody &body,
+                               const std::vector<std::string> &responseHeaders) {
+    HttpValidator validator;
+    validator.etag = header_value(responseHeaders, "ETag");
+    validator.lastModified = header_value(responseHeaders, "Last-Modified");
+    if (validator.etag.empty() && validator.lastModified.empty())
+        return;
+
+    body.out.close();
+    if (body.out.fail())
+        return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (directory.empty())
+        return;
+
+    std::error_code ec;
+    std::filesystem::rename(body.path, fileFor(body.key, "body"), ec);
+    if (ec || !writeMeta(body.key, validator)) {
+        obs_log(LOG_WARNING, "[HTTP Cache] Failed to store response for %s",
+                body.key.substr(0, body.key.find('\n')).c_str());
+        return;
+    }
+
+    body.path.clear();
+    validators[body.key] = validator;
+}
+
+HttpValidatorCache::StreamedBody::~StreamedBody() {
+    if (path.empty())
+        return;
+
+    out.close();
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+}
+
+void HttpValidatorCache::StreamedBody::write(const char *data, size_t size) {
+    if (out.good())
+        out.write(data, (std::streamsize) size);
+}
@@ -0,0 +1,124 @@
+/******************************************************************************
+    Copyright (C) 2024 by 17Live
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+
+#pragma once
+
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * Validators of a cached response
+ */
+struct HttpValidator {
+    std::string etag;
+    std::string lastModified;
+};
+
+/**
+ * On-disk cache of ETag / Last-Modified validators and the matching response bodies.
+ *
+ * GetRemoteFile uses it to turn GETs into conditional requests and to serve the stored body when
+ * the server answers 304 Not Modified. Each entry is a pair of files in the cache directory:
+ * "<hash>.meta" with the validators and "<hash>.body" with the raw body.
+ *
+ * Keys leave out the Authorization header, so the cache is shared by every account on the
+ * machine; only enable it for responses that do not depend on who asks.
+ */
+class HttpValidatorCache {
+   public:
+    static HttpValidatorCache &instance();
+
+    /**
+     * Set the cache directory (created if missing); the cache is disabled until this is called
+     */
+    void setDirectory(const std::string &path);
+
+    /**
+     * Build the cache key of a request. Authorization headers are left out so that entries
+     * survive token changes.
+     */
+    static std::string keyFor(const std::string &url, const std::vector<std::string> &headers);
+
+    /**
+     * Get the validators stored for a key
+     * @return false if there is no usable entry
+     */
+    bool lookup(const std::string &key, HttpValidator &validator);
+
+    /**
+     * Read the body stored for a key
+     */
+    bool loadBody(const std::string &key, std::string &body);
+
+    /**
+     * Store a 200 response if it carries an ETag or Last-Modified header
+     * @param responseHeaders Raw response header lines
+     */
+    void store(const std::string &key, const std::vector<std::string> &responseHeaders,
+               const std::string &body);
+
+    /**
+     * Body of a response written to a temporary file chunk by chunk as it is received, so that
+     * streamed responses are cached without holding their body in memory. The file is removed
+     * unless store() keeps it.
+     */
+    class StreamedBody {
+       public:
+        ~StreamedBody();
+
+        /**
+         * Append the next chunk; failures only keep the body from being stored
+         */
+        void write(const char *data, size_t size);
+
+       private:
+        friend class HttpValidatorCache;
+
+        std::string key;
+        std::string path;
+        std::ofstream out;
+    };
+
+    /**
+     * Start writing the body of a response that may be stored for a key
+     * @return null while the cache is disabled
+     */
+    std::unique_ptr<StreamedBody> beginBody(const std::string &key);
+
+    /**
+     * Store a streamed 200 response if it carries an ETag or Last-Modified header
+     */
+    void store(StreamedBody &body, const std::vector<std::string> &responseHeaders);
+
+    HttpValidatorCache(const HttpValidatorCache &) = delete;
+    HttpValidatorCache &operator=(const HttpValidatorCache &) = delete;
+
+   private:
+    HttpValidatorCache() = default;
+
+    std::string fileFor(const std::string &key, const char *extension) const;
+    bool writeMeta(const std::string &key, const HttpValidator &validator);
+
+    std::mutex mutex;
+    std::string directory;
+    std::map<std::string, HttpValidator> validators;
+};
@@ -0,0 +1,475 @@
+/******************************************************************************
+    Copyright (C) 2024 by 17Live
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "JsonStreamParser.hpp"
+
+using Json = nlohmann::json;
+
+static bool is_whitespace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static bool is_number_char(char c) {
+    return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+}
+
+static int hex_digit(char c) {
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+static void append_utf8(std::string &out, uint32_t codepoint) {
+    if (codepoint < 0x80) {
+        out += (char) codepoint;
+    } else if (codepoint < 0x800) {
+        out += (char) (0xC0 | (codepoint >> 6));
+        out += (char) (0x80 | (codepoint & 0x3F));
+    } else if (codepoint < 0x10000) {
+        out += (char) (0xE0 | (codepoint >> 12));
+        out += (char) (0x80 | ((codepoint >> 6) & 0x3F));
+        out += (char) (0x80 | (codepoint & 0x3F));
+    } else {
+        out += (char) (0xF0 | (codepoint >> 18));
+        out += (char) (0x80 | ((codepoint >> 12) & 0x3F));
+        out += (char) (0x80 | ((codepoint >> 6) & 0x3F));
+        out += (char) (0x80 | (codepoint & 0x3F));
+    }
+}
+
+// Same rules as nlohmann::json: no overlong forms, surrogates or code points above U+10FFFF
+static bool is_valid_utf8(const std::string &str) {
+    size_t i = 0;
+    size_t size = str.size();
+    while (i < size) {
+        unsigned char c = (unsigned char) str[i];
+        if (c < 0x80) {
+            i++;
+            continue;
+        }
+
+        size_t length;
+        unsigned char min = 0x80, max = 0xBF;
+        if (c >= 0xC2 && c <= 0xDF) {
+            length = 2;
+        } else if (c >= 0xE0 && c <= 0xEF) {
+            length = 3;
+            if (c == 0xE0)
+                min = 0xA0;
+            else if (c == 0xED)
+                max = 0x9F;
+        } else if (c >= 0xF0 && c <= 0xF4) {
+            length = 4;
+            if (c == 0xF0)
+                min = 0x90;
+            else if (c == 0xF4)
+                max = 0x8F;
+        } else {
+            return false;
+        }
+
+        if (size - i < length)
+            return false;
+        unsigned char second = (unsigned char) str[i + 1];
+        if (second < min || second > max)
+            return false;
+        for (size_t k = 2; k < length; k++) {
+            if (((unsigned char) str[i + k] & 0xC0) != 0x80)
+                return false;
+        }
+        i += length;
+    }
+    return true;
+}
+
+bool JsonStreamParser::feed(const char *data, size_t size) {
+    if (finished)
+        return false;
+
+    size_t base = fed;
+    fed += size;
+
+    size_t i = 0;
+    while (i < size && state != State::Failed) {
+        position = base + i;
+        char c = data[i];
+
+        // Inside a token
+        switch (state) {
+        case State::String:
+            i += parseString(data + i, size - i);
+            continue;
+        case State::Escape:
+            parseEscape(c);
+            i++;
+            continue;
+        case State::Unicode:
+            parseUnicode(c);
+            i++;
+            continue;
+        case State::LowBackslash:
+            if (c == '\\')
+                state = State::LowU;
+            else
+                fail("expected the low surrogate of a \\u escape");
+            i++;
+            continue;
+        case State::LowU:
+            if (c == 'u') {
+                unicode = 0;
+                unicodeDigits = 0;
+                state = State::Unicode;
+            } else {
+                fail("expected the low surrogate of a \\u escape");
+            }
+            i++;
+            continue;
+        case State::Number:
+            if (is_number_char(c)) {
+                token += c;
+                i++;
+            } else {
+                endNumber();  // c is looked at again in the next state
+            }
+            continue;
+        case State::Literal:
+            if (c >= 'a' && c <= 'z' && token.size() < 5) {
+                token += c;
+                i++;
+            } else {
+                endLiteral();
+            }
+            continue;
+        default:
+            break;
+        }
+
+        // A UTF-8 byte order mark is skipped, as nlohmann::json does
+        if (position < 3 && bomLength == position && state == State::Value && stack.empty()) {
+            if (c == "\xEF\xBB\xBF"[position]) {
+                bomLength++;
+                i++;
+                continue;
+            }
+            if (bomLength) {
+                fail("incomplete byte order mark");
+                continue;
+            }
+        }
+
+        i++;
+        if (is_whitespace(c))
+            continue;
+
+        switch (state) {
+        case State::ArrayFirst:
+            if (c == ']') {
+                endContainer(c);
+                break;
+            }
+            beginValue(c);
+            break;
+        case State::Value:
+            beginValue(c);
+            break;
+        case State::ObjectFirst:
+            if (c == '}') {
+                endContainer(c);
+                break;
+            }
+            [[fallthrough]];
+        case State::Key:
+            if (c == '"') {
+                token.clear();
+                tokenIsKey = true;
+                state = State::String;
+            } else {
+                fail("expected a member name");
+            }
+            break;
+        case State::Colon:
+            if (c == ':')
+                state = State::Value;
+            else
+                fail("expected ':'");
+            break;
+        case State::Next:
+            if (c == ',')
+                state = stack.back().value.is_object() ? State::Key : State::Value;
+            else if (c == ']' || c == '}')
+                endContainer(c);
+            else
+                fail("expected ',' or the end of an array or object");
+            break;
+        case State::Done:
+            fail("unexpected data after the document");
+            break;
+        default:
+            break;
+        }
+    }
+    return true;
+}
+
+bool JsonStreamParser::finish(nlohmann::json &json, std::string &error) {
+    finished = true;
+
+    // A number or literal is only complete once something follows it
+    position = fed;
+    if (state == State::Number)
+        endNumber();
+    else if (state == State::Literal)
+        endLiteral();
+
+    if (state != State::Done && state != State::Failed)
+        fail("unexpected end of input");
+    if (state == State::Failed) {
+        error = failure;
+        return false;
+    }
+
+    json = std::move(root);
+    root = nullptr;
+    return true;
+}
+
+void JsonStreamParser::beginValue(char c) {
+    switch (c) {
+    case '{':
+        stack.push_back(Frame{Json::object(), std::string()});
+        state = State::ObjectFirst;
+        break;
+    case '[':
+        stack.push_back(Frame{Json::array(), std::string()});
+        state = State::ArrayFirst;
+        break;
+    case '"':
+        token.clear();
+        tokenIsKey = false;
+        state = State::String;
+        break;
+    case 't':
+    case 'f':
+    case 'n':
+        token.assign(1, c);
+        state = State::Literal;
+        break;
+    default:
+        if (c == '-' || (c >= '0' && c <= '9')) {
+            token.assign(1, c);
+            state = State::Number;
+        } else {
+            fail("unexpected character");
+        }
+        break;
+    }
+}
+
+size_t JsonStreamParser::parseString(const char *data, size_t size) {
+    // Copy runs of plain characters at once
+    size_t i = 0;
+    while (i < size) {
+        unsigned char c = (unsigned char) data[i];
+        if (c == '"' || c == '\\' || c < 0x20)
+            break;
+        i++;
+    }
+    token.append(data, i);
+    if (i == size)
+        return i;
+
+    char c = data[i];
+    if (c == '"')
+        endString();
+    else if (c == '\\')
+        state = State::Escape;
+    else {
+        position += i;
+        fail("control character in string");
+    }
+    return i + 1;
+}
+
+void JsonStreamParser::parseEscape(char c) {
+    state = State::String;
+    switch (c) {
+    case '"':
+    case '\\':
+    case '/':
+        token += c;
+        break;
+    case 'b':
+        token += '\b';
+        break;
+    case 'f':
+        token += '\f';
+        break;
+    case 'n':
+        token += '\n';
+        break;
+    case 'r':
+        token += '\r';
+        break;
+    case 't':
+        token += '\t';
+        break;
+    case 'u':
+        unicode = 0;
+        unicodeDigits = 0;
+        state = State::Unicode;
+        break;
+    default:
+        fail("invalid escape in string");
+        break;
+    }
+}
+
+void JsonStreamParser::parseUnicode(char c) {
+    int digit = hex_digit(c);
+    if (digit < 0) {
+        fail("invalid \\u escape");
+        return;
+    }
+    unicode = unicode * 16 + (uint32_t) digit;
+    if (++unicodeDigits < 4)
+        return;
+
+    if (highSurrogate) {
+        if (unicode < 0xDC00 || unicode > 0xDFFF) {
+            fail("invalid surrogate pair");
+            return;
+        }
+        append_utf8(token, 0x10000 + ((highSurrogate - 0xD800) << 10) + (unicode - 0xDC00));
+        highSurrogate = 0;
+    } else if (unicode >= 0xD800 && unicode <= 0xDBFF) {
+        highSurrogate = unicode;
+        state = State::LowBackslash;
+        return;
+    } else if (unicode >= 0xDC00 && unicode <= 0xDFFF) {
+        fail("low surrogate without a high one");
+        return;
+    } else {
+        append_utf8(token, unicode);
+    }
+    state = State::String;
+}
+
+void JsonStreamParser::endString() {
+    if (!is_valid_utf8(token)) {
+        fail("invalid UTF-8 in string");
+        return;
+    }
+
+    if (tokenIsKey) {
+        stack.back().key = std::move(token);
+        token.clear();
+        state = State::Colon;
+        return;
+    }
+
+    Json value(std::move(token));
+    token.clear();
+    add(std::move(value));
+}
+
+void JsonStreamParser::endNumber() {
+    // Plain integers are the common case, everything else is left to nlohmann::json, which also
+    // rejects malformed numbers
+    bool negative = token[0] == '-';
+    size_t start = negative ? 1 : 0;
+    size_t digits = token.size() - start;
+    bool plain = digits > 0 && digits <= 18 && (token[start] != '0' || digits == 1);
+    for (size_t k = start; plain && k < token.size(); k++)
+        plain = token[k] >= '0' && token[k] <= '9';
+
+    Json value;
+    if (plain) {
+        uint64_t number = 0;
+        for (size_t k = start; k < token.size(); k++)
+            number = number * 10 + (uint64_t) (token[k] - '0');
+        // nlohmann::json keeps non-negative integers unsigned as well
+        if (negative)
+            value = -(int64_t) number;
+        else
+            value = number;
+    } else {
+        try {
+            value = Json::parse(token);
+        } catch (const Json::exception &) {
+            fail("invalid number");
+            return;
+        }
+    }
+
+    token.clear();
+    add(std::move(value));
+}
+
+void JsonStreamParser::endLiteral() {
+    Json value;
+    if (token == "true")
+        value = true;
+    else if (token == "false")
+        value = false;
+    else if (token != "null") {
+        fail("invalid literal");
+        return;
+    }
+
+    token.clear();
+    add(std::move(value));
+}
+
+void JsonStreamParser::endContainer(char c) {
+    if ((c == '}') != stack.back().value.is_object()) {
+        fail("mismatched end of array or object");
+        return;
+    }
+
+    Json value = std::move(stack.back().value);
+    stack.pop_back();
+    add(std::move(value));
+}
+
+void JsonStreamParser::add(nlohmann::json &&value) {
+    if (stack.empty()) {
+        root = std::move(value);
+        state = State::Done;
+        return;
+    }
+
+    // Later duplicates of a key win, as with nlohmann::json::parse()
+    Frame &frame = stack.back();
+    if (frame.value.is_array())
+        frame.value.get_ref<Json::array_t &>().push_back(std::move(value));
+    else
+        frame.value.get_ref<Json::object_t &>()[std::move(frame.key)] = std::move(value);
+    state = State::Next;
+}
+
+void JsonStreamParser::fail(const char *message) {
+    failure = "syntax error at byte " + std::to_string(position) + ": " + message;
+    state = State::Failed;
+
+    // Nothing more is parsed, free the partial document right away
+    stack.clear();
+    token.clear();
+}
@@ -0,0 +1,116 @@
+/******************************************************************************
+    Copyright (C) 2024 by 17Live
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+/**
+ * Push parser for a JSON document received in chunks.
+ *
+ * feed() is called from the transfer's write callback and parses each chunk right away, so the
+ * DOM is built while the rest of the body is still downloading and is ready right after the last
+ * byte. Chunks are not kept; only a string, number or literal cut in two by a chunk boundary is
+ * carried over to the next one. No thread is involved.
+ *
+ * nlohmann::json only parses from a complete input (its SAX interface pulls from an input
+ * adapter as well), so tokens are scanned here and numbers other than plain integers are
+ * converted by nlohmann::json. The result equals nlohmann::json::parse() of the whole body.
+ */
+class JsonStreamParser {
+   public:
+    JsonStreamParser() = default;
+
+    /**
+     * Parse the next chunk of the document. After a syntax error the rest of the input is
+     * ignored and finish() reports the error.
+     * @return false once finish() was called, further input is useless
+     */
+    bool feed(const char *data, size_t size);
+
+    /**
+     * Check that the document is complete
+     * @param json Receives the document on success
+     * @param error Receives the parse error otherwise
+     * @return true if a complete document was parsed
+     */
+    bool finish(nlohmann::json &json, std::string &error);
+
+    /**
+     * Number of bytes fed so far
+     */
+    size_t size() const { return fed; }
+
+    JsonStreamParser(const JsonStreamParser &) = delete;
+    JsonStreamParser &operator=(const JsonStreamParser &) = delete;
+
+   private:
+    enum class State {
+        Value,        // Start of a value
+        ArrayFirst,   // Value or ]
+        ObjectFirst,  // Key or }
+        Key,          // Key after a comma
+        Colon,
+        Next,  // , or the end of the enclosing array or object
+        String,
+        Escape,
+        Unicode,       // \uXXXX, hex digits in unicodeDigits
+        LowBackslash,  // \ of the low surrogate following a high one
+        LowU,          // u of the low surrogate
+        Number,
+        Literal,  // true, false or null
+        Done,
+        Failed,
+    };
+
+    // Array or object being filled, and the key of its next member
+    struct Frame {
+        nlohmann::json value;
+        std::string key;
+    };
+
+    void beginValue(char c);
+    size_t parseString(const char *data, size_t size);
+    void parseEscape(char c);
+    void parseUnicode(char c);
+    void endString();
+    void endNumber();
+    void endLiteral();
+    void endContainer(char c);
+    void add(nlohmann::json &&value);
+    void fail(const char *message);
+
+    State state = State::Value;
+    std::vector<Frame> stack;
+    nlohmann::json root;
+
+    std::string token;  // String, number or literal read so far
+    bool tokenIsKey = false;
+    uint32_t unicode = 0;
+    int unicodeDigits = 0;
+    uint32_t highSurrogate = 0;
+    size_t bomLength = 0;
+
+    bool finished = false;
+    size_t fed = 0;
+    size_t position = 0;  // Of the byte being parsed, for error messages
+    std::string failure;
+};
@@ -0,0 +1,426 @@
+/******************************************************************************
+    Copyright (C) 2024 by 17Live
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "NetworkChangeMonitor.hpp"
+
+#include <obs-module.h>
+
+#include <cerrno>
+#include <chrono>
+#include <set>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <iphlpapi.h>
+#pragma comment(lib, "iphlpapi.lib")
+#else
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/if.h>
+#include <linux/rtnetlink.h>
+#elif defined(__APPLE__)
+#include <net/if.h>
+#include <net/route.h>
+#endif
+#endif
+
+#include "ConnectionPrewarmer.hpp"
+#include "DnsPrefetcher.hpp"
+#include "HttpConnectionPool.hpp"
+#include "NetworkDiagnostics.hpp"
+#include "plugin-support.h"
+
+namespace {
+    enum class Wait { Changed, Quiet, Stopped };
+}  // namespace
+
+#ifdef _WIN32
+
+struct NetworkChangeMonitor::Source {
+    HANDLE stopEvent = nullptr;
+    HANDLE notifyHandle = nullptr;
+    OVERLAPPED overlapped = {};
+
+    ~Source() {
+        if (overlapped.hEvent) {
+            CancelIPChangeNotify(&overlapped);
+            CloseHandle(overlapped.hEvent);
+        }
+        if (stopEvent)
+            CloseHandle(stopEvent);
+    }
+
+    bool open() {
+        stopEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+        overlapped.hEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+        return stopEvent && overlapped.hEvent && arm();
+    }
+
+    // NotifyAddrChange reports a single change, it has to be re-armed after each one
+    bool arm() {
+        DWORD result = NotifyAddrChange(&notifyHandle, &overlapped);
+        if (result != ERROR_IO_PENDING) {
+            obs_log(LOG_WARNING, "[Network] NotifyAddrChange failed: %lu", result);
+            return false;
+        }
+        return true;
+    }
+
+    Wait wait(int timeoutMs, std::string &what) {
+        HANDLE handles[2] = {stopEvent, overlapped.hEvent};
+        DWORD result =
+            WaitForMultipleObjects(2, handles, FALSE, timeoutMs < 0 ? INFINITE : (DWORD) timeoutMs);
+        if (result == WAIT_TIMEOUT)
+            return Wait::Quiet;
+        if (result != WAIT_OBJECT_0 + 1 || !arm())
+            return Wait::Stopped;
+
+        what = "IP address table changed";
+        return Wait::Changed;
+    }
+
+    void wake() { SetEvent(stopEvent); }
+};
+
+#elif defined(__linux__) || defined(__APPLE__)
+
+struct NetworkChangeMonitor::Source {
+    int fd = -1;
+    int wakePipe[2] = {-1, -1};
+#ifdef __linux__
+    // Addresses currently assigned, so lifetime refreshes of IPv6 addresses are not mistaken for
+    // new ones
+    std::set<std::string> addresses;
+#endif
+
+    ~Source() {
+        for (int descriptor : {fd, wakePipe[0], wakePipe[1]}) {
+            if (descriptor >= 0)
+                close(descriptor);
+        }
+    }
+
+    bool open() {
+        if (pipe(wakePipe) != 0)
+            return false;
+        for (int descriptor : wakePipe)
+            fcntl(descriptor, F_SETFD, FD_CLOEXEC);
+
+#ifdef __linux__
+        loadAddresses();
+
+        fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+        if (fd < 0)
+            return false;
+
+        struct sockaddr_nl local = {};
+        local.nl_family = AF_NETLINK;
+        local.nl_groups = RTMGRP_LINK | RTMGRP_IPV4_IFADDR | RTMGRP_IPV6_IFADDR |
+                          RTMGRP_IPV4_ROUTE | RTMGRP_IPV6_ROUTE;
+        if (bind(fd, (struct sockaddr *) &local, sizeof(local)) != 0) {
+            obs_log(LOG_WARNING, "[Network] Cannot subscribe to netlink route events");
+            return false;
+        }
+#else
+        fd = socket(PF_ROUTE, SOCK_RAW, AF_UNSPEC);
+        if (fd < 0)
+            return false;
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+#endif
+        return true;
+    }
+
+    Wait wait(int timeoutMs, std::string &what) {
+        struct pollfd fds[2] = {{wakePipe[0], POLLIN, 0}, {fd, POLLIN, 0}};
+        int ready = poll(fds, 2, timeoutMs);
+        if (ready == 0)
+            return Wait::Quiet;
+        if (ready < 0)
+            return errno == EINTR ? Wait::Quiet : Wait::Stopped;
+        if (fds[0].revents)
+            return Wait::Stopped;
+
+        bool changed = false;
+        char buffer[16384];
+        for (;;) {
+            ssize_t length = recv(fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+            if (length <= 0) {
+                // ENOBUFS: events were dropped while the socket was full, assume a change
+                if (length < 0 && errno == ENOBUFS) {
+                    what = "event queue overflowed";
+                    changed = true;
+                    continue;
+                }
+                break;
+            }
+            changed |= parse(buffer, (size_t) length, what);
+        }
+        return changed ? Wait::Changed : Wait::Quiet;
+    }
+
+    void wake() {
+        char byte = 1;
+        ssize_t written = write(wakePipe[1], &byte, 1);
+        (void) written;
+    }
+
+#ifdef __linux__
+    static std::string addressKey(struct nlmsghdr *header) {
+        struct ifaddrmsg *info = (struct ifaddrmsg *) NLMSG_DATA(header);
+        std::string key = std::to_string(info->ifa_family) + "/" + std::to_string(info->ifa_index);
+
+        int length = (int) IFA_PAYLOAD(header);
+        for (struct rtattr *attribute = IFA_RTA(info); RTA_OK(attribute, length);
+             attribute = RTA_NEXT(attribute, length)) {
+            if (attribute->rta_type == IFA_ADDRESS || attribute->rta_type == IFA_LOCAL) {
+                key += "/";
+                key.append((const char *) RTA_DATA(attribute), RTA_PAYLOAD(attribute));
+            }
+        }
+        return key;
+    }
+
+    // Snapshot of the assigned addresses through a one-off dump request
+    void loadAddresses() {
+        int dumpFd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+        if (dumpFd < 0)
+            return;
+
+        struct {
+            struct nlmsghdr header;
+            struct ifaddrmsg message;
+        } request = {};
+        request.header.nlmsg_len = NLMSG_LENGTH(sizeof(struct ifaddrmsg));
+        request.header.nlmsg_type = RTM_GETADDR;
+        request.header.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+        request.header.nlmsg_seq = 1;
+        request.message.ifa_family = AF_UNSPEC;
+
+        struct timeval timeout = {2, 0};
+        setsockopt(dumpFd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+        if (send(dumpFd, &request, request.header.nlmsg_len, 0) >= 0) {
+            char buffer[16384];
+            bool done = false;
+            while (!done) {
+                ssize_t length = recv(dumpFd, buffer, sizeof(buffer), 0);
+                if (length <= 0)
+                    break;
+
+                int remaining = (int) length;
+                for (struct nlmsghdr *header = (struct nlmsghdr *) buffer;
+                     NLMSG_OK(header, remaining); header = NLMSG_NEXT(header, remaining)) {
+                    if (header->nlmsg_type == NLMSG_DONE || header->nlmsg_type == NLMSG_ERROR) {
+                        done = true;
+                        break;
+                    }
+                    if (header->nlmsg_type == RTM_NEWADDR)
+                        addresses.insert(addressKey(header));
+                }
+            }
+        }
+        close(dumpFd);
+    }
+
+    bool parse(char *buffer, size_t size, std::string &what) {
+        bool changed = false;
+        int remaining = (int) size;
+        for (struct nlmsghdr *header = (struct nlmsghdr *) buffer; NLMSG_OK(header, remaining);
+             header = NLMSG_NEXT(header, remaining)) {
+            switch (header->nlmsg_type) {
+                case RTM_NEWADDR:
+                    if (addresses.insert(addressKey(header)).second) {
+                        what = "address added";
+                        changed = true;
+                    }
+                    break;
+                case RTM_DELADDR:
+                    if (addresses.erase(addressKey(header))) {
+                        what = "address removed";
+                        changed = true;
+                    }
+                    break;
+                case RTM_NEWLINK:
+                case RTM_DELLINK: {
+                    // Wireless drivers send link messages for signal updates without any change
+                    struct ifinfomsg *info = (struct ifinfomsg *) NLMSG_DATA(header);
+                    if (header->nlmsg_type == RTM_DELLINK ||
+                        (info->ifi_change & (IFF_UP | IFF_RUNNING | IFF_LOWER_UP))) {
+                        what = (info->ifi_flags & IFF_RUNNING) && header->nlmsg_type == RTM_NEWLINK
+                                   ? "interface up"
+                                   : "interface down";
+                        changed = true;
+                    }
+                    break;
+                }
+                case RTM_NEWROUTE:
+                case RTM_DELROUTE: {
+                    struct rtmsg *route = (struct rtmsg *) NLMSG_DATA(header);
+                    if (route->rtm_dst_len == 0 && route->rtm_table == RT_TABLE_MAIN) {
+                        what = "default route changed";
+                        changed = true;
+                    }
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+        return changed;
+    }
+#else
+    bool parse(char *buffer, size_t size, std::string &what) {
+        // Routing socket messages share the rt_msghdr length / version / type prefix. Route
+        // additions are not watched: ARP and neighbour entries produce a steady stream of them.
+        bool changed = false;
+        size_t offset = 0;
+        while (offset + sizeof(struct rt_msghdr) <= size) {
+            struct rt_msghdr *message = (struct rt_msghdr *) (buffer + offset);
+            if (message->rtm_msglen == 0)
+                break;
+
+            switch (message->rtm_type) {
+                case RTM_NEWADDR:
+                    what = "address added";
+                    changed = true;
+                    break;
+                case RTM_DELADDR:
+                    what = "address removed";
+                    changed = true;
+                    break;
+                case RTM_IFINFO:
+                    what = "interface changed";
+                    changed = true;
+                    break;
+                default:
+                    break;
+            }
+            offset += message->rtm_msglen;
+        }
+        return changed;
+    }
+#endif
+};
+
+#else
+
+// No change notifications on this platform; start() leaves the monitor off
+struct NetworkChangeMonitor::Source {
+    bool open() { return false; }
+    Wait wait(int, std::string &) { return Wait::Stopped; }
+    void wake() {}
+};
+
+#endif
+
+NetworkChangeMonitor &NetworkChangeMonitor::instance() {
+    static NetworkChangeMonitor *monitor = new NetworkChangeMonitor();
+    return *monitor;
+}
+
+NetworkChangeMonitor::NetworkChangeMonitor() = default;
+
+NetworkChangeMonitor::~NetworkChangeMonitor() = default;
+
+void NetworkChangeMonitor::start(const std::string &url) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (source)
+        return;
+
+    auto opened = std::make_unique<Source>();
+    if (!opened->open()) {
+        obs_log(LOG_WARNING,
+                "[Network] Network change notifications unavailable, stale connections will "
+                "only be dropped by timeouts");
+        return;
+    }
+
+    diagnosticsUrl = url;
+    source = std::move(opened);
+    worker = std::thread(&NetworkChangeMonitor::run, this);
+    obs_log(LOG_INFO, "[Network] Watching for network changes");
+}
+
+void NetworkChangeMonitor::stop() {
+    std::unique_ptr<Source> stopping;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!source)
+            return;
+        source->wake();
+    }
+
+    if (worker.joinable())
+        worker.join();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = std::move(source);
+}
+
+void NetworkChangeMonitor::run() {
+    using Clock = std::chrono::steady_clock;
+
+    for (;;) {
+        std::string what;
+        Wait wait = source->wait(-1, what);
+        if (wait == Wait::Stopped)
+            break;
+        if (wait != Wait::Changed)
+            continue;
+
+        // Let the burst settle so one switch is handled once, with the final addresses
+        Clock::time_point first = Clock::now();
+        std::string more;
+        while (wait != Wait::Stopped && Clock::now() - first < std::chrono::milliseconds(
+                                                                  NETWORK_CHANGE_DEBOUNCE_MAX_MS)) {
+            wait = source->wait(NETWORK_CHANGE_DEBOUNCE_MS, more);
+            if (wait == Wait::Quiet)
+                break;
+        }
+        if (wait == Wait::Stopped)
+            break;
+
+        handleChange(what);
+    }
+}
+
+void NetworkChangeMonitor::handleChange(const std::string &reason) {
+    changeCount.fetch_add(1, std::memory_order_relaxed);
+    obs_log(LOG_INFO,
+            "[Network] Network changed (%s), dropping pooled connections and cached DNS answers",
+            reason.c_str());
+
+    HttpConnectionPool::instance().invalidate();
+    DnsPrefetcher::instance().refresh();
+    ConnectionPrewarmer::instance().warm("network change");
+
+    std::string url;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        url = diagnosticsUrl;
+    }
+    if (url.empty() || diagnosing.exchange(true))
+        return;
+
+    std::thread([this, url]() {
+        NetworkDiagnostics::runStartupDiagnostics(url);
+        diagnosing = false;
+    }).detach();
+}
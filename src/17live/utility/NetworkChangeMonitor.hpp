@@ -0,0 +1,82 @@
+/******************************************************************************
+    Copyright (C) 2024 by 17Live
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// One network switch produces a burst of events; act once they have been quiet this long, or
+// after the maximum if the burst does not stop
+#define NETWORK_CHANGE_DEBOUNCE_MS 500
+#define NETWORK_CHANGE_DEBOUNCE_MAX_MS 3000
+
+/**
+ * Watches the OS for network changes (interface up/down, addresses added or removed, default
+ * route changed) and recovers the HTTP transports right away instead of after a timeout.
+ *
+ * Linux listens on a netlink route socket, macOS on a PF_ROUTE socket and Windows uses
+ * NotifyAddrChange. After a change the connection and DNS caches are invalidated, the prefetched
+ * hosts are re-resolved, connections are warmed up again and NetworkDiagnostics probes the API
+ * in the background.
+ */
+class NetworkChangeMonitor {
+   public:
+    static NetworkChangeMonitor &instance();
+
+    /**
+     * Start watching (no-op if already running or unsupported on this platform)
+     * @param diagnosticsUrl URL probed with NetworkDiagnostics after each change
+     */
+    void start(const std::string &diagnosticsUrl);
+
+    /**
+     * Stop watching
+     */
+    void stop();
+
+    /**
+     * Recover the transports as if the network had changed
+     * @param reason Shown in the log
+     */
+    void handleChange(const std::string &reason);
+
+    uint64_t changes() const { return changeCount.load(std::memory_order_relaxed); }
+
+    NetworkChangeMonitor(const NetworkChangeMonitor &) = delete;
+    NetworkChangeMonitor &operator=(const NetworkChangeMonitor &) = delete;
+
+   private:
+    // Platform event source, defined in the .cpp
+    struct Source;
+
+    NetworkChangeMonitor();
+    ~NetworkChangeMonitor();
+
+    void run();
+
+    std::mutex mutex;
+    std::unique_ptr<Source> source;
+    std::thread worker;
+    std::string diagnosticsUrl;
+    std::atomic<bool> diagnosing{false};
+    std::atomic<uint64_t> changeCount{0};
+};
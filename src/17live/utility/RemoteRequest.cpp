@@ -0,0 +1,80 @@
+/******************************************************************************
+    Copyright (C) 2024 by 17Live
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+
+#include "RemoteRequest.hpp"
+
+#include <QMetaObject>
+#include <memory>
+
+#include "moc_RemoteRequest.cpp"
+
+RemoteRequest::RemoteRequest(std::string url, std::string contentType, std::string postData,
+                             int timeoutSec, bool isImageRequest_)
+    : isImageRequest(isImageRequest_) {
+    request.url = std::move(url);
+    request.contentType = std::move(contentType);
+    request.body = std::move(postData);
+    request.timeoutSec = timeoutSec;
+    if (!request.body.empty())
+        request.method = "POST";
+    // Avatars and icons can wait while OBS is streaming
+    if (isImageRequest)
+        request.transferClass = TransferClass::Background;
+}
+
+RemoteRequest::RemoteRequest(std::string url, std::vector<std::string> &&extraHeaders,
+                             std::string contentType, std::string postData, int timeoutSec,
+                             bool isImageRequest_)
+    : RemoteRequest(std::move(url), std::move(contentType), std::move(postData), timeoutSec,
+                    isImageRequest_) {
+    request.headers = std::move(extraHeaders);
+}
+
+void RemoteRequest::setCancellationToken(std::shared_ptr<CancellationToken> token) {
+    request.cancel = std::move(token);
+}
+
+void RemoteRequest::start() {
+    // The object has no parent and only deletes itself after delivery, so it is safe to
+    // reference from the engine thread until then
+    HttpEngine::instance().submit(request, [this](HttpResponse &&response) {
+        auto result = std::make_shared<HttpResponse>(std::move(response));
+        QMetaObject::invokeMethod(
+            this, [this, result]() { deliver(*result); }, Qt::QueuedConnection);
+    });
+}
+
+void RemoteRequest::deliver(const HttpResponse &response) {
+    QString error = response.ok() ? QString() : QString::fromStdString(response.error);
+
+    if (isImageRequest) {
+        // Wrap the engine's buffer without copying; it stays alive until emit returns
+        QByteArray imageData;
+        if (response.ok())
+            imageData =
+                QByteArray::fromRawData(response.body.data(), (qsizetype) response.body.size());
+        emit ImageResult(imageData, error);
+    } else {
+        emit Result(response.ok() ? QString::fromUtf8(response.body.data(),
+                                                      (qsizetype) response.body.size())
+                                  : QString(),
+                    error);
+    }
+
+    deleteLater();
+}
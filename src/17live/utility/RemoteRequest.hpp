@@ -0,0 +1,71 @@
+/******************************************************************************
+    Copyright (C) 2024 by 17Live
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+
+#pragma once
+
+#include <QByteArray>
+#include <QObject>
+#include <QString>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "HttpEngine.hpp"
+
+/**
+ * Asynchronous replacement for RemoteTextThread that runs on the shared HttpEngine instead of
+ * starting a thread per request.
+ *
+ * Create it on the Qt main thread, connect to Result or ImageResult with a receiver living on the
+ * main thread and call start(). The signal is emitted on the main thread and the object deletes
+ * itself afterwards. Image requests are background transfers for TransferShaper.
+ */
+class RemoteRequest : public QObject {
+    Q_OBJECT
+
+    HttpRequest request;
+    bool isImageRequest = false;
+
+   signals:
+    void Result(const QString &text, const QString &error);
+    // imageData references the response buffer and is only valid until the slot returns;
+    // receivers that keep it must make a deep copy first
+    void ImageResult(const QByteArray &imageData, const QString &error);
+
+   public:
+    RemoteRequest(std::string url, std::string contentType = std::string(),
+                  std::string postData = std::string(), int timeoutSec = 0,
+                  bool isImageRequest = false);
+
+    RemoteRequest(std::string url, std::vector<std::string> &&extraHeaders,
+                  std::string contentType = std::string(), std::string postData = std::string(),
+                  int timeoutSec = 0, bool isImageRequest = false);
+
+    /**
+     * Abort the transfer once token is canceled; it is still delivered, with an error
+     */
+    void setCancellationToken(std::shared_ptr<CancellationToken> token);
+
+    /**
+     * Queue the request on the HTTP engine
+     */
+    void start();
+
+   private:
+    void deliver(const HttpResponse &response);
+};
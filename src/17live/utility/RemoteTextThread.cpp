@@ -21,210 +21,257 @@
 
 #include <QByteArray>
 #include <QString>
+#include <algorithm>
 
-#include "curl-helper.h"
+#include "CancellationToken.hpp"
+#include "HttpCassette.hpp"
+#include "HttpClient.hpp"
+#include "HttpValidatorCache.hpp"
 #include "moc_RemoteTextThread.cpp"
+#include "plugin-support.h"
 
 using namespace std;
 
-static auto curl_deleter = [](CURL *curl) { curl_easy_cleanup(curl); };
-
-using Curl = unique_ptr<CURL, decltype(curl_deleter)>;
-
-static size_t string_write(char *ptr, size_t size, size_t nmemb, string &str) {
-    size_t total = size * nmemb;
-    if (total)
-        str.append(ptr, total);
-
-    return total;
-}
-
-static size_t binary_write(char *ptr, size_t size, size_t nmemb, std::vector<char> &data) {
-    size_t total = size * nmemb;
-    if (total) {
-        size_t current_size = data.size();
-        data.resize(current_size + total);
-        memcpy(data.data() + current_size, ptr, total);
-    }
-    return total;
-}
-
 void RemoteTextThread::run() {
-    char error[CURL_ERROR_SIZE];
-    CURLcode code;
-
-    string versionString("User-Agent: obs-basic ");
-    versionString += obs_get_version_string();
-
-    string contentTypeString;
-    if (!contentType.empty()) {
-        contentTypeString += "Content-Type: ";
-        contentTypeString += contentType;
+    HttpRequest request;
+    request.url = url;
+    request.contentType = contentType;
+    request.headers = extraHeaders;
+    request.timeoutSec = timeoutSec;
+    if (isImageRequest)
+        request.transferClass = TransferClass::Background;
+    if (!postData.empty()) {
+        request.method = "POST";
+        request.body = postData;
     }
 
-    Curl curl{curl_easy_init(), curl_deleter};
-    if (curl) {
-        struct curl_slist *header = nullptr;
-        string str;
-        std::vector<char> binary_data;
+    HttpResponse response = HttpClient::instance().perform(request);
 
-        header = curl_slist_append(header, versionString.c_str());
-
-        if (!contentTypeString.empty()) {
-            header = curl_slist_append(header, contentTypeString.c_str());
+    if (!response.ok()) {
+        // blog(LOG_WARNING, "RemoteTextThread: HTTP request failed. %s [url: %s]",
+        //      response.error.c_str(), url.c_str());
+        if (isImageRequest) {
+            emit ImageResult(QByteArray(), QString::fromStdString(response.error));
+        } else {
+            emit Result(QString(), QString::fromStdString(response.error));
         }
-
-        for (std::string &h : extraHeaders)
-            header = curl_slist_append(header, h.c_str());
-
-        curl_easy_setopt(curl.get(), CURLOPT_URL, url.c_str());
-        curl_easy_setopt(curl.get(), CURLOPT_ACCEPT_ENCODING, "");
-        curl_easy_setopt(curl.get(), CURLOPT_HTTPHEADER, header);
-        curl_easy_setopt(curl.get(), CURLOPT_ERRORBUFFER, error);
-        curl_easy_setopt(curl.get(), CURLOPT_FAILONERROR, 1L);
-
+    } else {
         if (isImageRequest) {
-            curl_easy_setopt(curl.get(), CURLOPT_WRITEFUNCTION, binary_write);
-            curl_easy_setopt(curl.get(), CURLOPT_WRITEDATA, &binary_data);
+            // Wrap the response buffer without copying; it stays alive until emit returns
+            emit ImageResult(
+                QByteArray::fromRawData(response.body.data(), (qsizetype) response.body.size()),
+                QString());
         } else {
-            curl_easy_setopt(curl.get(), CURLOPT_WRITEFUNCTION, string_write);
-            curl_easy_setopt(curl.get(), CURLOPT_WRITEDATA, &str);
+            emit Result(QString::fromUtf8(response.body.data(), (qsizetype) response.body.size()),
+                        QString());
         }
+    }
+}
 
-        curl_obs_set_revoke_setting(curl.get());
-
-        if (timeoutSec)
-            curl_easy_setopt(curl.get(), CURLOPT_TIMEOUT, timeoutSec);
+using BodyCallback = std::function<bool(const char *, size_t)>;
 
-        if (!postData.empty()) {
-            curl_easy_setopt(curl.get(), CURLOPT_POSTFIELDS, postData.c_str());
-        }
+static std::string request_body(const char *postData, int postDataSize) {
+    if (!postData)
+        return std::string();
+    return postDataSize > 0 ? std::string(postData, postDataSize) : std::string(postData);
+}
 
-        code = curl_easy_perform(curl.get());
-        if (code != CURLE_OK) {
-            // blog(LOG_WARNING, "RemoteTextThread: HTTP request failed. %s [url: %s]",
-            //      strlen(error) ? error : curl_easy_strerror(code), url.c_str());
-            if (isImageRequest) {
-                emit ImageResult(QByteArray(), QString::fromUtf8(error));
-            } else {
-                emit Result(QString(), QString::fromUtf8(error));
-            }
-        } else {
-            if (isImageRequest) {
-                QByteArray imageData(binary_data.data(), binary_data.size());
-                emit ImageResult(imageData, QString());
-            } else {
-                emit Result(QString::fromUtf8(str.c_str()), QString());
-            }
+static void find_signature(const vector<string> &header_in_list, std::string *signature) {
+    for (const string &h : header_in_list) {
+        string name = h.substr(0, 13);
+        // HTTP headers are technically case-insensitive
+        if (name == "X-Signature: " || name == "x-signature: ") {
+            *signature = h.substr(13);
+            break;
         }
-
-        curl_slist_free_all(header);
     }
 }
 
-static size_t header_write(char *ptr, size_t size, size_t nmemb, vector<string> &list) {
-    string str;
-
-    size_t total = size * nmemb;
-    if (total)
-        str.append(ptr, total);
-
-    if (str.back() == '\n')
-        str.resize(str.size() - 1);
-    if (str.back() == '\r')
-        str.resize(str.size() - 1);
+// Perform the transfer on the selected HttpClient backend
+static bool PerformRemoteFile(const char *url, std::string &str, std::string &error,
+                              long *responseCode, const char *contentType,
+                              const std::string &request_type, const char *postData,
+                              const std::vector<std::string> &extraHeaders,
+                              std::vector<std::string> *responseHeaders, int timeoutSec,
+                              bool fail_on_error, int postDataSize, const BodyCallback &onData,
+                              const std::shared_ptr<const HttpHeaderBlock> &sharedHeaders) {
+    HttpRequest request;
+    request.url = url;
+    request.method = request_type;
+    if (contentType)
+        request.contentType = contentType;
+    request.body = request_body(postData, postDataSize);
+    request.headers = extraHeaders;
+    request.sharedHeaders = sharedHeaders;
+    request.timeoutSec = timeoutSec;
+    request.failOnError = fail_on_error;
+    request.collectHeaders = responseHeaders != nullptr;
+    request.cancel = CancellationToken::current();
+    request.transferClass = TransferShaper::current();
+    request.onData = onData;
+
+    HttpResponse response = HttpClient::instance().perform(request);
+
+    if (responseCode)
+        *responseCode = response.status;
+
+    if (response.ok()) {
+        // Hand over the response buffer instead of copying it
+        if (str.empty())
+            str = std::move(response.body);
+        else
+            str.append(response.body);
+        if (responseHeaders)
+            *responseHeaders = std::move(response.headers);
+    } else {
+        error = response.error;
+    }
 
-    list.push_back(std::move(str));
-    return total;
+    return response.ok();
 }
 
 bool GetRemoteFile(const char *url, std::string &str, std::string &error, long *responseCode,
                    const char *contentType, std::string request_type, const char *postData,
                    std::vector<std::string> extraHeaders, std::string *signature, int timeoutSec,
-                   bool fail_on_error, int postDataSize) {
-    vector<string> header_in_list;
-    char error_in[CURL_ERROR_SIZE];
-    CURLcode code = CURLE_FAILED_INIT;
-
-    error_in[0] = 0;
+                   bool fail_on_error, int postDataSize, bool useValidatorCache,
+                   bool *notModified, const BodyCallback &onData,
+                   const std::shared_ptr<const HttpHeaderBlock> &sharedHeaders) {
+    HttpCassette &cassette = HttpCassette::instance();
+    vector<string> responseHeaders;
+    long status = 0;
+
+    if (cassette.isReplaying()) {
+        HttpCassetteEntry entry;
+        if (!cassette.replay(request_type, url, request_body(postData, postDataSize), entry)) {
+            error = "No cassette entry for " + std::string(url);
+            if (responseCode)
+                *responseCode = 0;
+            return false;
+        }
 
-    string versionString("User-Agent: obs-basic ");
-    versionString += obs_get_version_string();
+        if (responseCode)
+            *responseCode = entry.status;
+        if (!entry.success) {
+            error = entry.error;
+            return false;
+        }
 
-    string contentTypeString;
-    if (contentType) {
-        contentTypeString += "Content-Type: ";
-        contentTypeString += contentType;
+        if (onData)
+            onData(entry.body.data(), entry.body.size());
+        else
+            str.append(entry.body);
+        if (signature)
+            find_signature(entry.headers, signature);
+        return true;
     }
 
-    Curl curl{curl_easy_init(), curl_deleter};
-    if (curl) {
-        struct curl_slist *header = nullptr;
-
-        header = curl_slist_append(header, versionString.c_str());
+    if (notModified)
+        *notModified = false;
 
-        if (!contentTypeString.empty()) {
-            header = curl_slist_append(header, contentTypeString.c_str());
-        }
-
-        for (std::string &h : extraHeaders)
-            header = curl_slist_append(header, h.c_str());
-
-        curl_easy_setopt(curl.get(), CURLOPT_URL, url);
-        curl_easy_setopt(curl.get(), CURLOPT_ACCEPT_ENCODING, "");
-        curl_easy_setopt(curl.get(), CURLOPT_HTTPHEADER, header);
-        curl_easy_setopt(curl.get(), CURLOPT_ERRORBUFFER, error_in);
-        if (fail_on_error)
-            curl_easy_setopt(curl.get(), CURLOPT_FAILONERROR, 1L);
-        curl_easy_setopt(curl.get(), CURLOPT_WRITEFUNCTION, string_write);
-        curl_easy_setopt(curl.get(), CURLOPT_WRITEDATA, &str);
-        curl_obs_set_revoke_setting(curl.get());
-
-        if (signature) {
-            curl_easy_setopt(curl.get(), CURLOPT_HEADERFUNCTION, header_write);
-            curl_easy_setopt(curl.get(), CURLOPT_HEADERDATA, &header_in_list);
-        }
-
-        if (timeoutSec)
-            curl_easy_setopt(curl.get(), CURLOPT_TIMEOUT, timeoutSec);
+    std::shared_ptr<CancellationToken> cancel = CancellationToken::current();
+    if (cancel && cancel->isCanceled()) {
+        error = "Request canceled";
+        if (responseCode)
+            *responseCode = 0;
+        return false;
+    }
 
-        if (!request_type.empty()) {
-            if (request_type != "GET")
-                curl_easy_setopt(curl.get(), CURLOPT_CUSTOMREQUEST, request_type.c_str());
+    // A deadline on the calling thread's token caps the transfer timeout
+    if (cancel && cancel->hasDeadline()) {
+        int remainingSec = (int) ((cancel->remaining().count() + 999) / 1000);
+        if (!timeoutSec || remainingSec < timeoutSec)
+            timeoutSec = std::max(remainingSec, 1);
+    }
 
-            // Special case of "POST"
-            if (request_type == "POST") {
-                curl_easy_setopt(curl.get(), CURLOPT_POST, 1);
-                if (!postData)
-                    curl_easy_setopt(curl.get(), CURLOPT_POSTFIELDS, "{}");
-            }
-        }
-        if (postData) {
-            if (postDataSize > 0) {
-                curl_easy_setopt(curl.get(), CURLOPT_POSTFIELDSIZE, (long) postDataSize);
-            }
-            curl_easy_setopt(curl.get(), CURLOPT_POSTFIELDS, postData);
+    // Conditional GET: send the stored validators, a 304 is answered from the stored body
+    HttpValidatorCache &validatorCache = HttpValidatorCache::instance();
+    std::string cacheKey;
+    HttpValidator validator;
+    std::vector<std::string> requestHeaders = extraHeaders;
+    if (useValidatorCache && !postData &&
+        (request_type.empty() || request_type == "GET")) {
+        cacheKey = HttpValidatorCache::keyFor(url, extraHeaders);
+        if (validatorCache.lookup(cacheKey, validator)) {
+            if (!validator.etag.empty())
+                requestHeaders.push_back("If-None-Match: " + validator.etag);
+            if (!validator.lastModified.empty())
+                requestHeaders.push_back("If-Modified-Since: " + validator.lastModified);
         }
+    }
 
-        code = curl_easy_perform(curl.get());
-        if (responseCode)
-            curl_easy_getinfo(curl.get(), CURLINFO_RESPONSE_CODE, responseCode);
-
-        if (code != CURLE_OK) {
-            error = strlen(error_in) ? error_in : curl_easy_strerror(code);
-        } else if (signature) {
-            for (string &h : header_in_list) {
-                string name = h.substr(0, 13);
-                // HTTP headers are technically case-insensitive
-                if (name == "X-Signature: " || name == "x-signature: ") {
-                    *signature = h.substr(13);
-                    break;
-                }
+    bool recording = cassette.isRecording();
+    bool wantHeaders = signature || recording || !cacheKey.empty();
+    auto started = std::chrono::steady_clock::now();
+
+    // Streamed bodies are still collected while the cassette records them, and written to the
+    // validator cache as they arrive
+    std::unique_ptr<HttpValidatorCache::StreamedBody> cacheBody;
+    BodyCallback sink;
+    if (onData) {
+        if (!cacheKey.empty())
+            cacheBody = validatorCache.beginBody(cacheKey);
+        sink = [&str, &onData, &cacheBody, recording](const char *data, size_t size) {
+            if (recording)
+                str.append(data, size);
+            if (cacheBody)
+                cacheBody->write(data, size);
+            return onData(data, size);
+        };
+    }
+    auto storeResponse = [&]() {
+        if (!onData)
+            validatorCache.store(cacheKey, responseHeaders, str);
+        else if (cacheBody)
+            validatorCache.store(*cacheBody, responseHeaders);
+    };
+
+    bool success = PerformRemoteFile(url, str, error, &status, contentType, request_type,
+                                     postData, requestHeaders,
+                                     wantHeaders ? &responseHeaders : nullptr, timeoutSec,
+                                     fail_on_error, postDataSize, sink, sharedHeaders);
+
+    if (success && !cacheKey.empty()) {
+        if (status == 304) {
+            if (validatorCache.loadBody(cacheKey, str)) {
+                status = 200;
+                if (notModified)
+                    *notModified = true;
+            } else {
+                // Stored body is gone, repeat the request without validators
+                responseHeaders.clear();
+                if (onData)
+                    cacheBody = validatorCache.beginBody(cacheKey);
+                success = PerformRemoteFile(url, str, error, &status, contentType, request_type,
+                                            postData, extraHeaders, &responseHeaders, timeoutSec,
+                                            fail_on_error, postDataSize, sink, sharedHeaders);
+                if (success && status == 200)
+                    storeResponse();
             }
+        } else if (status == 200) {
+            storeResponse();
         }
+    }
 
-        curl_slist_free_all(header);
+    if (responseCode)
+        *responseCode = status;
+    if (success && signature)
+        find_signature(responseHeaders, signature);
+
+    if (recording) {
+        HttpCassetteEntry entry;
+        entry.method = request_type;
+        entry.url = url;
+        entry.requestBody = request_body(postData, postDataSize);
+        entry.success = success;
+        entry.status = status;
+        entry.error = error;
+        entry.headers = std::move(responseHeaders);
+        entry.body = str;
+        entry.totalMs = std::chrono::duration<double, std::milli>(
+                            std::chrono::steady_clock::now() - started)
+                            .count();
+        cassette.record(entry);
     }
 
-    return code == CURLE_OK;
+    return success;
 }
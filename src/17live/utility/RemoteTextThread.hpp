@@ -19,9 +19,13 @@
 
 #include <QThread>
 #include <chrono>
+#include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 
+class HttpHeaderBlock;
+
 class RemoteTextThread : public QThread {
     Q_OBJECT
 
@@ -38,6 +42,8 @@ class RemoteTextThread : public QThread {
 
    signals:
     void Result(const QString &text, const QString &error);
+    // imageData references the response buffer and is only valid until the slot returns, so
+    // connect with Qt::DirectConnection and make a deep copy to keep it
     void ImageResult(const QByteArray &imageData, const QString &error);
 
    public:
@@ -62,9 +68,30 @@ class RemoteTextThread : public QThread {
           isImageRequest(isImageRequest_) {}
 };
 
+/**
+ * Perform a blocking HTTP request on the backend selected by HttpClient::instance().
+ *
+ * With useValidatorCache a GET is sent as a conditional request using the ETag / Last-Modified
+ * stored by HttpValidatorCache. A 304 answer is returned as responseCode 200 with the stored body,
+ * and *notModified is set so callers can reuse what they parsed from that body before.
+ *
+ * The transfer is aborted as soon as the calling thread's CancellationToken::current() is
+ * canceled, and a deadline on that token caps timeoutSec. It is shaped as the calling thread's
+ * TransferShaper::current() class.
+ *
+ * With onData the body is handed over chunk by chunk while it is received and str stays empty,
+ * except for the stored body of a 304. The validator cache then gets the chunks written to disk
+ * as they arrive instead of a complete copy of the body.
+ *
+ * sharedHeaders are sent along with extraHeaders without being copied. They are left out of the
+ * validator cache key, so they must not change what the server answers.
+ */
 bool GetRemoteFile(const char *url, std::string &str, std::string &error,
                    long *responseCode = nullptr, const char *contentType = nullptr,
                    std::string request_type = "", const char *postData = nullptr,
                    std::vector<std::string> extraHeaders = std::vector<std::string>(),
                    std::string *signature = nullptr, int timeoutSec = 0, bool fail_on_error = true,
-                   int postDataSize = 0);
+                   int postDataSize = 0, bool useValidatorCache = false,
+                   bool *notModified = nullptr,
+                   const std::function<bool(const char *, size_t)> &onData = nullptr,
+                   const std::shared_ptr<const HttpHeaderBlock> &sharedHeaders = nullptr);
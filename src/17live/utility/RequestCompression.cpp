@@ -0,0 +1,174 @@
+/******************************************************************************
+    Copyright (C) 2024 by 17Live
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "RequestCompression.hpp"
+
+#include <obs-module.h>
+
+#include <QByteArray>
+#include <array>
+#include <cstdlib>
+
+#include "HttpMetrics.hpp"
+#include "plugin-support.h"
+
+namespace {
+    const std::array<uint32_t, 256> &crc32_table() {
+        static const std::array<uint32_t, 256> table = []() {
+            std::array<uint32_t, 256> t{};
+            for (uint32_t i = 0; i < 256; i++) {
+                uint32_t c = i;
+                for (int k = 0; k < 8; k++)
+                    c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                t[i] = c;
+            }
+            return t;
+        }();
+        return table;
+    }
+
+    uint32_t crc32(const char *data, size_t size) {
+        const std::array<uint32_t, 256> &table = crc32_table();
+        uint32_t c = 0xFFFFFFFFu;
+        for (size_t i = 0; i < size; i++)
+            c = table[(c ^ (uint8_t) data[i]) & 0xFF] ^ (c >> 8);
+        return c ^ 0xFFFFFFFFu;
+    }
+
+    void append_le32(std::string &out, uint32_t value) {
+        for (int i = 0; i < 4; i++)
+            out.push_back((char) ((value >> (8 * i)) & 0xFF));
+    }
+
+    const char *support_name(RequestCompression::Support support) {
+        switch (support) {
+            case RequestCompression::Support::Accepted:
+                return "accepted";
+            case RequestCompression::Support::Rejected:
+                return "rejected";
+            default:
+                return "undeclared";
+        }
+    }
+}  // namespace
+
+RequestCompression &RequestCompression::instance() {
+    static RequestCompression *compression = new RequestCompression();
+    return *compression;
+}
+
+RequestCompression::RequestCompression() {
+    const char *mode = getenv(REQUEST_COMPRESSION_ENV);
+    if (mode && std::string(mode) == "off") {
+        enabled = false;
+        obs_log(LOG_INFO, "[Request Compression] Disabled by %s", REQUEST_COMPRESSION_ENV);
+    }
+}
+
+std::string RequestCompression::keyFor(const std::string &method, const std::string &url) {
+    return method + " " + HttpMetrics::instance().endpointName(url);
+}
+
+void RequestCompression::declare(const std::string &method, const std::string &urlTemplate) {
+    HttpMetrics::instance().registerEndpoint(urlTemplate);
+    std::string key = keyFor(method, urlTemplate);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    endpoints[key] = Support::Accepted;
+}
+
+bool RequestCompression::shouldCompress(const std::string &method, const std::string &url,
+                                        size_t size) {
+    if (!enabled || size < REQUEST_COMPRESSION_MIN_SIZE)
+        return false;
+
+    return support(method, url) == Support::Accepted;
+}
+
+void RequestCompression::recordRejected(const std::string &method, const std::string &url) {
+    std::string key = keyFor(method, url);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = endpoints.find(key);
+    if (it == endpoints.end() || it->second == Support::Rejected)
+        return;
+
+    it->second = Support::Rejected;
+    obs_log(LOG_WARNING, "[Request Compression] %s rejects gzip request bodies despite its "
+                         "declaration, sending them plain",
+            key.c_str());
+}
+
+RequestCompression::Support RequestCompression::support(const std::string &method,
+                                                        const std::string &url) {
+    std::string key = keyFor(method, url);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = endpoints.find(key);
+    return it == endpoints.end() ? Support::Undeclared : it->second;
+}
+
+void RequestCompression::recordSavings(size_t plainSize, size_t compressedSize) {
+    compressedRequests.fetch_add(1, std::memory_order_relaxed);
+    plainBytes.fetch_add(plainSize, std::memory_order_relaxed);
+    compressedBytes.fetch_add(compressedSize, std::memory_order_relaxed);
+}
+
+RequestCompressionStats RequestCompression::stats() const {
+    RequestCompressionStats result;
+    result.requests = compressedRequests.load(std::memory_order_relaxed);
+    result.plainBytes = plainBytes.load(std::memory_order_relaxed);
+    result.compressedBytes = compressedBytes.load(std::memory_order_relaxed);
+    return result;
+}
+
+bool RequestCompression::gzip(const char *data, size_t size, std::string &out) {
+    // qCompress() yields a 4-byte big-endian length, then a zlib stream: a 2-byte header, the
+    // raw deflate data and an Adler-32 trailer. gzip wraps the same deflate data differently.
+    QByteArray zlib = qCompress(reinterpret_cast<const uchar *>(data), (qsizetype) size);
+    if (zlib.size() < 4 + 2 + 4)
+        return false;
+
+    const char *deflate = zlib.constData() + 4 + 2;
+    size_t deflateSize = (size_t) zlib.size() - 4 - 2 - 4;
+
+    static const char header[10] = {'\x1f', '\x8b', 8, 0, 0, 0, 0, 0, 0, '\xff'};
+
+    out.clear();
+    out.reserve(sizeof(header) + deflateSize + 8);
+    out.append(header, sizeof(header));
+    out.append(deflate, deflateSize);
+    append_le32(out, crc32(data, size));
+    append_le32(out, (uint32_t) size);
+    return true;
+}
+
+void RequestCompression::logStats() {
+    RequestCompressionStats s = stats();
+    if (s.requests) {
+        obs_log(LOG_INFO,
+                "[Request Compression] %llu compressed bodies: %llu -> %llu bytes (%.1f%% saved)",
+                (unsigned long long) s.requests, (unsigned long long) s.plainBytes,
+                (unsigned long long) s.compressedBytes,
+                s.plainBytes ? 100.0 * (s.plainBytes - s.compressedBytes) / s.plainBytes : 0.0);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto &entry : endpoints)
+        obs_log(LOG_INFO, "[Request Compression] %s: %s", entry.first.c_str(),
+                support_name(entry.second));
+}
@@ -0,0 +1,107 @@
+/******************************************************************************
+    Copyright (C) 2024 by 17Live
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+// Request bodies smaller than this are sent as is
+#define REQUEST_COMPRESSION_MIN_SIZE 1024
+// "off" disables request body compression
+#define REQUEST_COMPRESSION_ENV "OBS_17LIVE_REQUEST_COMPRESSION"
+
+/**
+ * Compressed request counters reported by RequestCompression
+ */
+struct RequestCompressionStats {
+    uint64_t requests = 0;
+    uint64_t plainBytes = 0;
+    uint64_t compressedBytes = 0;
+};
+
+/**
+ * gzip Content-Encoding for large request bodies of endpoints declared to accept it.
+ *
+ * Nothing is compressed unless declared: the server is never probed with a compressed body.
+ * An endpoint that answers a compressed body with 415 Unsupported Media Type gets plain bodies
+ * from then on. That request is not resent, the caller sees the 415. Endpoints are identified by
+ * method and URL template, grouped like HttpMetrics endpoints.
+ */
+class RequestCompression {
+   public:
+    enum class Support { Undeclared, Accepted, Rejected };
+
+    static RequestCompression &instance();
+
+    /**
+     * Declare that an endpoint decodes gzip request bodies
+     * @param method HTTP method, e.g. "POST"
+     * @param urlTemplate Full URL with %N placeholders, as used with QString::arg()
+     */
+    void declare(const std::string &method, const std::string &urlTemplate);
+
+    /**
+     * @return true if a body of size bytes for the request should be sent compressed
+     */
+    bool shouldCompress(const std::string &method, const std::string &url, size_t size);
+
+    /**
+     * Stop compressing bodies for an endpoint that answered a compressed one with 415
+     */
+    void recordRejected(const std::string &method, const std::string &url);
+
+    Support support(const std::string &method, const std::string &url);
+
+    /**
+     * Account for a compressed request, for logStats()
+     */
+    void recordSavings(size_t plainSize, size_t compressedSize);
+
+    RequestCompressionStats stats() const;
+
+    /**
+     * gzip-encode a buffer (RFC 1952)
+     * @return false if compression failed
+     */
+    static bool gzip(const char *data, size_t size, std::string &out);
+
+    /**
+     * Write compression ratio and per-endpoint support to the OBS log
+     */
+    void logStats();
+
+    RequestCompression(const RequestCompression &) = delete;
+    RequestCompression &operator=(const RequestCompression &) = delete;
+
+   private:
+    RequestCompression();
+
+    static std::string keyFor(const std::string &method, const std::string &url);
+
+    bool enabled = true;
+    std::mutex mutex;
+    std::map<std::string, Support> endpoints;
+
+    std::atomic<uint64_t> compressedRequests{0};
+    std::atomic<uint64_t> plainBytes{0};
+    std::atomic<uint64_t> compressedBytes{0};
+};
@@ -0,0 +1,191 @@
+/******************************************************************************
+    Copyright (C) 2024 by 17Live
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "ResponseCache.hpp"
+
+#include <obs-module.h>
+
+#include "HttpMetrics.hpp"
+#include "plugin-support.h"
+
+ResponseCache::ResponseCache(size_t maxBytes_) : maxBytes(maxBytes_) {}
+
+void ResponseCache::declare(const std::string &urlTemplate, std::chrono::seconds ttl) {
+    HttpMetrics &metrics = HttpMetrics::instance();
+    metrics.registerEndpoint(urlTemplate);
+    std::string endpoint = metrics.endpointName(urlTemplate);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    ttls[endpoint] = ttl;
+}
+
+void ResponseCache::declareInvalidation(const std::string &method,
+                                        const std::string &mutationTemplate,
+                                        const std::vector<std::string> &staleTemplates) {
+    HttpMetrics &metrics = HttpMetrics::instance();
+    metrics.registerEndpoint(mutationTemplate);
+    std::string key = method + " " + metrics.endpointName(mutationTemplate);
+
+    std::vector<std::string> stale;
+    for (const std::string &urlTemplate : staleTemplates) {
+        metrics.registerEndpoint(urlTemplate);
+        stale.push_back(metrics.endpointName(urlTemplate));
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<std::string> &endpoints = invalidations[key];
+    endpoints.insert(endpoints.end(), stale.begin(), stale.end());
+}
+
+bool ResponseCache::isCached(const std::string &url) {
+    std::string endpoint = HttpMetrics::instance().endpointName(url);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    return ttls.count(endpoint) > 0;
+}
+
+std::string ResponseCache::keyFor(const std::string &url, const std::vector<std::string> &headers) {
+    std::string key = url;
+    for (const std::string &header : headers) {
+        key += "\n";
+        key += header;
+    }
+    return key;
+}
+
+bool ResponseCache::lookup(const std::string &key, nlohmann::json &json) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(key);
+    if (it == index.end()) {
+        counters.misses++;
+        return false;
+    }
+
+    if (Clock::now() >= it->second->expires) {
+        erase(it->second);
+        counters.misses++;
+        return false;
+    }
+
+    lru.splice(lru.begin(), lru, it->second);
+    json = it->second->json;
+    counters.hits++;
+    return true;
+}
+
+uint64_t ResponseCache::generation() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return generationCounter;
+}
+
+void ResponseCache::store(const std::string &url, const std::string &key,
+                          const nlohmann::json &json, uint64_t generation) {
+    std::string endpoint = HttpMetrics::instance().endpointName(url);
+
+    // Rough size of the parsed JSON: its serialized length
+    size_t entryBytes = key.size() + json.dump().size();
+    if (entryBytes > maxBytes / RESPONSE_CACHE_MAX_ENTRY_FRACTION)
+        return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto ttl = ttls.find(endpoint);
+    if (ttl == ttls.end() || generation != generationCounter)
+        return;
+
+    auto existing = index.find(key);
+    if (existing != index.end())
+        erase(existing->second);
+
+    lru.push_front(Entry{key, endpoint, json, entryBytes, Clock::now() + ttl->second});
+    index[key] = lru.begin();
+    bytes += entryBytes;
+
+    while (bytes > maxBytes && !lru.empty()) {
+        erase(std::prev(lru.end()));
+        counters.evictions++;
+    }
+}
+
+void ResponseCache::invalidateAfter(const std::string &method, const std::string &url) {
+    std::string key = method + " " + HttpMetrics::instance().endpointName(url);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = invalidations.find(key);
+    if (it == invalidations.end())
+        return;
+
+    // Also rejects responses still in flight, even when nothing is cached yet
+    generationCounter++;
+    for (const std::string &endpoint : it->second)
+        counters.invalidations += invalidateEndpoint(endpoint);
+}
+
+void ResponseCache::invalidate(const std::string &urlTemplate) {
+    std::string endpoint = HttpMetrics::instance().endpointName(urlTemplate);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    generationCounter++;
+    counters.invalidations += invalidateEndpoint(endpoint);
+}
+
+void ResponseCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    generationCounter++;
+    lru.clear();
+    index.clear();
+    bytes = 0;
+}
+
+size_t ResponseCache::invalidateEndpoint(const std::string &endpoint) {
+    size_t dropped = 0;
+    for (auto it = lru.begin(); it != lru.end();) {
+        auto next = std::next(it);
+        if (it->endpoint == endpoint) {
+            erase(it);
+            dropped++;
+        }
+        it = next;
+    }
+    return dropped;
+}
+
+void ResponseCache::erase(std::list<Entry>::iterator it) {
+    bytes -= it->bytes;
+    index.erase(it->key);
+    lru.erase(it);
+}
+
+ResponseCacheStats ResponseCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    ResponseCacheStats result = counters;
+    result.entries = lru.size();
+    result.bytes = bytes;
+    return result;
+}
+
+void ResponseCache::logStats() const {
+    ResponseCacheStats s = stats();
+    uint64_t lookups = s.hits + s.misses;
+    double hitRate = lookups ? (100.0 * s.hits / lookups) : 0.0;
+
+    obs_log(LOG_INFO,
+            "[Response Cache] hits: %llu, misses: %llu (%.1f%% hit rate), evictions: %llu, "
+            "invalidated: %llu, %zu entries, %zu bytes",
+            (unsigned long long) s.hits, (unsigned long long) s.misses, hitRate,
+            (unsigned long long) s.evictions, (unsigned long long) s.invalidations, s.entries,
+            s.bytes);
+}
@@ -0,0 +1,144 @@
+/******************************************************************************
+    Copyright (C) 2024 by 17Live
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#define RESPONSE_CACHE_MAX_BYTES (4 * 1024 * 1024)
+// Larger responses are not cached, so one of them cannot flush everything else
+#define RESPONSE_CACHE_MAX_ENTRY_FRACTION 4
+
+struct ResponseCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    uint64_t invalidations = 0;
+    size_t entries = 0;
+    size_t bytes = 0;
+};
+
+/**
+ * Bounded in-memory cache of parsed GET responses, served without a request while fresh.
+ *
+ * Endpoints opt in with declare() and are identified by URL template, grouped like HttpMetrics
+ * endpoints; anything not declared is never cached. Entries are keyed by the full URL and the
+ * request headers that select the answer, such as the language, and the least recently used
+ * ones are evicted once the estimated size of the cached JSON passes the byte cap. Requests that
+ * change server state drop the responses they make stale, as declared with
+ * declareInvalidation().
+ */
+class ResponseCache {
+   public:
+    explicit ResponseCache(size_t maxBytes = RESPONSE_CACHE_MAX_BYTES);
+
+    /**
+     * Cache responses of an endpoint
+     * @param urlTemplate Full URL with %N placeholders, as used with QString::arg()
+     * @param ttl How long a response is served without asking the server again
+     */
+    void declare(const std::string &urlTemplate, std::chrono::seconds ttl);
+
+    /**
+     * Drop all cached responses of the stale endpoints whenever a request to mutation is sent
+     * @param method HTTP method of the mutation, e.g. "POST"
+     */
+    void declareInvalidation(const std::string &method, const std::string &mutationTemplate,
+                             const std::vector<std::string> &staleTemplates);
+
+    /**
+     * @return true if responses of url are cached at all
+     */
+    bool isCached(const std::string &url);
+
+    /**
+     * Build the cache key of a request from its URL and answer-selecting headers
+     */
+    static std::string keyFor(const std::string &url, const std::vector<std::string> &headers);
+
+    /**
+     * Get a fresh response
+     * @return false on a miss; expired entries are dropped
+     */
+    bool lookup(const std::string &key, nlohmann::json &json);
+
+    /**
+     * Counter bumped by every invalidation and clear(); read it before sending a request
+     */
+    uint64_t generation() const;
+
+    /**
+     * Store a successful response of url, if its endpoint is cached
+     * @param generation generation() read before the request was sent. The response is dropped
+     *        if anything was invalidated since, as it may predate that change.
+     */
+    void store(const std::string &url, const std::string &key, const nlohmann::json &json,
+               uint64_t generation);
+
+    /**
+     * Drop what a request is declared to make stale; call for every request that is not a GET
+     */
+    void invalidateAfter(const std::string &method, const std::string &url);
+
+    /**
+     * Drop all cached responses of an endpoint
+     */
+    void invalidate(const std::string &urlTemplate);
+
+    void clear();
+
+    ResponseCacheStats stats() const;
+    void logStats() const;
+
+    ResponseCache(const ResponseCache &) = delete;
+    ResponseCache &operator=(const ResponseCache &) = delete;
+
+   private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry {
+        std::string key;
+        std::string endpoint;
+        nlohmann::json json;
+        size_t bytes = 0;
+        Clock::time_point expires;
+    };
+
+    // Caller holds mutex
+    void erase(std::list<Entry>::iterator it);
+    size_t invalidateEndpoint(const std::string &endpoint);
+
+    const size_t maxBytes;
+
+    mutable std::mutex mutex;
+    std::map<std::string, std::chrono::seconds> ttls;               // endpoint -> TTL
+    std::map<std::string, std::vector<std::string>> invalidations;  // "<method> <endpoint>"
+    std::list<Entry> lru;  // Most recently used first
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    size_t bytes = 0;
+    uint64_t generationCounter = 0;
+    ResponseCacheStats counters;
+};
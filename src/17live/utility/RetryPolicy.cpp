@@ -0,0 +1,174 @@
+/******************************************************************************
+    Copyright (C) 2024 by 17Live
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "RetryPolicy.hpp"
+
+#include <obs-module.h>
+
+#include <QThreadPool>
+#include <algorithm>
+#include <condition_variable>
+#include <random>
+#include <thread>
+
+#include "CancellationToken.hpp"
+#include "HttpMetrics.hpp"
+#include "TransferShaper.hpp"
+#include "plugin-support.h"
+
+RetryPolicyRegistry &RetryPolicyRegistry::instance() {
+    static RetryPolicyRegistry *registry = new RetryPolicyRegistry();
+    return *registry;
+}
+
+RetryPolicyRegistry::RetryPolicyRegistry() : hedgePool(new QThreadPool()) {
+    hedgePool->setMaxThreadCount(RETRY_HEDGE_MAX_THREADS);
+}
+
+void RetryPolicyRegistry::declare(const std::string &method, const std::string &urlTemplate,
+                                  RetryPolicy policy) {
+    HttpMetrics &metrics = HttpMetrics::instance();
+    metrics.registerEndpoint(urlTemplate);
+    std::string key = method + " " + metrics.endpointName(urlTemplate);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    policies[key] = policy;
+}
+
+RetryPolicy RetryPolicyRegistry::forRequest(const std::string &method, const std::string &url) {
+    std::string key = method + " " + HttpMetrics::instance().endpointName(url);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = policies.find(key);
+    return it != policies.end() ? it->second : RetryPolicy::none();
+}
+
+std::chrono::milliseconds RetryPolicyRegistry::backoff(int retry) {
+    thread_local std::mt19937 random(std::random_device{}());
+
+    int64_t cap = RETRY_BASE_DELAY_MS;
+    for (int i = 0; i < retry && cap < RETRY_MAX_DELAY_MS; i++)
+        cap *= 2;
+    cap = std::min<int64_t>(cap, RETRY_MAX_DELAY_MS);
+
+    std::uniform_int_distribution<int64_t> delay(0, cap);
+    return std::chrono::milliseconds(delay(random));
+}
+
+bool RetryPolicyRegistry::waitBeforeRetry(std::chrono::milliseconds delay) {
+    std::shared_ptr<CancellationToken> cancel = CancellationToken::current();
+    if (cancel && cancel->hasDeadline() && cancel->remaining() <= delay)
+        return false;
+
+    auto until = std::chrono::steady_clock::now() + delay;
+    while (!(cancel && cancel->isCanceled())) {
+        auto left = until - std::chrono::steady_clock::now();
+        if (left <= std::chrono::steady_clock::duration::zero()) {
+            retries.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        std::this_thread::sleep_for(
+            std::min<std::chrono::steady_clock::duration>(
+                left, std::chrono::milliseconds(RETRY_CANCEL_POLL_MS)));
+    }
+    return false;
+}
+
+std::chrono::milliseconds RetryPolicyRegistry::hedgeDelay(const std::string &url) {
+    double p95 = HttpMetrics::instance().recentPercentile(url, RETRY_HEDGE_PERCENTILE,
+                                                          RETRY_HEDGE_MIN_SAMPLES);
+    if (p95 < 0.0)
+        return std::chrono::milliseconds(0);
+    return std::chrono::milliseconds(std::max<int64_t>((int64_t) p95, RETRY_HEDGE_MIN_DELAY_MS));
+}
+
+int RetryPolicyRegistry::hedge(const std::function<bool(int copy)> &attempt,
+                               std::chrono::milliseconds delay) {
+    std::shared_ptr<CancellationToken> parent = CancellationToken::current();
+    std::shared_ptr<CancellationToken> tokens[2] = {
+        CancellationToken::child(parent, std::chrono::milliseconds(0)),
+        CancellationToken::child(parent, std::chrono::milliseconds(0))};
+    TransferClass transferClass = TransferShaper::current();
+
+    std::mutex stateMutex;
+    std::condition_variable decided;
+    bool started = false;
+    bool finished[2] = {false, false};
+    bool helperDone = false;
+    int winner = -1;
+
+    // A final result wins right away; a transient failure only if the other copy cannot do better
+    auto complete = [&](int copy, bool final) {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        finished[copy] = true;
+        if (winner >= 0)
+            return;
+
+        int other = 1 - copy;
+        bool otherRunning = other == 1 ? started && !finished[1] : !finished[0];
+        if (final || !otherRunning) {
+            winner = copy;
+            tokens[other]->cancel();
+            decided.notify_all();
+        }
+    };
+
+    // Waits out the delay on a pool thread, so a hedged call does not start a thread of its own
+    std::unique_ptr<QRunnable> helper(QRunnable::create([&]() {
+        bool send = false;
+        {
+            std::unique_lock<std::mutex> lock(stateMutex);
+            auto sendAt = std::chrono::steady_clock::now() + delay;
+            send = !decided.wait_until(lock, sendAt, [&]() { return winner >= 0; });
+            started = send;
+        }
+        if (send) {
+            hedgesSent.fetch_add(1, std::memory_order_relaxed);
+            CancellationScope scope(tokens[1]);
+            TransferClassScope transferClassScope(transferClass);
+            complete(1, attempt(1));
+        }
+
+        std::lock_guard<std::mutex> lock(stateMutex);
+        helperDone = true;
+        decided.notify_all();
+    }));
+    helper->setAutoDelete(false);
+    hedgePool->start(helper.get());
+
+    {
+        CancellationScope scope(tokens[0]);
+        complete(0, attempt(0));
+    }
+
+    // A copy still queued is dropped, one that started is waited for
+    if (!hedgePool->tryTake(helper.get())) {
+        std::unique_lock<std::mutex> lock(stateMutex);
+        decided.wait(lock, [&]() { return helperDone; });
+    }
+
+    if (winner == 1)
+        hedgesWon.fetch_add(1, std::memory_order_relaxed);
+    return winner;
+}
+
+void RetryPolicyRegistry::logStats() const {
+    obs_log(LOG_INFO, "[Retry] retries: %llu, hedged requests: %llu (%llu answered first)",
+            (unsigned long long) retries.load(std::memory_order_relaxed),
+            (unsigned long long) hedgesSent.load(std::memory_order_relaxed),
+            (unsigned long long) hedgesWon.load(std::memory_order_relaxed));
+}
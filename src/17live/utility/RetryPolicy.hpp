@@ -0,0 +1,130 @@
+/******************************************************************************
+    Copyright (C) 2024 by 17Live
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+class CancellationToken;
+class QThreadPool;
+
+#define RETRY_MAX_ATTEMPTS 3
+// Full jitter: retry n waits a random time up to min(RETRY_MAX_DELAY_MS, RETRY_BASE_DELAY_MS * 2^n)
+#define RETRY_BASE_DELAY_MS 250
+#define RETRY_MAX_DELAY_MS 4000
+#define RETRY_CANCEL_POLL_MS 50
+// A hedged copy is sent once a call takes longer than this percentile of recent calls
+#define RETRY_HEDGE_PERCENTILE 0.95
+#define RETRY_HEDGE_MIN_SAMPLES 20
+#define RETRY_HEDGE_MIN_DELAY_MS 100
+// Hedged copies run on a small shared pool; when it is busy a copy starts late or not at all
+#define RETRY_HEDGE_MAX_THREADS 4
+
+/**
+ * How a failed call may be repeated. Only calls that are safe to send twice get anything but
+ * none(): a retried or hedged mutation could be applied twice by the server.
+ */
+struct RetryPolicy {
+    int maxAttempts = 1;
+    bool hedge = false;
+
+    /**
+     * Fail on the first error
+     */
+    static RetryPolicy none() { return RetryPolicy(); }
+
+    /**
+     * Retry transient failures with exponential backoff and full jitter
+     */
+    static RetryPolicy idempotent() { return RetryPolicy{RETRY_MAX_ATTEMPTS, false}; }
+
+    /**
+     * Like idempotent(), and send a second copy when the first one is slower than usual
+     */
+    static RetryPolicy hedged() { return RetryPolicy{RETRY_MAX_ATTEMPTS, true}; }
+};
+
+/**
+ * Retry policies declared per endpoint, and the backoff and hedging machinery to apply them.
+ *
+ * Endpoints are identified by method and URL template, grouped like HttpMetrics endpoints.
+ * Anything not declared gets RetryPolicy::none().
+ */
+class RetryPolicyRegistry {
+   public:
+    static RetryPolicyRegistry &instance();
+
+    /**
+     * @param method HTTP method, e.g. "GET"
+     * @param urlTemplate Full URL with %N placeholders, as used with QString::arg()
+     */
+    void declare(const std::string &method, const std::string &urlTemplate, RetryPolicy policy);
+
+    RetryPolicy forRequest(const std::string &method, const std::string &url);
+
+    /**
+     * Random delay before retry number `retry` (1 for the first retry)
+     */
+    static std::chrono::milliseconds backoff(int retry);
+
+    /**
+     * Sleep before a retry, waking up early if the calling thread's CancellationToken is canceled
+     * @return false if the retry must not be made: the call was canceled, or its deadline would
+     *         pass before the delay is over
+     */
+    bool waitBeforeRetry(std::chrono::milliseconds delay);
+
+    /**
+     * Delay after which a call to url is hedged
+     * @return Zero if there are not enough recent calls to tell what slow means
+     */
+    std::chrono::milliseconds hedgeDelay(const std::string &url);
+
+    /**
+     * Run attempt(0) on the calling thread and, if it has not returned after delay, attempt(1)
+     * on the hedge pool. Each copy runs under its own child of the caller's CancellationToken;
+     * the first copy to return a final result wins and the other one is canceled. Returns after
+     * both copies returned, so attempt may reference the caller's locals.
+     * @param attempt Makes the call, storing its result by copy index; returns true if the
+     *                result is final, false for a transient failure
+     * @return Index of the copy whose result to use
+     */
+    int hedge(const std::function<bool(int copy)> &attempt, std::chrono::milliseconds delay);
+
+    void logStats() const;
+
+    RetryPolicyRegistry(const RetryPolicyRegistry &) = delete;
+    RetryPolicyRegistry &operator=(const RetryPolicyRegistry &) = delete;
+
+    std::atomic<uint64_t> retries{0};
+    std::atomic<uint64_t> hedgesSent{0};
+    std::atomic<uint64_t> hedgesWon{0};
+
+   private:
+    RetryPolicyRegistry();
+
+    QThreadPool *hedgePool;
+    std::mutex mutex;
+    std::map<std::string, RetryPolicy> policies;  // "<method> <endpoint>"
+};
@@ -0,0 +1,99 @@
+/******************************************************************************
+    Copyright (C) 2024 by 17Live
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+/**
+ * Coalesces identical concurrent calls.
+ *
+ * The first caller for a key runs the function, callers arriving with the same key while it is
+ * still running block and receive a copy of the same result. Nothing is cached: once the call
+ * completes the next caller for the key starts a new one.
+ */
+template<typename Result> class SingleFlight {
+   public:
+    /**
+     * Run fn, or join the call already in flight for key
+     * @param key Identity of the call
+     * @param fn Function producing the result, run on the calling thread
+     * @return Result produced by fn for this call or for the call joined
+     */
+    Result run(const std::string &key, const std::function<Result()> &fn) {
+        std::shared_future<Result> pending;
+        std::promise<Result> promise;
+        bool leader = false;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = calls.find(key);
+            if (it != calls.end()) {
+                pending = it->second;
+            } else {
+                pending = promise.get_future().share();
+                calls.emplace(key, pending);
+                leader = true;
+            }
+        }
+
+        if (!leader) {
+            hitCount.fetch_add(1, std::memory_order_relaxed);
+            return pending.get();
+        }
+
+        missCount.fetch_add(1, std::memory_order_relaxed);
+
+        try {
+            promise.set_value(fn());
+        } catch (...) {
+            promise.set_exception(std::current_exception());
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            calls.erase(key);
+        }
+
+        return pending.get();
+    }
+
+    /**
+     * Number of calls that joined an outstanding call
+     */
+    uint64_t hits() const { return hitCount.load(std::memory_order_relaxed); }
+
+    /**
+     * Number of calls that had to run the function themselves
+     */
+    uint64_t misses() const { return missCount.load(std::memory_order_relaxed); }
+
+   private:
+    std::mutex mutex;
+    std::unordered_map<std::string, std::shared_future<Result>> calls;
+    std::atomic<uint64_t> hitCount{0};
+    std::atomic<uint64_t> missCount{0};
+};
@@ -0,0 +1,163 @@
+/******************************************************************************
+    Copyright (C) 2024 by 17Live
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "TransferShaper.hpp"
+
+#include <obs-module.h>
+
+#include <chrono>
+
+#include "plugin-support.h"
+
+namespace {
+    thread_local TransferClass currentClass = TransferClass::Interactive;
+
+    const char *class_name(size_t index) {
+        return index == (size_t) TransferClass::Background ? "background" : "interactive";
+    }
+}  // namespace
+
+TransferShaper &TransferShaper::instance() {
+    static TransferShaper *shaper = new TransferShaper();
+    return *shaper;
+}
+
+void TransferShaper::setStreaming(bool active) {
+    if (streaming.exchange(active) == active)
+        return;
+
+    if (active) {
+        obs_log(LOG_INFO,
+                "[Traffic] Stream started, background transfers capped to %d KB/s down, %d KB/s "
+                "up, %d at a time",
+                TRANSFER_SHAPER_BACKGROUND_RECV_BPS / 1024,
+                TRANSFER_SHAPER_BACKGROUND_SEND_BPS / 1024, TRANSFER_SHAPER_BACKGROUND_CONCURRENCY);
+    } else {
+        obs_log(LOG_INFO, "[Traffic] Stream stopped, background transfers at full speed");
+        logStats();
+    }
+
+    // Waiters re-check the limit, which is gone once the stream stopped
+    std::lock_guard<std::mutex> lock(mutex);
+    slotReleased.notify_all();
+}
+
+bool TransferShaper::isStreaming() const {
+    return streaming.load(std::memory_order_relaxed);
+}
+
+curl_off_t TransferShaper::recvLimit(TransferClass transferClass) const {
+    if (transferClass != TransferClass::Background || !isStreaming())
+        return 0;
+    return TRANSFER_SHAPER_BACKGROUND_RECV_BPS;
+}
+
+curl_off_t TransferShaper::sendLimit(TransferClass transferClass) const {
+    if (transferClass != TransferClass::Background || !isStreaming())
+        return 0;
+    return TRANSFER_SHAPER_BACKGROUND_SEND_BPS;
+}
+
+void TransferShaper::apply(CURL *curl, TransferClass transferClass, int share) const {
+    curl_off_t recv = recvLimit(transferClass);
+    curl_off_t send = sendLimit(transferClass);
+    if (share > 1) {
+        recv /= share;
+        send /= share;
+    }
+
+    // 0 means unlimited for both options
+    curl_easy_setopt(curl, CURLOPT_MAX_RECV_SPEED_LARGE, recv);
+    curl_easy_setopt(curl, CURLOPT_MAX_SEND_SPEED_LARGE, send);
+}
+
+bool TransferShaper::slotFree() const {
+    return !isStreaming() || activeBackground < TRANSFER_SHAPER_BACKGROUND_CONCURRENCY;
+}
+
+bool TransferShaper::tryAcquire(TransferClass transferClass) {
+    if (transferClass != TransferClass::Background)
+        return true;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!slotFree())
+        return false;
+    activeBackground++;
+    return true;
+}
+
+bool TransferShaper::acquire(TransferClass transferClass,
+                             const std::shared_ptr<CancellationToken> &cancel) {
+    if (transferClass != TransferClass::Background)
+        return true;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!slotFree()) {
+        if (cancel && cancel->isCanceled())
+            return false;
+        slotReleased.wait_for(lock, std::chrono::milliseconds(TRANSFER_SHAPER_CANCEL_POLL_MS));
+    }
+    activeBackground++;
+    return true;
+}
+
+void TransferShaper::release(TransferClass transferClass) {
+    if (transferClass != TransferClass::Background)
+        return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (activeBackground > 0)
+        activeBackground--;
+    slotReleased.notify_one();
+}
+
+void TransferShaper::record(TransferClass transferClass, uint64_t received, uint64_t sent) {
+    ClassStats &s = stats[(size_t) transferClass];
+    s.transfers.fetch_add(1, std::memory_order_relaxed);
+    s.received.fetch_add(received, std::memory_order_relaxed);
+    s.sent.fetch_add(sent, std::memory_order_relaxed);
+    if (isStreaming()) {
+        s.receivedWhileStreaming.fetch_add(received, std::memory_order_relaxed);
+        s.sentWhileStreaming.fetch_add(sent, std::memory_order_relaxed);
+    }
+}
+
+void TransferShaper::logStats() const {
+    for (size_t i = 0; i < 2; ++i) {
+        const ClassStats &s = stats[i];
+        obs_log(LOG_INFO,
+                "[Traffic] %s: %llu transfers, %.1f KB received, %.1f KB sent (while streaming: "
+                "%.1f KB received, %.1f KB sent)",
+                class_name(i), (unsigned long long) s.transfers.load(std::memory_order_relaxed),
+                s.received.load(std::memory_order_relaxed) / 1024.0,
+                s.sent.load(std::memory_order_relaxed) / 1024.0,
+                s.receivedWhileStreaming.load(std::memory_order_relaxed) / 1024.0,
+                s.sentWhileStreaming.load(std::memory_order_relaxed) / 1024.0);
+    }
+}
+
+TransferClass TransferShaper::current() {
+    return currentClass;
+}
+
+TransferClassScope::TransferClassScope(TransferClass transferClass) : previous(currentClass) {
+    currentClass = transferClass;
+}
+
+TransferClassScope::~TransferClassScope() {
+    currentClass = previous;
+}
@@ -0,0 +1,181 @@
+/******************************************************************************
+    Copyright (C) 2024 by 17Live
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#pragma once
+
+#include <curl/curl.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#include "CancellationToken.hpp"
+
+// Caps for background transfers while OBS is streaming, in bytes per second
+#define TRANSFER_SHAPER_BACKGROUND_RECV_BPS (256 * 1024)
+#define TRANSFER_SHAPER_BACKGROUND_SEND_BPS (32 * 1024)
+// Background transfers allowed to run at the same time while OBS is streaming
+#define TRANSFER_SHAPER_BACKGROUND_CONCURRENCY 1
+// How often a transfer waiting for a slot checks its cancellation token
+#define TRANSFER_SHAPER_CANCEL_POLL_MS 50
+
+/**
+ * Priority of a transfer. Interactive transfers answer something the user is waiting for,
+ * background ones (gift catalog, avatars and icons, update downloads) can wait.
+ */
+enum class TransferClass { Interactive, Background };
+
+/**
+ * Keeps plugin background traffic off the uplink the stream needs.
+ *
+ * While OBS is streaming, background transfers are capped to a fixed receive and send speed
+ * and only a few of them run at a time; transfers waiting for a slot queue up. Once the stream
+ * stops they run at full speed again. Caps are set when a transfer starts, so one that is
+ * already running keeps the speed it started with.
+ *
+ * Blocking calls do not take a class argument: the caller marks a block of work as background
+ * with TransferClassScope, like CancellationScope for cancellation.
+ */
+class TransferShaper {
+   public:
+    static TransferShaper &instance();
+
+    /**
+     * Turn shaping on or off, driven by the OBS streaming events
+     */
+    void setStreaming(bool active);
+    bool isStreaming() const;
+
+    /**
+     * Receive / send speed cap for a transfer of this class starting now
+     * @return Bytes per second, 0 for no cap
+     */
+    curl_off_t recvLimit(TransferClass transferClass) const;
+    curl_off_t sendLimit(TransferClass transferClass) const;
+
+    /**
+     * Apply the caps to an easy handle
+     * @param curl Easy handle
+     * @param transferClass Class of the transfer
+     * @param share Number of handles the cap is split between, e.g. the ranges of one download
+     */
+    void apply(CURL *curl, TransferClass transferClass, int share = 1) const;
+
+    /**
+     * Take a slot for a transfer of this class without waiting
+     * @return false if the class is at its concurrency limit; interactive transfers always pass
+     */
+    bool tryAcquire(TransferClass transferClass);
+
+    /**
+     * Take a slot for a transfer of this class, waiting until one is free
+     * @param transferClass Class of the transfer
+     * @param cancel Stops waiting once canceled, may be null
+     * @return false if cancel was canceled before a slot was free
+     */
+    bool acquire(TransferClass transferClass, const std::shared_ptr<CancellationToken> &cancel);
+
+    /**
+     * Return a slot taken with tryAcquire() or acquire()
+     */
+    void release(TransferClass transferClass);
+
+    /**
+     * Account for bytes moved by a finished transfer
+     */
+    void record(TransferClass transferClass, uint64_t received, uint64_t sent);
+
+    /**
+     * Write the bytes consumed per class to the OBS log
+     */
+    void logStats() const;
+
+    /**
+     * Class installed on the calling thread by the innermost TransferClassScope, Interactive if
+     * there is none
+     */
+    static TransferClass current();
+
+    TransferShaper(const TransferShaper &) = delete;
+    TransferShaper &operator=(const TransferShaper &) = delete;
+
+   private:
+    struct ClassStats {
+        std::atomic<uint64_t> transfers{0};
+        std::atomic<uint64_t> received{0};
+        std::atomic<uint64_t> sent{0};
+        std::atomic<uint64_t> receivedWhileStreaming{0};
+        std::atomic<uint64_t> sentWhileStreaming{0};
+    };
+
+    TransferShaper() = default;
+
+    bool slotFree() const;
+
+    std::atomic<bool> streaming{false};
+
+    mutable std::mutex mutex;
+    std::condition_variable slotReleased;
+    size_t activeBackground = 0;
+
+    ClassStats stats[2];
+};
+
+/**
+ * Marks the transfers started on the calling thread with a class for the lifetime of the scope,
+ * restoring the previous one on exit
+ */
+class TransferClassScope {
+   public:
+    explicit TransferClassScope(TransferClass transferClass);
+    ~TransferClassScope();
+
+    TransferClassScope(const TransferClassScope &) = delete;
+    TransferClassScope &operator=(const TransferClassScope &) = delete;
+
+   private:
+    TransferClass previous;
+};
+
+/**
+ * Holds a TransferShaper slot for the lifetime of a blocking transfer
+ */
+class TransferSlot {
+   public:
+    TransferSlot(TransferClass transferClass_, const std::shared_ptr<CancellationToken> &cancel)
+        : transferClass(transferClass_),
+          acquired(TransferShaper::instance().acquire(transferClass, cancel)) {}
+    ~TransferSlot() {
+        if (acquired)
+            TransferShaper::instance().release(transferClass);
+    }
+
+    /**
+     * @return false if the wait for a slot was canceled
+     */
+    bool isAcquired() const { return acquired; }
+
+    TransferSlot(const TransferSlot &) = delete;
+    TransferSlot &operator=(const TransferSlot &) = delete;
+
+   private:
+    TransferClass transferClass;
+    bool acquired;
+};
@@ -30,6 +30,7 @@ extern "C" {
 extern const char *PLUGIN_NAME;
 extern const char *PLUGIN_VERSION;
 extern const char *ONESEVENLIVE_API_URL;
+extern const char *ONESEVENLIVE_REFRESH_TOKEN_PATH; /* empty: token refresh disabled */
 
 void obs_log(int log_level, const char *format, ...);
 extern void blogva(int log_level, const char *format, va_list args);
@@ -0,0 +1,186 @@
+/******************************************************************************
+    Copyright (C) 2024 by 17Live
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+/*
+ * Compares latency and CPU cost of the HttpClient backends.
+ *
+ * Starts a cpp-httplib server on a loopback port serving a small and a large body, requests each
+ * one sequentially and from several threads at once on every backend, and prints p50 / p95
+ * latency and process CPU time per request. Fails if any request fails.
+ *
+ * Usage: http-client-benchmark [requests per backend and scenario]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../deps/cpp-httplib/httplib.h"
+#include "test_server.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include "utility/HttpClient.hpp"
+
+#define BENCHMARK_DEFAULT_REQUESTS 200
+#define BENCHMARK_THREADS 4
+#define BENCHMARK_SMALL_SIZE 1024
+#define BENCHMARK_LARGE_SIZE (1024 * 1024)
+
+namespace {
+    struct BenchmarkResult {
+        std::vector<double> latenciesMs;
+        double cpuMs = 0.0;
+        int errors = 0;
+    };
+
+    // User + kernel CPU time of the whole process, so work on HttpEngine's thread is counted too
+    double process_cpu_ms() {
+#ifdef _WIN32
+        FILETIME creation, exit, kernel, user;
+        if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user))
+            return 0.0;
+        auto to_ms = [](const FILETIME &time) {
+            return (((uint64_t) time.dwHighDateTime << 32) | time.dwLowDateTime) / 10000.0;
+        };
+        return to_ms(kernel) + to_ms(user);
+#else
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) != 0)
+            return 0.0;
+        return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000.0 +
+               (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000.0;
+#endif
+    }
+
+    double percentile(std::vector<double> &sorted, double p) {
+        if (sorted.empty())
+            return 0.0;
+        size_t index = (size_t) (p * (sorted.size() - 1) + 0.5);
+        return sorted[std::min(index, sorted.size() - 1)];
+    }
+
+    BenchmarkResult measure(HttpClient &client, const std::string &url, int requests,
+                            int threads) {
+        BenchmarkResult result;
+        std::mutex mutex;
+
+        // The test server runs in the same process and adds the same cost to every backend
+        double cpuStart = process_cpu_ms();
+
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            int count = requests / threads + (t < requests % threads ? 1 : 0);
+            workers.emplace_back([&client, &url, &result, &mutex, t, count]() {
+                std::vector<double> latencies;
+                int errors = 0;
+                for (int i = 0; i < count; ++i) {
+                    // Unique URLs, so HttpEngine cannot coalesce concurrent requests
+                    HttpRequest request;
+                    request.url = url + "?t=" + std::to_string(t) + "&i=" + std::to_string(i);
+                    request.timeoutSec = 30;
+
+                    auto started = std::chrono::steady_clock::now();
+                    HttpResponse response = client.perform(request);
+                    latencies.push_back(std::chrono::duration<double, std::milli>(
+                                            std::chrono::steady_clock::now() - started)
+                                            .count());
+                    if (!response.ok())
+                        errors++;
+                }
+
+                std::lock_guard<std::mutex> lock(mutex);
+                result.latenciesMs.insert(result.latenciesMs.end(), latencies.begin(),
+                                          latencies.end());
+                result.errors += errors;
+            });
+        }
+        for (std::thread &worker : workers)
+            worker.join();
+
+        result.cpuMs = process_cpu_ms() - cpuStart;
+        return result;
+    }
+}  // namespace
+
+int main(int argc, char **argv) {
+    int requests = argc > 1 ? atoi(argv[1]) : 0;
+    if (requests <= 0)
+        requests = BENCHMARK_DEFAULT_REQUESTS;
+
+    httplib::Server server;
+    std::string smallBody(BENCHMARK_SMALL_SIZE, 'x');
+    std::string largeBody(BENCHMARK_LARGE_SIZE, 'x');
+    server.Get("/small", [&smallBody](const httplib::Request &, httplib::Response &res) {
+        res.set_content(smallBody, "application/octet-stream");
+    });
+    server.Get("/large", [&largeBody](const httplib::Request &, httplib::Response &res) {
+        res.set_content(largeBody, "application/octet-stream");
+    });
+
+    // Small responses would otherwise wait for delayed ACKs and hide the client cost
+    server.set_tcp_nodelay(true);
+
+    TestServer running(server);
+    if (!running.ok())
+        return 1;
+
+    std::string base = running.base();
+    printf("%d requests per scenario against %s\n", requests, base.c_str());
+
+    struct Scenario {
+        const char *name;
+        const char *path;
+        int threads;
+    };
+    const Scenario scenarios[] = {
+        {"1 KB sequential", "/small", 1},
+        {"1 KB concurrent", "/small", BENCHMARK_THREADS},
+        {"1 MB sequential", "/large", 1},
+        {"1 MB concurrent", "/large", BENCHMARK_THREADS},
+    };
+
+    int errors = 0;
+    for (const std::string &name : HttpClient::backends()) {
+        HttpClient *client = HttpClient::backend(name);
+        for (const Scenario &scenario : scenarios) {
+            std::string url = base + scenario.path;
+
+            // Warm-up, so every backend starts with an open connection
+            measure(*client, url, scenario.threads, scenario.threads);
+
+            BenchmarkResult result = measure(*client, url, requests, scenario.threads);
+            std::sort(result.latenciesMs.begin(), result.latenciesMs.end());
+            printf("%-10s %s: p50 %.2f ms, p95 %.2f ms, CPU %.3f ms/request, errors %d\n",
+                   name.c_str(), scenario.name, percentile(result.latenciesMs, 0.50),
+                   percentile(result.latenciesMs, 0.95), result.cpuMs / requests, result.errors);
+            errors += result.errors;
+        }
+    }
+
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,254 @@
+/******************************************************************************
+    Copyright (C) 2024 by 17Live
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+/*
+ * Time to a parsed document for JSON responses, parsed after the download or while it runs.
+ *
+ * The JSON bodies of a cassette (see HttpCassette) are served by a local server at a capped
+ * rate, like a slow link, and each one is fetched through HttpClient twice: collected and then
+ * parsed with nlohmann::json::parse(), and fed to JsonStreamParser from the write callback. The
+ * time from the request and from the last byte to the parsed document is printed for both.
+ * Fails if a transfer fails or the streamed document differs from the collected one.
+ *
+ * data/gifts.cassette.jsonl holds a gift list shaped like /api/v1/gifts. Record real traffic with
+ * OBS_17LIVE_HTTP_CASSETTE and pass that file to measure other payloads.
+ *
+ * Usage: json-stream-benchmark <cassette> [bytes per second]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../deps/cpp-httplib/httplib.h"
+#include "test_server.hpp"
+
+#include "utility/HttpClient.hpp"
+#include "utility/JsonStreamParser.hpp"
+
+#define BENCHMARK_DEFAULT_RATE (2 * 1024 * 1024)
+#define BENCHMARK_CHUNK_SIZE (16 * 1024)
+#define BENCHMARK_ROUNDS 3
+
+using Json = nlohmann::json;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+    struct Payload {
+        std::string url;
+        std::string body;
+    };
+
+    struct Timing {
+        bool ok = false;
+        double parsedMs = 0.0;         // From the request to the parsed document
+        double afterLastByteMs = 0.0;  // From the last byte to the parsed document
+    };
+
+    double ms_between(Clock::time_point from, Clock::time_point to) {
+        return std::chrono::duration<double, std::milli>(to - from).count();
+    }
+
+    // The 200 JSON bodies of a cassette
+    std::vector<Payload> load_cassette(const char *path) {
+        std::vector<Payload> payloads;
+        std::ifstream input(path, std::ios::in | std::ios::binary);
+        std::string line;
+        while (std::getline(input, line)) {
+            if (line.empty())
+                continue;
+            try {
+                Json entry = Json::parse(line);
+                std::string body = entry.value("body", "");
+                size_t start = body.find_first_not_of(" \t\r\n");
+                if (!entry.value("success", false) || entry.value("status", 0L) != 200 ||
+                    start == std::string::npos || (body[start] != '{' && body[start] != '['))
+                    continue;
+                payloads.push_back({entry.value("url", ""), std::move(body)});
+            } catch (const Json::exception &e) {
+                fprintf(stderr, "Skipping a cassette line: %s\n", e.what());
+            }
+        }
+        return payloads;
+    }
+
+    // Serves body[offset, offset + length) at rate bytes per second
+    bool write_throttled(const std::string &body, size_t offset, size_t length, size_t rate,
+                         httplib::DataSink &sink) {
+        Clock::time_point started = Clock::now();
+        size_t sent = 0;
+        while (sent < length) {
+            size_t size = std::min<size_t>(BENCHMARK_CHUNK_SIZE, length - sent);
+            if (!sink.is_writable())
+                return false;
+            sink.write(body.data() + offset + sent, size);
+            sent += size;
+
+            std::this_thread::sleep_until(
+                started + std::chrono::microseconds((long long) (sent * 1000000.0 / rate)));
+        }
+        return true;
+    }
+
+    Timing fetch_collected(const std::string &url, Json &json) {
+        HttpRequest request;
+        request.url = url;
+        request.timeoutSec = 120;
+
+        Timing timing;
+        Clock::time_point started = Clock::now();
+        HttpResponse response = HttpClient::instance().perform(request);
+        Clock::time_point lastByte = Clock::now();
+        if (!response.ok()) {
+            fprintf(stderr, "%s failed: %s\n", url.c_str(), response.error.c_str());
+            return timing;
+        }
+
+        try {
+            json = Json::parse(response.body);
+        } catch (const Json::exception &e) {
+            fprintf(stderr, "%s: %s\n", url.c_str(), e.what());
+            return timing;
+        }
+
+        Clock::time_point parsed = Clock::now();
+        timing.ok = true;
+        timing.parsedMs = ms_between(started, parsed);
+        timing.afterLastByteMs = ms_between(lastByte, parsed);
+        return timing;
+    }
+
+    Timing fetch_streamed(const std::string &url, Json &json) {
+        JsonStreamParser parser;
+        Clock::time_point lastByte;
+
+        HttpRequest request;
+        request.url = url;
+        request.timeoutSec = 120;
+        request.onData = [&parser, &lastByte](const char *data, size_t size) {
+            lastByte = Clock::now();
+            return parser.feed(data, size);
+        };
+
+        Timing timing;
+        Clock::time_point started = Clock::now();
+        HttpResponse response = HttpClient::instance().perform(request);
+        if (!response.ok()) {
+            fprintf(stderr, "%s failed: %s\n", url.c_str(), response.error.c_str());
+            return timing;
+        }
+
+        std::string error;
+        if (!parser.finish(json, error)) {
+            fprintf(stderr, "%s: %s\n", url.c_str(), error.c_str());
+            return timing;
+        }
+
+        Clock::time_point parsed = Clock::now();
+        timing.ok = true;
+        timing.parsedMs = ms_between(started, parsed);
+        timing.afterLastByteMs = ms_between(lastByte, parsed);
+        return timing;
+    }
+
+    double median(std::vector<double> values) {
+        if (values.empty())
+            return 0.0;
+        std::sort(values.begin(), values.end());
+        return values[values.size() / 2];
+    }
+}  // namespace
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <cassette> [bytes per second]\n", argv[0]);
+        return 1;
+    }
+    size_t rate = argc > 2 ? (size_t) atoll(argv[2]) : 0;
+    if (!rate)
+        rate = BENCHMARK_DEFAULT_RATE;
+
+    std::vector<Payload> payloads = load_cassette(argv[1]);
+    if (payloads.empty()) {
+        fprintf(stderr, "No JSON responses in %s\n", argv[1]);
+        return 1;
+    }
+
+    httplib::Server server;
+    server.Get(R"(/payload/(\d+))", [&payloads, rate](const httplib::Request &req,
+                                                      httplib::Response &res) {
+        size_t index = (size_t) std::stoul(req.matches[1].str());
+        if (index >= payloads.size()) {
+            res.status = 404;
+            return;
+        }
+        const std::string &body = payloads[index].body;
+        res.set_content_provider(body.size(), "application/json",
+                                 [&body, rate](size_t offset, size_t length,
+                                               httplib::DataSink &sink) {
+                                     return write_throttled(body, offset, length, rate, sink);
+                                 });
+    });
+
+    TestServer running(server);
+    if (!running.ok())
+        return 1;
+
+    std::string base = running.base();
+    printf("%zu payloads at %.1f MB/s on %s, median of %d rounds\n", payloads.size(),
+           rate / (1024.0 * 1024.0), HttpClient::instance().name(), BENCHMARK_ROUNDS);
+
+    int failures = 0;
+    for (size_t i = 0; i < payloads.size(); i++) {
+        std::string url = base + "/payload/" + std::to_string(i);
+        std::vector<double> collectedMs, collectedTailMs, streamedMs, streamedTailMs;
+
+        for (int round = 0; round < BENCHMARK_ROUNDS; round++) {
+            Json collected, streamed;
+            Timing a = fetch_collected(url, collected);
+            Timing b = fetch_streamed(url, streamed);
+            if (!a.ok || !b.ok) {
+                failures++;
+                continue;
+            }
+            if (streamed != collected) {
+                fprintf(stderr, "%s: streamed document differs\n", payloads[i].url.c_str());
+                failures++;
+                continue;
+            }
+
+            collectedMs.push_back(a.parsedMs);
+            collectedTailMs.push_back(a.afterLastByteMs);
+            streamedMs.push_back(b.parsedMs);
+            streamedTailMs.push_back(b.afterLastByteMs);
+        }
+
+        printf("%s (%zu KB)\n", payloads[i].url.c_str(), payloads[i].body.size() / 1024);
+        printf("    collected: parsed after %.1f ms, %.2f ms after the last byte\n",
+               median(collectedMs), median(collectedTailMs));
+        printf("    streamed:  parsed after %.1f ms, %.2f ms after the last byte\n",
+               median(streamedMs), median(streamedTailMs));
+    }
+
+    return failures ? 1 : 0;
+}
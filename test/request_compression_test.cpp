@@ -0,0 +1,201 @@
+/******************************************************************************
+    Copyright (C) 2024 by 17Live
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+/*
+ * gzip request bodies sent by OneSevenLiveApiWrappers to a local stand-in for the 17Live API.
+ *
+ * The calls go through the wrapper's own send path, so the test covers what TryInsertCommand
+ * does with a declared endpoint: the Content-Encoding header, a body the server decodes to the
+ * original, the savings it records, plain bodies below REQUEST_COMPRESSION_MIN_SIZE, and a 415
+ * that turns compression off for its endpoint without resending the request.
+ *
+ * The wrapper's URLs are fixed when the plugin support file is generated, so the stand-in
+ * listens on REQUEST_COMPRESSION_TEST_PORT. Its cpp-httplib is built with zlib and decodes gzip
+ * bodies like the real service would; the CreateRtmp route answers them with 415.
+ */
+
+#include <zlib.h>
+
+#include <cstdio>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <string>
+
+#include "../deps/cpp-httplib/httplib.h"
+#include "test_server.hpp"
+
+#include "api/OneSevenLiveApiWrappers.hpp"
+#include "utility/RequestCompression.hpp"
+
+using Json = nlohmann::json;
+
+// Defined by the config manager in the plugin
+const char *service = "OneSevenLive";
+
+namespace {
+    int failures = 0;
+
+    void check(bool condition, const char *what) {
+        printf("%s: %s\n", condition ? "ok" : "FAILED", what);
+        if (!condition)
+            failures++;
+    }
+
+    // Decode a gzip stream, including its CRC-32 and length trailer
+    bool gunzip(const std::string &data, std::string &out) {
+        z_stream stream{};
+        if (inflateInit2(&stream, 16 + MAX_WBITS) != Z_OK)
+            return false;
+
+        stream.next_in = (Bytef *) data.data();
+        stream.avail_in = (uInt) data.size();
+        char buffer[16384];
+        int result;
+        out.clear();
+        do {
+            stream.next_out = (Bytef *) buffer;
+            stream.avail_out = sizeof(buffer);
+            result = inflate(&stream, Z_NO_FLUSH);
+            out.append(buffer, sizeof(buffer) - stream.avail_out);
+        } while (result == Z_OK);
+
+        inflateEnd(&stream);
+        return result == Z_STREAM_END && stream.avail_in == 0;
+    }
+
+    // What the stand-in saw of the requests to one route
+    struct Route {
+        std::mutex mutex;
+        int hits = 0;
+        bool gzip = false;
+        std::string body;  // Decoded by cpp-httplib
+
+        void record(const httplib::Request &req) {
+            std::lock_guard<std::mutex> lock(mutex);
+            hits++;
+            gzip = req.get_header_value("Content-Encoding") == "gzip";
+            body = req.body;
+        }
+    };
+
+    // A custom event for that many gifts, like the custom event dialog creates
+    OneSevenLiveCustomEvent custom_event(int gifts) {
+        OneSevenLiveCustomEvent event{};
+        event.userID = "user-1";
+        event.eventName = "Weekend ranking";
+        event.description = "Send gifts to climb the ranking";
+        event.endTime = 1735689600;
+        event.goalPoints = 100000;
+        event.dailyGoalPoints = 10000;
+        for (int i = 0; i < gifts; i++)
+            event.giftIDs.append(QString("gift_%1").arg(i));
+        return event;
+    }
+
+    OneSevenLiveRtmpRequest rtmp_request(int hashtags) {
+        OneSevenLiveRtmpRequest request{};
+        request.userID = "user-1";
+        request.caption = "Evening stream";
+        request.device = "OBS";
+        for (int i = 0; i < hashtags; i++)
+            request.hashtags.append(QString("hashtag_%1").arg(i));
+        return request;
+    }
+}  // namespace
+
+int main() {
+    std::string base = "http://127.0.0.1:" + std::to_string(REQUEST_COMPRESSION_TEST_PORT);
+    std::string customEventUrl = base + "/api/v1/event/customEvent";
+    std::string rtmpUrl = base + "/api/v1/rtmp";
+    RequestCompression &compression = RequestCompression::instance();
+
+    httplib::Server server;
+    Route customEvent, rtmp;
+    server.Post("/api/v1/event/customEvent",
+                [&customEvent](const httplib::Request &req, httplib::Response &res) {
+                    customEvent.record(req);
+                    res.set_content(R"({"eventID":"event-1"})", "application/json");
+                });
+    server.Post("/api/v1/rtmp", [&rtmp](const httplib::Request &req, httplib::Response &res) {
+        rtmp.record(req);
+        if (rtmp.gzip)
+            res.status = 415;
+        else
+            res.set_content(R"({"liveStreamID":"live-1"})", "application/json");
+    });
+
+    TestServer running(server, REQUEST_COMPRESSION_TEST_PORT);
+    if (!running.ok())
+        return 1;
+
+    std::string plain = Json{{"giftIDs", std::vector<std::string>(200, "gift")}}.dump();
+    std::string gzipped, decoded;
+    check(RequestCompression::gzip(plain.data(), plain.size(), gzipped) &&
+              gunzip(gzipped, decoded) && decoded == plain,
+          "gzip output decodes to the original body");
+
+    check(compression.support("POST", customEventUrl) == RequestCompression::Support::Undeclared,
+          "endpoints are undeclared before the wrapper registers them");
+
+    OneSevenLiveApiWrappers api("test-token");
+    check(compression.support("POST", customEventUrl) == RequestCompression::Support::Accepted &&
+              compression.support("POST", rtmpUrl) == RequestCompression::Support::Accepted,
+          "the wrapper declares CreateCustomEvent and CreateRtmp");
+    check(compression.support("POST", base + "/api/v1/pokes") ==
+              RequestCompression::Support::Undeclared,
+          "other endpoints stay undeclared");
+
+    // A large body goes out compressed and arrives intact
+    RequestCompressionStats before = compression.stats();
+    OneSevenLiveCustomEvent created;
+    bool sent = api.CreateCustomEvent(custom_event(200), created);
+    RequestCompressionStats after = compression.stats();
+    Json received = Json::parse(customEvent.body, nullptr, false);
+    check(sent && created.eventID == "event-1", "CreateCustomEvent succeeds");
+    check(customEvent.gzip, "large body is sent with Content-Encoding: gzip");
+    check(received.is_object() && received.value("giftIDs", Json::array()).size() == 200 &&
+              received.value("eventName", "") == "Weekend ranking",
+          "stand-in server decodes the compressed body");
+    check(after.requests == before.requests + 1 &&
+              after.compressedBytes - before.compressedBytes <
+                  after.plainBytes - before.plainBytes,
+          "the savings are recorded");
+    printf("    %llu -> %llu bytes\n",
+           (unsigned long long) (after.plainBytes - before.plainBytes),
+           (unsigned long long) (after.compressedBytes - before.compressedBytes));
+
+    sent = api.CreateCustomEvent(custom_event(1), created);
+    check(sent && !customEvent.gzip, "body below REQUEST_COMPRESSION_MIN_SIZE is sent plain");
+
+    // A 415 is handed to the caller, and later calls go out plain
+    OneSevenLiveRtmpResponse rtmpResponse;
+    sent = api.CreateRtmp(rtmp_request(200), rtmpResponse);
+    check(!sent && OneSevenLiveApiWrappers::threadLastHttpStatus() == 415,
+          "the caller gets the 415");
+    check(rtmp.hits == 1, "the rejected request is not resent");
+    check(compression.support("POST", rtmpUrl) == RequestCompression::Support::Rejected,
+          "endpoint that answered 415 is marked as rejecting gzip");
+
+    sent = api.CreateRtmp(rtmp_request(200), rtmpResponse);
+    check(sent && rtmp.hits == 2 && !rtmp.gzip && rtmpResponse.liveStreamID == "live-1",
+          "endpoint that answered 415 is sent plain from then on");
+
+    sent = api.CreateCustomEvent(custom_event(200), created);
+    check(sent && customEvent.gzip, "other endpoints keep compressing");
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,178 @@
+/******************************************************************************
+    Copyright (C) 2024 by 17Live
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+/*
+ * Segmented downloads against a local server that caps every connection's speed, like a
+ * congested uplink does.
+ *
+ * The same asset is fetched as a single stream and as concurrent byte ranges, and the throughput
+ * of both is printed. A server that ignores Range must lead to a single-stream fallback. Every
+ * download must complete with the right SHA-256, and the ranges must be faster.
+ */
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QFile>
+#include <QTemporaryDir>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+
+#include "../deps/cpp-httplib/httplib.h"
+#include "test_server.hpp"
+
+#include "utility/DownloadWorker.hpp"
+
+#define TEST_ASSET_SIZE (24 * 1024 * 1024)
+#define TEST_CONNECTION_RATE (8 * 1024 * 1024)  // bytes per second and connection
+#define TEST_CHUNK_SIZE (64 * 1024)
+#define TEST_SEGMENTS 4
+#define TEST_MIN_GAIN 1.5
+
+namespace {
+    // Serves body[offset, offset + length) at TEST_CONNECTION_RATE
+    bool write_throttled(const std::string &body, size_t offset, size_t length,
+                         httplib::DataSink &sink) {
+        using Clock = std::chrono::steady_clock;
+        Clock::time_point started = Clock::now();
+        size_t sent = 0;
+        while (sent < length) {
+            size_t size = std::min<size_t>(TEST_CHUNK_SIZE, length - sent);
+            if (!sink.is_writable())
+                return false;
+            sink.write(body.data() + offset + sent, size);
+            sent += size;
+
+            auto due = started + std::chrono::microseconds(
+                                     (long long) (sent * 1000000.0 / TEST_CONNECTION_RATE));
+            std::this_thread::sleep_until(due);
+        }
+        return true;
+    }
+
+    struct DownloadResult {
+        bool success = false;
+        QString error;
+        double seconds = 0.0;
+    };
+
+    DownloadResult download(const std::string &url, const QString &path, const QString &sha256,
+                            int segments) {
+        DownloadResult result;
+        DownloadWorker worker(QString::fromStdString(url), path, sha256);
+        worker.setSegments(segments);
+        QObject::connect(&worker, &DownloadWorker::finished,
+                         [&result](bool success, const QString &error) {
+                             result.success = success;
+                             result.error = error;
+                         });
+
+        auto started = std::chrono::steady_clock::now();
+        worker.process();
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started)
+                             .count();
+        return result;
+    }
+
+    bool report(const char *name, const DownloadResult &result) {
+        if (!result.success) {
+            printf("%s: failed: %s\n", name, result.error.toUtf8().constData());
+            return false;
+        }
+        printf("%s: %.2f s, %.1f MB/s\n", name, result.seconds,
+               TEST_ASSET_SIZE / result.seconds / (1024 * 1024));
+        return true;
+    }
+}  // namespace
+
+int main(int argc, char **argv) {
+    QCoreApplication app(argc, argv);
+
+    // Random bytes, so nothing on the way can compress them
+    std::string body(TEST_ASSET_SIZE, '\0');
+    std::mt19937 random(17);
+    for (char &c : body)
+        c = (char) (random() & 0xFF);
+    QString sha256 = QString::fromLatin1(
+        QCryptographicHash::hash(QByteArray::fromRawData(body.data(), (qsizetype) body.size()),
+                                 QCryptographicHash::Sha256)
+            .toHex());
+
+    httplib::Server server;
+    // cpp-httplib answers a Range request for a sized content provider with 206
+    server.Get("/asset", [&body](const httplib::Request &, httplib::Response &res) {
+        res.set_content_provider(
+            body.size(), "application/octet-stream",
+            [&body](size_t offset, size_t length, httplib::DataSink &sink) {
+                return write_throttled(body, offset, length, sink);
+            });
+    });
+    // Ignores Range and sends the whole asset, so the client has to fall back to a single stream
+    server.Get("/no-ranges", [&body](const httplib::Request &, httplib::Response &res) {
+        res.status = 200;
+        res.set_chunked_content_provider(
+            "application/octet-stream", [&body](size_t offset, httplib::DataSink &sink) {
+                if (offset >= body.size()) {
+                    sink.done();
+                    return true;
+                }
+                return write_throttled(body, offset,
+                                       std::min<size_t>(TEST_CHUNK_SIZE, body.size() - offset),
+                                       sink);
+            });
+    });
+
+    TestServer running(server);
+    if (!running.ok())
+        return 1;
+
+    std::string base = running.base();
+    QTemporaryDir dir;
+    bool ok = dir.isValid();
+
+    DownloadResult single, ranged, fallback;
+    if (ok) {
+        single = download(base + "/asset", dir.filePath("single.bin"), sha256, 1);
+        ranged = download(base + "/asset", dir.filePath("ranged.bin"), sha256, TEST_SEGMENTS);
+        fallback =
+            download(base + "/no-ranges", dir.filePath("fallback.bin"), sha256, TEST_SEGMENTS);
+    }
+
+    running.stop();
+
+    if (!ok) {
+        fprintf(stderr, "Cannot create a temporary directory\n");
+        return 1;
+    }
+
+    ok = report("single stream", single);
+    ok = report("ranges", ranged) && ok;
+    ok = report("no ranges, fallback", fallback) && ok;
+    if (!ok)
+        return 1;
+
+    double gain = single.seconds / ranged.seconds;
+    printf("throughput gain of ranges: %.2fx\n", gain);
+    if (gain < TEST_MIN_GAIN) {
+        printf("expected at least %.1fx\n", TEST_MIN_GAIN);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,84 @@
+/******************************************************************************
+    Copyright (C) 2024 by 17Live
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+#include "../deps/cpp-httplib/httplib.h"
+
+/**
+ * Runs a cpp-httplib server on a loopback port for the tests and benchmarks.
+ *
+ * Binds the server, listens on a thread of its own and waits until it accepts connections.
+ * The server is stopped when this object goes out of scope, so declare it after the server and
+ * after everything its handlers use.
+ */
+class TestServer {
+   public:
+    /**
+     * @param server Server with its routes set up
+     * @param port Port to listen on, 0 picks a free one
+     */
+    explicit TestServer(httplib::Server &server_, int port = 0) : server(server_) {
+        if (port)
+            boundPort = server.bind_to_port("127.0.0.1", port) ? port : -1;
+        else
+            boundPort = server.bind_to_any_port("127.0.0.1");
+        if (boundPort <= 0) {
+            fprintf(stderr, "Cannot bind the test server\n");
+            return;
+        }
+
+        listener = std::thread([this]() { server.listen_after_bind(); });
+        for (int i = 0; i < 100 && !server.is_running(); ++i)
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    ~TestServer() { stop(); }
+
+    /**
+     * @return false if the server could not be bound, the test cannot run
+     */
+    bool ok() const { return boundPort > 0; }
+
+    /**
+     * @return URL of the server without a trailing slash, e.g. "http://127.0.0.1:8080"
+     */
+    std::string base() const { return "http://127.0.0.1:" + std::to_string(boundPort); }
+
+    /**
+     * Stop the server before the end of the scope, e.g. to report without it running
+     */
+    void stop() {
+        if (!listener.joinable())
+            return;
+        server.stop();
+        listener.join();
+    }
+
+    TestServer(const TestServer &) = delete;
+    TestServer &operator=(const TestServer &) = delete;
+
+   private:
+    httplib::Server &server;
+    std::thread listener;
+    int boundPort = -1;
+};